@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/ExPolygon.hpp>
+#include <libslic3r/Fill/FillBase.hpp>
+#include <libslic3r/Flow.hpp>
+#include <libslic3r/PrintConfig.hpp>
+#include <libslic3r/Surface.hpp>
+
+#include "libnest2d/tools/benchmark.h"
+
+const std::string USAGE_STR = {
+    "Usage: fill_benchmark [--repeat n] [--density d] [pattern ...]\n"
+    "Fills synthetic surfaces of growing area, square plates perforated by a grid of holes,\n"
+    "and reports the fill time versus the surface area. The default patterns are rectilinear and monotonic,\n"
+    "the default density is 1. Use for example \"--density 0.2 gyroid schwarzd\" for the sparse infills."
+};
+
+using namespace Slic3r;
+
+// Square plate of side size_mm with a grid of square holes, 2mm wide every 5mm, to get many contours on each infill line.
+static ExPolygon synthetic_surface(double size_mm)
+{
+    ExPolygon expolygon(Polygon::new_scale({ { 0., 0. }, { size_mm, 0. }, { size_mm, size_mm }, { 0., size_mm } }));
+    for (double x = 2.5; x + 4. < size_mm; x += 5.)
+        for (double y = 2.5; y + 4. < size_mm; y += 5.) {
+            Polygon hole = Polygon::new_scale({ { x, y }, { x + 2., y }, { x + 2., y + 2. }, { x, y + 2. } });
+            hole.reverse();
+            expolygon.holes.emplace_back(std::move(hole));
+        }
+    return expolygon;
+}
+
+int main(const int argc, const char *argv[])
+{
+    int                       repeat  = 3;
+    float                     density = 1.f;
+    std::vector<std::string>  patterns;
+    for (int i = 1; i < argc; ++ i) {
+        const std::string arg = argv[i];
+        if (arg == "--repeat" && i + 1 < argc)
+            repeat = std::max(1, std::stoi(argv[++ i]));
+        else if (arg == "--density" && i + 1 < argc)
+            density = std::clamp(std::stof(argv[++ i]), 0.01f, 1.f);
+        else if (arg == "--help" || arg == "-h") {
+            std::cout << USAGE_STR << std::endl;
+            return 0;
+        } else
+            patterns.emplace_back(arg);
+    }
+    if (patterns.empty())
+        patterns = { "rectilinear", "monotonic" };
+
+    const Flow flow = Flow::new_from_width(0.45f, 0.4f, 0.2f, 1.f);
+    // The fillers read their process specific parameters from the region config, some of them from the print config.
+    static const FullPrintConfig config = FullPrintConfig::defaults();
+    for (const std::string &pattern : patterns) {
+        for (double size_mm : { 25., 50., 100., 200., 400. }) {
+            std::unique_ptr<Fill> filler(Fill::new_from_type(pattern));
+            if (! filler) {
+                std::cerr << "Unknown pattern " << pattern << std::endl;
+                return EXIT_FAILURE;
+            }
+            Surface surface(stPosInternal | (density < 1.f ? stDensSparse : stDensSolid), synthetic_surface(size_mm));
+            filler->bounding_box = get_extents(surface.expolygon.contour);
+            filler->angle        = float(PI / 4.);
+            FillParams params;
+            params.density     = density;
+            params.dont_adjust = false;
+            params.flow        = flow;
+            params.config      = &config;
+            filler->init_spacing(flow.spacing(), params);
+
+            Benchmark b;
+            double    seconds = 0.;
+            size_t    num_lines = 0;
+            for (int i = 0; i < repeat; ++ i) {
+                b.start();
+                Polylines polylines = filler->fill_surface(&surface, params);
+                b.stop();
+                seconds  += b.getElapsedSec();
+                num_lines = polylines.size();
+            }
+            std::cout << pattern << ": area " << size_mm * size_mm << " mm2, " << surface.expolygon.holes.size() << " holes, "
+                      << num_lines << " polylines, " << seconds * 1000. / repeat << " ms" << std::endl;
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/Arrange/Arrange.hpp>
+#include <libslic3r/Format/OBJ.hpp>
+#include <libslic3r/Model.hpp>
+#include <libslic3r/ModelArrange.hpp>
+#include <libslic3r/Print.hpp>
+#include <libslic3r/PrintConfig.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libslic3r/Utils.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <oneapi/tbb/task_arena.h>
+
+#include "libnest2d/tools/benchmark.h"
+
+const std::string USAGE_STR = {
+    "Usage: print_benchmark [--repeat n] [--json results.json] [case ...]\n"
+    "Slices a fixed corpus of models from tests/data and reports the wall time of the print steps,\n"
+    "the G-code export time, the peak resident memory and the CPU utilization.\n"
+    "Without cases, the whole corpus is processed. The JSON output is meant to be compared between releases."
+};
+
+using namespace Slic3r;
+
+struct BenchmarkCase
+{
+    std::string                                       name;
+    std::string                                       file;
+    std::vector<std::pair<std::string, std::string>>  config;
+};
+
+// Fixed corpus: the models and settings should not change, otherwise the results are not comparable between releases.
+static const std::vector<BenchmarkCase> s_corpus = {
+    { "cube_rectilinear",   "20mm_cube.obj",       { { "fill_density", "20%" }, { "fill_pattern", "rectilinear" } } },
+    { "cube_gyroid",        "20mm_cube.obj",       { { "fill_density", "20%" }, { "fill_pattern", "gyroid" }, { "layer_height", "0.1" } } },
+    { "extruder_idler",     "extruder_idler.obj",  { { "fill_density", "20%" }, { "perimeters", "3" } } },
+    { "frog_legs",          "frog_legs.obj",       { { "fill_density", "15%" } } },
+    { "ipadstand",          "ipadstand.obj",       { { "fill_density", "20%" }, { "fill_pattern", "gyroid" } } },
+    { "overhang_support",   "overhang.obj",        { { "support_material", "1" } } },
+    { "bridge",             "bridge.obj",          { { "fill_density", "20%" } } },
+    { "pyramid_support",    "pyramid.obj",         { { "support_material", "1" }, { "layer_height", "0.1" } } },
+};
+
+struct BenchmarkResult
+{
+    std::string                  name;
+    // Sum over the objects of each step, averaged over the repetitions.
+    Print::ObjectStepTimes       step_ms {};
+    double                       process_ms { 0. };
+    double                       export_ms  { 0. };
+    // Process CPU time divided by the wall time, approximates the number of busy threads.
+    double                       cpu_utilization { 0. };
+    size_t                       peak_memory { 0 };
+};
+
+static bool run_case(const BenchmarkCase &bcase, int repeat, BenchmarkResult &result)
+{
+    TriangleMesh mesh;
+    if (! load_obj((boost::filesystem::path(PRINT_BENCHMARK_DATA_DIR) / bcase.file).string().c_str(), &mesh)) {
+        std::cerr << bcase.name << ": failed to load " << bcase.file << std::endl;
+        return false;
+    }
+    DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+    for (const auto &[key, value] : bcase.config)
+        config.set_deserialize_strict(key, value);
+    const std::string gcode_path = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("print_benchmark-%%%%-%%%%.gcode")).string();
+
+    result.name = bcase.name;
+    Benchmark b;
+    double    cpu_seconds  = 0.;
+    double    wall_seconds = 0.;
+    for (int i = 0; i < repeat; ++ i) {
+        // A fresh Print for each repetition, the steps are not reused.
+        Model        model;
+        ModelObject *object = model.add_object();
+        object->name = bcase.name;
+        object->add_volume(mesh);
+        object->add_instance();
+        arr2::ArrangeSettings arrange_settings;
+        arrange_settings.set_distance_from_objects(min_object_distance(&config));
+        arrange_objects(model, arr2::to_arrange_bed(get_bed_shape(config)), arrange_settings);
+        object->ensure_on_bed();
+        Print print;
+        print.auto_assign_extruders(object);
+        print.apply(model, config);
+        if (std::string err = print.validate().second; ! err.empty()) {
+            std::cerr << bcase.name << ": " << err << std::endl;
+            return false;
+        }
+        print.set_status_silent();
+
+        std::clock_t cpu_start = std::clock();
+        b.start();
+        print.process();
+        b.stop();
+        result.process_ms += b.getElapsedSec() * 1000.;
+        wall_seconds += b.getElapsedSec();
+        b.start();
+        print.export_gcode(gcode_path, nullptr, nullptr);
+        b.stop();
+        result.export_ms += b.getElapsedSec() * 1000.;
+        wall_seconds += b.getElapsedSec();
+        cpu_seconds += double(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+
+        for (const Print::ObjectStepTimes &times : print.object_step_times_ms())
+            for (size_t step = 0; step < times.size(); ++ step)
+                result.step_ms[step] += times[step];
+    }
+    boost::system::error_code ec;
+    boost::filesystem::remove(gcode_path, ec);
+
+    for (unsigned int &ms : result.step_ms)
+        ms /= unsigned(repeat);
+    result.process_ms /= repeat;
+    result.export_ms  /= repeat;
+#ifdef _WIN32
+    // std::clock() measures the wall time on Windows.
+    result.cpu_utilization = 0.;
+#else
+    result.cpu_utilization = wall_seconds > 0. ? cpu_seconds / wall_seconds : 0.;
+#endif
+    // The peak of the whole process, thus it only grows from one case to the next one.
+    result.peak_memory = peak_memory_usage();
+    return true;
+}
+
+static void print_result(const BenchmarkResult &result)
+{
+    std::cout << result.name << ": process " << result.process_ms << " ms (";
+    for (size_t step = 0; step < result.step_ms.size(); ++ step)
+        std::cout << (step == 0 ? "" : ", ") << Print::object_step_time_names[step] << " " << result.step_ms[step] << " ms";
+    std::cout << "), export " << result.export_ms << " ms, cpu utilization " << result.cpu_utilization
+              << ", peak memory " << result.peak_memory / (1024 * 1024) << " MB" << std::endl;
+}
+
+static void write_json(const std::string &path, const std::vector<BenchmarkResult> &results, int repeat)
+{
+    std::ofstream out(path);
+    out << "{\n"
+        << "  \"version\": \"" << SLIC3R_VERSION << "\",\n"
+        << "  \"threads\": " << tbb::this_task_arena::max_concurrency() << ",\n"
+        << "  \"repeat\": " << repeat << ",\n"
+        << "  \"cases\": [\n";
+    for (size_t i = 0; i < results.size(); ++ i) {
+        const BenchmarkResult &result = results[i];
+        out << "    {\n"
+            << "      \"name\": \"" << result.name << "\",\n"
+            << "      \"steps_ms\": {";
+        for (size_t step = 0; step < result.step_ms.size(); ++ step)
+            out << (step == 0 ? " " : ", ") << "\"" << Print::object_step_time_names[step] << "\": " << result.step_ms[step];
+        out << " },\n"
+            << "      \"process_ms\": " << result.process_ms << ",\n"
+            << "      \"export_gcode_ms\": " << result.export_ms << ",\n"
+            << "      \"cpu_utilization\": " << result.cpu_utilization << ",\n"
+            << "      \"peak_memory_bytes\": " << result.peak_memory << "\n"
+            << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n"
+        << "}\n";
+}
+
+int main(const int argc, const char *argv[])
+{
+    int                       repeat = 1;
+    std::string               json_path;
+    std::vector<std::string>  names;
+    for (int i = 1; i < argc; ++ i) {
+        const std::string arg = argv[i];
+        if (arg == "--repeat" && i + 1 < argc)
+            repeat = std::max(1, std::stoi(argv[++ i]));
+        else if (arg == "--json" && i + 1 < argc)
+            json_path = argv[++ i];
+        else if (arg == "--help" || arg == "-h") {
+            std::cout << USAGE_STR << std::endl;
+            return 0;
+        } else
+            names.emplace_back(arg);
+    }
+
+    std::vector<BenchmarkResult> results;
+    for (const BenchmarkCase &bcase : s_corpus) {
+        if (! names.empty() && std::find(names.begin(), names.end(), bcase.name) == names.end())
+            continue;
+        BenchmarkResult result;
+        if (! run_case(bcase, repeat, result))
+            return EXIT_FAILURE;
+        print_result(result);
+        results.emplace_back(std::move(result));
+    }
+    if (results.empty()) {
+        std::cerr << USAGE_STR << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (! json_path.empty())
+        write_json(json_path, results, repeat);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <libslic3r/TriangleMesh.hpp>
+#include <libslic3r/TriangleMeshSlicer.hpp>
+#include <libslic3r/Format/OBJ.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include "libnest2d/tools/benchmark.h"
+
+const std::string USAGE_STR = {
+    "Usage: slice_benchmark [--layer-height mm] [--repeat n] [mesh.obj|mesh.stl ...]\n"
+    "Without meshes, all the meshes of the tests/data directory are sliced."
+};
+
+using namespace Slic3r;
+
+static bool load_mesh(const boost::filesystem::path &path, TriangleMesh &mesh)
+{
+    const std::string ext = path.extension().string();
+    if (ext == ".obj")
+        return load_obj(path.string().c_str(), &mesh);
+    if (ext == ".stl")
+        return mesh.ReadSTLFile(path.string().c_str());
+    return false;
+}
+
+// Slice the mesh from its bottom to its top, layer_height apart, and print the slicing throughput.
+static void measure(const std::string &name, const TriangleMesh &mesh, float layer_height, int repeat)
+{
+    const BoundingBoxf3 bb = mesh.bounding_box();
+    std::vector<float> zs;
+    for (float z = float(bb.min.z()) + 0.5f * layer_height; z < bb.max.z(); z += layer_height)
+        zs.emplace_back(z);
+
+    Benchmark b;
+    double    seconds = 0.;
+    size_t    num_polygons = 0;
+    for (int i = 0; i < repeat; ++ i) {
+        b.start();
+        std::vector<Polygons> slices = slice_mesh(mesh.its, zs, MeshSlicingParams{});
+        b.stop();
+        seconds += b.getElapsedSec();
+        num_polygons = 0;
+        for (const Polygons &slice : slices)
+            num_polygons += slice.size();
+    }
+
+    const double triangles = double(mesh.facets_count()) * repeat;
+    std::cout << name << ": " << mesh.facets_count() << " triangles, " << zs.size() << " layers, " << num_polygons << " polygons, "
+              << seconds / repeat * 1000. << " ms per slicing, " << (seconds > 0. ? triangles / seconds : 0.) << " triangles/s" << std::endl;
+}
+
+int main(const int argc, const char *argv[])
+{
+    float                                 layer_height = 0.05f;
+    int                                   repeat       = 10;
+    std::vector<boost::filesystem::path>  paths;
+    for (int i = 1; i < argc; ++ i) {
+        const std::string arg = argv[i];
+        if (arg == "--layer-height" && i + 1 < argc)
+            layer_height = std::stof(argv[++ i]);
+        else if (arg == "--repeat" && i + 1 < argc)
+            repeat = std::max(1, std::stoi(argv[++ i]));
+        else if (arg == "--help" || arg == "-h") {
+            std::cout << USAGE_STR << std::endl;
+            return 0;
+        } else
+            paths.emplace_back(arg);
+    }
+    if (layer_height <= 0.f) {
+        std::cerr << USAGE_STR << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (paths.empty())
+        for (const auto &entry : boost::filesystem::directory_iterator(SLICE_BENCHMARK_DATA_DIR))
+            if (boost::filesystem::is_regular_file(entry))
+                paths.emplace_back(entry.path());
+    std::sort(paths.begin(), paths.end());
+
+    for (const boost::filesystem::path &path : paths) {
+        TriangleMesh mesh;
+        if (load_mesh(path, mesh) && ! mesh.empty())
+            measure(path.filename().string(), mesh, layer_height, repeat);
+        else if (! boost::filesystem::is_directory(path))
+            std::cerr << "Skipping " << path.string() << ": not a mesh" << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
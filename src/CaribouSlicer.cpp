@@ -28,6 +28,7 @@
 #include <boost/nowide/iostream.hpp>
 #include <boost/nowide/integration/filesystem.hpp>
 #include <boost/dll/runtime_symbol_info.hpp>
+#include <boost/log/trivial.hpp>
 
 #include "unix/fhs.hpp"  // Generated by CMake from ../platform/unix/fhs.hpp.in
 
@@ -573,6 +574,9 @@ int CLI::run(int argc, char **argv)
         } else if (opt_key == "export_3mf") {
             if (! this->export_models(IO::TMF))
                 return 1;
+        } else if (opt_key == "server") {
+            if (! this->run_server(printer_technology))
+                return 1;
         } else if (opt_key == "export_gcode" || opt_key == "export_sla" || opt_key == "slice") {
             if (opt_key == "export_gcode" && printer_technology == ptSLA) {
                 boost::nowide::cerr << "error: cannot export G-code for an FFF configuration" << std::endl;
@@ -849,6 +853,7 @@ bool CLI::setup(int argc, char **argv)
             m_config.option(optdef.first, true);
 
     set_data_dir(m_config.opt_string("datadir"));
+    set_slice_cache_dir(m_config.opt_string("slice_cache"), size_t(std::max(0, m_config.opt_int("slice_cache_size"))) << 20);
 
     //FIXME Validating at this stage most likely does not make sense, as the config is not fully initialized yet.
     if (!validity.empty()) {
@@ -926,6 +931,151 @@ bool CLI::export_models(IO::ExportFormat format)
     return true;
 }
 
+// Split a server job line into arguments separated by whitespaces. Double quotes group an argument containing whitespaces.
+static std::vector<std::string> split_server_job(const std::string &line)
+{
+    std::vector<std::string> args;
+    std::string              arg;
+    bool                     in_arg    = false;
+    bool                     in_quotes = false;
+    for (char c : line) {
+        if (c == '"') {
+            in_quotes = ! in_quotes;
+            in_arg    = true;
+        } else if (! in_quotes && (c == ' ' || c == '\t' || c == '\r')) {
+            if (in_arg) {
+                args.emplace_back(std::move(arg));
+                arg.clear();
+                in_arg = false;
+            }
+        } else {
+            arg += c;
+            in_arg = true;
+        }
+    }
+    if (in_arg)
+        args.emplace_back(std::move(arg));
+    return args;
+}
+
+// Each line of the standard input is a job formatted as a command line: model files, print options and --output.
+// The print options are applied over the configuration loaded when the server was started. The answer is a single line
+// "ok <output file>" or "error <message>". The server ends at the end of the input or with a "quit" line.
+// The Print is kept alive between the jobs and the models are kept loaded until their files change, thus a job slicing
+// the same models as the previous one with a few options changed only recomputes the steps invalidated by Print::apply().
+bool CLI::run_server(PrinterTechnology printer_technology)
+{
+    if (printer_technology != ptFFF) {
+        boost::nowide::cerr << "error: --server supports FFF printers only" << std::endl;
+        return false;
+    }
+
+    // Models loaded by the previous jobs, indexed by the list of their input files.
+    // Copies of a Model keep the IDs of its objects, so that Print::apply() recognizes the unchanged objects.
+    struct LoadedModel {
+        std::vector<std::time_t> timestamps;
+        Model                    model;
+    };
+    std::map<std::vector<std::string>, LoadedModel> loaded_models;
+    Print fff_print;
+
+    auto slice_job = [this, &loaded_models, &fff_print](const std::vector<std::string> &args) -> std::string {
+        DynamicPrintAndCLIConfig  job_config;
+        std::vector<std::string>  input_files;
+        std::vector<const char*>  argv { "server" };
+        for (const std::string &arg : args)
+            argv.emplace_back(arg.c_str());
+        if (! job_config.read_cli(int(argv.size()), argv.data(), &input_files))
+            throw Slic3r::RuntimeError("Invalid job options");
+        if (input_files.empty())
+            throw Slic3r::RuntimeError("No input file");
+
+        DynamicPrintConfig job_overrides;
+        job_overrides.apply(job_config, true);
+        job_overrides.normalize_fdm();
+        DynamicPrintConfig print_config = m_print_config;
+        print_config.apply(job_overrides, true);
+        {
+            FullPrintConfig fff_print_config;
+            fff_print_config.apply(print_config, true);
+            print_config.apply(fff_print_config, true);
+        }
+        if (std::string validity = print_config.validate(); ! validity.empty())
+            throw Slic3r::RuntimeError("The composite configation is not valid: " + validity);
+
+        std::vector<std::time_t> timestamps;
+        for (const std::string &file : input_files) {
+            if (! boost::filesystem::exists(file))
+                throw Slic3r::RuntimeError("No such file: " + file);
+            timestamps.emplace_back(boost::filesystem::last_write_time(file));
+        }
+        LoadedModel &loaded = loaded_models[input_files];
+        if (loaded.model.objects.empty() || loaded.timestamps != timestamps) {
+            Model merged;
+            for (const std::string &file : input_files) {
+                Model model = Model::read_from_file(file, nullptr, nullptr, Model::LoadAttribute::AddDefaultInstances);
+                for (ModelObject *o : model.objects)
+                    merged.add_object(*o);
+            }
+            if (merged.objects.empty())
+                throw Slic3r::RuntimeError("Nothing to print");
+            loaded.timestamps = std::move(timestamps);
+            loaded.model      = std::move(merged);
+            BOOST_LOG_TRIVIAL(info) << "Slicing server loaded " << loaded.model.objects.size() << " objects";
+        }
+
+        // The arrangement is deterministic, the objects of a model already sliced are placed at the same positions.
+        Model model = loaded.model;
+        if (m_config.opt_bool("ensure_on_bed"))
+            for (ModelObject *o : model.objects)
+                o->ensure_on_bed();
+        if (! m_config.opt_bool("dont_arrange")) {
+            arr2::ArrangeSettings arrange_cfg;
+            arrange_cfg.set_distance_from_objects(min_object_distance(static_cast<const ConfigBase*>(&print_config)));
+            arrange_objects(model, arr2::to_arrange_bed(get_bed_shape(print_config)), arrange_cfg);
+        }
+        for (ModelObject *mo : model.objects)
+            fff_print.auto_assign_extruders(mo);
+
+        fff_print.apply(model, print_config);
+        std::pair<PrintBase::PrintValidationError, std::string> err = fff_print.validate();
+        if (err.first != PrintBase::PrintValidationError::pveNone)
+            throw Slic3r::RuntimeError(err.second);
+        if (fff_print.empty())
+            throw Slic3r::RuntimeError("Nothing to print. Either the print is empty or no object is fully inside the print volume.");
+        fff_print.process();
+
+        const ConfigOptionString *opt_output = job_config.opt<ConfigOptionString>("output");
+        std::string outfile = fff_print.export_gcode(opt_output != nullptr ? opt_output->value : m_config.opt_string("output"), nullptr, nullptr);
+        std::string outfile_final = fff_print.print_statistics().finalize_output_path(outfile);
+        if (outfile != outfile_final) {
+            if (Slic3r::rename_file(outfile, outfile_final))
+                throw Slic3r::RuntimeError("Renaming file " + outfile + " to " + outfile_final + " failed");
+            outfile = outfile_final;
+        }
+        run_post_process_scripts(outfile, fff_print.full_print_config());
+        return outfile;
+    };
+
+    std::string line;
+    while (std::getline(boost::nowide::cin, line)) {
+        std::vector<std::string> args = split_server_job(line);
+        if (args.empty())
+            continue;
+        if (args.size() == 1 && args.front() == "quit")
+            break;
+        try {
+            std::string outfile = slice_job(args);
+            boost::nowide::cout << "ok " << outfile << std::endl;
+        } catch (const std::exception &ex) {
+            // The failed job may have left the Print in any state, start the next job from scratch.
+            fff_print.clear();
+            boost::nowide::cout << "error " << ex.what() << std::endl;
+        }
+    }
+    return true;
+}
+
 std::string CLI::output_filepath(const Model &model, IO::ExportFormat format) const
 {
     std::string ext;
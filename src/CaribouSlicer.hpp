@@ -40,6 +40,9 @@ private:
     /// Exports loaded models to a file of the specified format, according to the options affecting output filename.
     bool export_models(IO::ExportFormat format);
 
+    /// Slices the jobs read from stdin until the end of the input, keeping the Print and the loaded models between the jobs.
+    bool run_server(PrinterTechnology printer_technology);
+
     bool has_print_action() const { return m_config.opt_bool("export_gcode") || m_config.opt_bool("export_sla"); }
 
     std::string output_filepath(const Model &model, IO::ExportFormat format) const;
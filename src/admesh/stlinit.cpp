@@ -26,10 +26,19 @@
 #include <math.h>
 #include <assert.h>
 
+#include <algorithm>
+#include <system_error>
+
 #include <boost/log/trivial.hpp>
 #include <boost/nowide/cstdio.hpp>
 #include <boost/predef/other/endian.h>
 
+#include <oneapi/tbb/blocked_range.h>
+#include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/parallel_reduce.h>
+
+#include <fast_float/fast_float.h>
+
 #include "stl.h"
 
 #include "libslic3r/LocalesUtils.hpp"
@@ -142,94 +151,175 @@ static FILE* stl_open_count_facets(stl_file *stl, const char *file)
   	return fp;
 }
 
+// Cursor over the content of an ASCII STL file. Parsing from memory with fast_float
+// is an order of magnitude faster than a chain of fscanf() calls per facet.
+class StlAsciiParser
+{
+public:
+	StlAsciiParser(const char *begin, const char *end) : m_ptr(begin), m_end(end) {}
+
+	void skip_whitespaces() { while (m_ptr != m_end && is_whitespace(*m_ptr)) ++ m_ptr; }
+	// Skip the rest of the current line including the new line character.
+	void skip_line() {
+		while (m_ptr != m_end && *m_ptr != '\n')
+			++ m_ptr;
+		if (m_ptr != m_end)
+			++ m_ptr;
+	}
+	// Skip leading whitespaces, then consume the keyword if it follows.
+	bool keyword(const char *kw) {
+		this->skip_whitespaces();
+		size_t len = strlen(kw);
+		if (size_t(m_end - m_ptr) < len || strncmp(m_ptr, kw, len) != 0)
+			return false;
+		m_ptr += len;
+		return true;
+	}
+	// Consume a keyword, which has to be followed by a whitespace or the end of file. Ignore the rest of its line.
+	bool keyword_line(const char *kw) {
+		if (! this->keyword(kw) || (m_ptr != m_end && ! is_whitespace(*m_ptr)))
+			return false;
+		this->skip_line();
+		return true;
+	}
+	bool parse_float(float &out) {
+		this->skip_whitespaces();
+		const char *c = m_ptr;
+		if (c != m_end && *c == '+')
+			++ c;
+		auto [pend, ec] = fast_float::from_chars(c, m_end, out);
+		if (pend == c || ec == std::errc::invalid_argument)
+			return false;
+		m_ptr = pend;
+		return true;
+	}
+	// Parse a whitespace delimited token as a float. The token is consumed even if it is not a valid number.
+	bool parse_float_token(float &out) {
+		this->skip_whitespaces();
+		const char *token_begin = m_ptr;
+		while (m_ptr != m_end && ! is_whitespace(*m_ptr))
+			++ m_ptr;
+		if (m_ptr == token_begin)
+			return false;
+		auto [pend, ec] = fast_float::from_chars(*token_begin == '+' ? token_begin + 1 : token_begin, m_ptr, out);
+		return ec != std::errc::invalid_argument;
+	}
+
+private:
+	static bool is_whitespace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f'; }
+
+	const char *m_ptr;
+	const char *m_end;
+};
+
+// Read a single facet from an ASCII .STL file.
+static bool stl_read_ascii_facet(StlAsciiParser &parser, stl_facet &facet)
+{
+	// skip solid/endsolid
+	// (in this order, otherwise it won't work when they are paired in the middle of a file)
+	// name might contain spaces and it also can be empty (just "solid")
+	if (parser.keyword("endsolid"))
+		parser.skip_line();
+	if (parser.keyword("solid"))
+		parser.skip_line();
+	if (! parser.keyword("facet") || ! parser.keyword("normal"))
+		return false;
+	// The facet normal is parsed token by token as to workaround for not a numbers in the normal definition.
+	bool normal_ok = true;
+	for (int i = 0; i < 3; ++ i)
+		if (! parser.parse_float_token(facet.normal(i)))
+			normal_ok = false;
+	if (! normal_ok)
+		// Normal was mangled. Maybe denormals or "not a number" were stored?
+		// Just reset the normal and silently ignore it.
+		memset(&facet.normal, 0, sizeof(facet.normal));
+	if (! parser.keyword("outer") || ! parser.keyword("loop"))
+		return false;
+	for (int j = 0; j < 3; ++ j)
+		if (! parser.keyword("vertex") ||
+			! parser.parse_float(facet.vertex[j](0)) || ! parser.parse_float(facet.vertex[j](1)) || ! parser.parse_float(facet.vertex[j](2)))
+			return false;
+	// Some G-code generators tend to produce text after "endloop" and "endfacet". Just ignore it.
+	return parser.keyword_line("endloop") && parser.keyword_line("endfacet");
+}
+
+// Update the bounding box statistics with the facets starting at first_facet.
+static void stl_facets_stats(stl_file *stl, uint32_t first_facet, bool first)
+{
+	if (first_facet >= stl->stats.number_of_facets)
+		return;
+	// Initialize the max and min values the first time through.
+	stl_facet_stats(stl, stl->facet_start[first_facet], first);
+	using MinMax = std::pair<stl_vertex, stl_vertex>;
+	MinMax bbox = tbb::parallel_reduce(
+		tbb::blocked_range<size_t>(first_facet, stl->stats.number_of_facets),
+		MinMax(stl->stats.min, stl->stats.max),
+		[stl](const tbb::blocked_range<size_t> &range, MinMax bbox) {
+			for (size_t i = range.begin(); i < range.end(); ++ i)
+				for (const stl_vertex &v : stl->facet_start[i].vertex) {
+					bbox.first  = bbox.first.cwiseMin(v);
+					bbox.second = bbox.second.cwiseMax(v);
+				}
+			return bbox;
+		},
+		[](const MinMax &l, const MinMax &r) { return MinMax(l.first.cwiseMin(r.first), l.second.cwiseMax(r.second)); });
+	stl->stats.min = bbox.first;
+	stl->stats.max = bbox.second;
+}
+
 /* Reads the contents of the file pointed to by fp into the stl structure,
    starting at facet first_facet.  The second argument says if it's our first
    time running this for the stl and therefore we should reset our max and min stats. */
 static bool stl_read(stl_file *stl, FILE *fp, int first_facet, bool first)
 {
-	if (stl->stats.type == binary)
-    	fseek(fp, HEADER_SIZE, SEEK_SET);
-  	else
-    	rewind(fp);
-
-  	char normal_buf[3][32];
-  	for (uint32_t i = first_facet; i < stl->stats.number_of_facets; ++ i) {
-  	  	stl_facet facet;
-
-    	if (stl->stats.type == binary) {
-      		// Read a single facet from a binary .STL file. We assume little-endian architecture!
-      		if (fread(&facet, 1, SIZEOF_STL_FACET, fp) != SIZEOF_STL_FACET)
-      			return false;
+	if (stl->stats.type == binary) {
+		fseek(fp, HEADER_SIZE, SEEK_SET);
+		// Read the facets in large blocks instead of facet by facet, unpack them in parallel.
+		const size_t      facets_per_block = 65536;
+		std::vector<char> buffer(facets_per_block * SIZEOF_STL_FACET);
+		for (size_t block_begin = first_facet; block_begin < stl->stats.number_of_facets; block_begin += facets_per_block) {
+			const size_t num_facets = std::min<size_t>(facets_per_block, stl->stats.number_of_facets - block_begin);
+			if (fread(buffer.data(), SIZEOF_STL_FACET, num_facets, fp) != num_facets)
+				return false;
+			tbb::parallel_for(tbb::blocked_range<size_t>(0, num_facets), [stl, &buffer, block_begin](const tbb::blocked_range<size_t> &range) {
+				for (size_t i = range.begin(); i < range.end(); ++ i) {
+					// We assume little-endian architecture!
+					stl_facet  &facet = stl->facet_start[block_begin + i];
+					const char *src   = buffer.data() + i * SIZEOF_STL_FACET;
+					memcpy(facet.normal.data(), src, 12);
+					for (int j = 0; j < 3; ++ j)
+						memcpy(facet.vertex[j].data(), src + 12 + 12 * j, 12);
+					memcpy(facet.extra, src + 48, 2);
 #if BOOST_ENDIAN_BIG_BYTE
-      		// Convert the loaded little endian data to big endian.
-      		stl_internal_reverse_quads((char*)&facet, 48);
+					// Convert the loaded little endian data to big endian.
+					stl_internal_reverse_quads((char*)&facet, 48);
 #endif /* BOOST_ENDIAN_BIG_BYTE */
-    	} else {
-			// Read a single facet from an ASCII .STL file
-			// skip solid/endsolid
-			// (in this order, otherwise it won't work when they are paired in the middle of a file)
-			fscanf(fp, " endsolid%*[^\n]\n");
-			fscanf(fp, " solid%*[^\n]\n");  // name might contain spaces so %*s doesn't work and it also can be empty (just "solid")
-			// Leading space in the fscanf format skips all leading white spaces including numerous new lines and tabs.
-			int res_normal     = fscanf(fp, " facet normal %31s %31s %31s", normal_buf[0], normal_buf[1], normal_buf[2]);
-			assert(res_normal == 3);
-			int res_outer_loop = fscanf(fp, " outer loop");
-			assert(res_outer_loop == 0);
-			int res_vertex1    = fscanf(fp, " vertex %f %f %f", &facet.vertex[0](0), &facet.vertex[0](1), &facet.vertex[0](2));
-			assert(res_vertex1 == 3);
-			int res_vertex2    = fscanf(fp, " vertex %f %f %f", &facet.vertex[1](0), &facet.vertex[1](1), &facet.vertex[1](2));
-			assert(res_vertex2 == 3);
-			// Trailing whitespace is there to eat all whitespaces and empty lines up to the next non-whitespace.
-			int res_vertex3    = fscanf(fp, " vertex %f %f %f ", &facet.vertex[2](0), &facet.vertex[2](1), &facet.vertex[2](2));
-			assert(res_vertex3 == 3);
-			// Some G-code generators tend to produce text after "endloop" and "endfacet". Just ignore it.
-			char buf[2048];
-			fgets(buf, 2047, fp);
-			bool endloop_ok = strncmp(buf, "endloop", 7) == 0 && (buf[7] == '\r' || buf[7] == '\n' || buf[7] == ' ' || buf[7] == '\t');
-			assert(endloop_ok);
-			// Skip the trailing whitespaces and empty lines.
-			fscanf(fp, " ");
-			fgets(buf, 2047, fp);
-			bool endfacet_ok = strncmp(buf, "endfacet", 8) == 0 && (buf[8] == '\r' || buf[8] == '\n' || buf[8] == ' ' || buf[8] == '\t');
-			assert(endfacet_ok);
-			if (res_normal != 3 || res_outer_loop != 0 || res_vertex1 != 3 || res_vertex2 != 3 || res_vertex3 != 3 || ! endloop_ok || ! endfacet_ok) {
+				}
+			});
+		}
+	} else {
+		// Parse the whole file from memory.
+		rewind(fp);
+		std::vector<char> data;
+		char              buf[65536];
+		for (size_t num_read; (num_read = fread(buf, 1, sizeof(buf), fp)) > 0;)
+			data.insert(data.end(), buf, buf + num_read);
+		StlAsciiParser parser(data.data(), data.data() + data.size());
+		for (uint32_t i = first_facet; i < stl->stats.number_of_facets; ++ i) {
+			stl_facet facet;
+			if (! stl_read_ascii_facet(parser, facet)) {
 				BOOST_LOG_TRIVIAL(error) << "Something is syntactically very wrong with this ASCII STL! ";
 				return false;
 			}
-
-			// The facet normal has been parsed as a single string as to workaround for not a numbers in the normal definition.
-			if (sscanf(normal_buf[0], "%f", &facet.normal(0)) != 1 ||
-			    sscanf(normal_buf[1], "%f", &facet.normal(1)) != 1 ||
-			    sscanf(normal_buf[2], "%f", &facet.normal(2)) != 1) {
-			    // Normal was mangled. Maybe denormals or "not a number" were stored?
-			  	// Just reset the normal and silently ignore it.
-			  	memset(&facet.normal, 0, sizeof(facet.normal));
-			}
-		}
-
-#if 0
-		// Report close to zero vertex coordinates. Due to the nature of the floating point numbers,
-		// close to zero values may be represented with singificantly higher precision than the rest of the vertices.
-		// It may be worth to round these numbers to zero during loading to reduce the number of errors reported
-		// during the STL import.
-		for (size_t j = 0; j < 3; ++ j) {
-		if (facet.vertex[j](0) > -1e-12f && facet.vertex[j](0) < 1e-12f)
-		    printf("stl_read: facet %d(0) = %e\r\n", j, facet.vertex[j](0));
-		if (facet.vertex[j](1) > -1e-12f && facet.vertex[j](1) < 1e-12f)
-		    printf("stl_read: facet %d(1) = %e\r\n", j, facet.vertex[j](1));
-		if (facet.vertex[j](2) > -1e-12f && facet.vertex[j](2) < 1e-12f)
-		    printf("stl_read: facet %d(2) = %e\r\n", j, facet.vertex[j](2));
+			// Write the facet into memory.
+			stl->facet_start[i] = facet;
 		}
-#endif
+	}
 
-		// Write the facet into memory.
-		stl->facet_start[i] = facet;
-		stl_facet_stats(stl, facet, first);
-  	}
-  
-  	stl->stats.size = stl->stats.max - stl->stats.min;
-  	stl->stats.bounding_diameter = stl->stats.size.norm();
-  	return true;
+	stl_facets_stats(stl, first_facet, first);
+	stl->stats.size = stl->stats.max - stl->stats.min;
+	stl->stats.bounding_diameter = stl->stats.size.norm();
+	return true;
 }
 
 bool stl_open(stl_file *stl, const char *file)
@@ -15,6 +15,8 @@
 #include "libslic3r/Optimize/NLoptOptimizer.hpp"
 #include "libslic3r/Execution/ExecutionSeq.hpp"
 
+#include <iterator>
+
 namespace Slic3r { namespace arr2 {
 
 struct NFPPackingTag{};
@@ -242,27 +244,51 @@ bool pack(Strategy &strategy,
 
     bool cancelled = strategy.stop_condition();
     const auto & rotations = allowed_rotations(item);
+    const size_t rotations_count = std::distance(rotations.begin(), rotations.end());
+
+    // The NFPs of the rotations do not depend on each other, they are
+    // calculated in parallel, each of them on a copy of the item rotated
+    // accordingly. Only if the item is not already packed.
+    std::vector<ArrItem> rotated_items;
+    std::vector<ExPolygons> nfps;
+    if (!cancelled && !packed) {
+        // The outlines of the packed items may be cached lazily, update
+        // the caches before reading them concurrently.
+        if (rotations_count > 1)
+            for (const auto &fixed : all_items_range(packing_context))
+                fixed_outline(fixed);
+
+        rotated_items.assign(rotations_count, item);
+        nfps.resize(rotations_count);
+        execution::for_each(
+            strategy.ep, size_t(0), rotations_count,
+            [&](size_t rot_idx) {
+                ArrItem &itm = rotated_items[rot_idx];
+                set_rotation(itm, orig_rot + *std::next(rotations.begin(), rot_idx));
+                set_translation(itm, orig_tr);
+                nfps[rot_idx] = calculate_nfp(itm, packing_context, bed,
+                                              strategy.stop_condition);
+            },
+            execution::max_concurrency(strategy.ep));
+
+        cancelled = strategy.stop_condition();
+    }
 
-    // Check all rotations but only if item is not already packed
-    for (auto rot_it = rotations.begin();
-         !cancelled && !packed && rot_it != rotations.end(); ++rot_it) {
-
-        double rot = *rot_it;
-
-        set_rotation(item, orig_rot + rot);
-        set_translation(item, orig_tr);
+    // Pick the best spot of each rotation, the corners of an NFP are
+    // evaluated in parallel
+    for (size_t rot_idx = 0; !cancelled && rot_idx < nfps.size(); ++rot_idx) {
+        const ExPolygons &nfp = nfps[rot_idx];
+        ArrItem &itm = rotated_items[rot_idx];
 
-        auto nfp = calculate_nfp(item, packing_context, bed,
-                                 strategy.stop_condition);
         double score = NaNd;
         if (!nfp.empty()) {
-            score = pick_best_spot_on_nfp(item, nfp, bed, strategy);
+            score = pick_best_spot_on_nfp(itm, nfp, bed, strategy);
 
             cancelled = strategy.stop_condition();
             if (score > final_score) {
                 final_score = score;
-                final_rot   = rot;
-                final_tr    = get_translation(item);
+                final_rot   = *std::next(rotations.begin(), rot_idx);
+                final_tr    = get_translation(itm);
             }
         }
     }
@@ -0,0 +1,108 @@
+#ifndef PAIRNFPCACHE_HPP
+#define PAIRNFPCACHE_HPP
+
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+#include <boost/functional/hash.hpp>
+
+#include "libslic3r/Polygon.hpp"
+
+namespace Slic3r { namespace arr2 {
+
+// Cache of the NFPs of pairs of items. The NFP of two items depends on their
+// shapes and rotations only, the translation of the fixed item just
+// translates the NFP. Thus the NFPs are stored relative to the translation of
+// the fixed item, keyed by the digests of the shapes (see MD5Hasher) and the
+// rotations, and shared by the identical copies of the items. Owned by the
+// packing context, so it lives as long as one arrangement. Thread safe.
+class PairNFPCache
+{
+public:
+    struct Key
+    {
+        std::string fixed_digest;
+        double      fixed_rotation;
+        std::string movable_digest;
+        double      movable_rotation;
+
+        bool operator==(const Key &rhs) const
+        {
+            return fixed_rotation == rhs.fixed_rotation &&
+                   movable_rotation == rhs.movable_rotation &&
+                   fixed_digest == rhs.fixed_digest &&
+                   movable_digest == rhs.movable_digest;
+        }
+    };
+
+    // Returns false if the key is not cached.
+    bool find(const Key &key, Polygons &out) const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        auto it = m_nfps.find(key);
+        if (it == m_nfps.end()) {
+            ++m_misses;
+            return false;
+        }
+
+        ++m_hits;
+        out = it->second;
+
+        return true;
+    }
+
+    void insert(const Key &key, const Polygons &nfp)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        if (m_nfps.size() >= MaxEntries)
+            m_nfps.clear();
+
+        m_nfps.emplace(key, nfp);
+    }
+
+    void clear()
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        m_nfps.clear();
+        m_hits   = 0;
+        m_misses = 0;
+    }
+
+    size_t size() const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        return m_nfps.size();
+    }
+
+    size_t hits() const { return m_hits; }
+    size_t misses() const { return m_misses; }
+
+private:
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const
+        {
+            size_t seed = std::hash<std::string>{}(key.fixed_digest);
+            boost::hash_combine(seed, key.fixed_rotation);
+            boost::hash_combine(seed, key.movable_digest);
+            boost::hash_combine(seed, key.movable_rotation);
+
+            return seed;
+        }
+    };
+
+    // The cache is dropped once it grows over this number of entries.
+    static constexpr size_t MaxEntries = 1 << 16;
+
+    mutable std::shared_mutex                  m_mutex;
+    std::unordered_map<Key, Polygons, KeyHash> m_nfps;
+    mutable std::atomic<size_t>                m_hits { 0 };
+    mutable std::atomic<size_t>                m_misses { 0 };
+};
+
+}} // namespace Slic3r::arr2
+
+#endif // PAIRNFPCACHE_HPP
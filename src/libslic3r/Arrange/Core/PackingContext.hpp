@@ -5,7 +5,10 @@
 #ifndef PACKINGCONTEXT_HPP
 #define PACKINGCONTEXT_HPP
 
+#include <memory>
+
 #include "ArrangeItemTraits.hpp"
+#include "NFP/PairNFPCache.hpp"
 
 namespace Slic3r { namespace arr2 {
 
@@ -43,6 +46,12 @@ struct PackingContextTraits_ {
     {
         return ctx.packed_items_range();
     }
+
+    // returns the cache of the pair NFPs calculated in the context ctx
+    static PairNFPCache &nfp_cache(const Ctx &ctx)
+    {
+        return ctx.nfp_cache();
+    }
 };
 
 template<class Ctx, class ArrItem>
@@ -75,12 +84,20 @@ auto packed_items_range(Ctx &&ctx)
     return PackingContextTraits_<StripCVRef<Ctx>>::packed_items_range(ctx);
 }
 
+template<class Ctx>
+PairNFPCache &nfp_cache(const Ctx &ctx)
+{
+    return PackingContextTraits_<StripCVRef<Ctx>>::nfp_cache(ctx);
+}
+
 template<class ArrItem>
 class DefaultPackingContext {
     using ArrItemRaw = StripCVRef<ArrItem>;
     std::vector<std::reference_wrapper<const ArrItemRaw>> m_fixed;
     std::vector<std::reference_wrapper<ArrItemRaw>> m_packed;
     std::vector<std::reference_wrapper<const ArrItemRaw>> m_items;
+    // Shared by the copies of the context, released with the last of them.
+    std::shared_ptr<PairNFPCache> m_nfp_cache = std::make_shared<PairNFPCache>();
 
 public:
     DefaultPackingContext() = default;
@@ -96,6 +113,7 @@ public:
     auto fixed_items_range() const noexcept { return crange(m_fixed); }
     auto packed_items_range() const noexcept { return crange(m_packed); }
     auto packed_items_range() noexcept { return range(m_packed); }
+    PairNFPCache &nfp_cache() const noexcept { return *m_nfp_cache; }
 
     void add_fixed_item(const ArrItem &itm)
     {
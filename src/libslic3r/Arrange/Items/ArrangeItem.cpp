@@ -13,8 +13,19 @@
 
 #include "libslic3r/Geometry/ConvexHull.hpp"
 
+#include "libslic3r/Utils.hpp"
+
 namespace Slic3r { namespace arr2 {
 
+std::string DecomposedShape::digest_shape(const Polygons &shape)
+{
+    MD5Hasher hasher;
+    for (const Polygon &poly : shape)
+        hasher.process(poly.points.data(), poly.points.size() * sizeof(Point));
+
+    return hasher.digest();
+}
+
 const Polygons &DecomposedShape::transformed_outline() const
 {
     constexpr auto sc = scaled<double>(1.) * scaled<double>(1.);
@@ -116,6 +127,59 @@ Vec2crd DecomposedShape::centroid() const
     return m_centroid;
 }
 
+Polygons calculate_pair_nfp(const ArrangeItem &fixed, const ArrangeItem &movable, PairNFPCache &cache)
+{
+    const DecomposedShape &fixed_shape   = fixed.shape();
+    const DecomposedShape &movable_shape = movable.envelope();
+
+    PairNFPCache::Key key{fixed_shape.shape_digest(), fixed_shape.rotation(),
+                          movable_shape.shape_digest(), movable_shape.rotation()};
+
+    Polygons nfps;
+    if (!cache.find(key, nfps)) {
+        const Polygons &item_outlines = movable_shape.transformed_outline();
+        nfps = reserve_polygons(fixed_shape.contours().size() * item_outlines.size());
+
+        Vec2crd ref_whole = movable_shape.reference_vertex();
+        Polygon subnfp;
+
+        // The fixed polygons should already be a set of strictly convex
+        // polygons, as ArrangeItem stores convex-decomposed polygons
+        for (const Polygon &fixed_poly : fixed_shape.transformed_outline()) {
+            Point max_fixed = Slic3r::reference_vertex(fixed_poly);
+            for (size_t mi = 0; mi < item_outlines.size(); ++mi) {
+                const Polygon &movable_poly = item_outlines[mi];
+                const Vec2crd &mref = movable_shape.reference_vertex(mi);
+                subnfp = nfp_convex_convex_legacy(fixed_poly, movable_poly);
+
+                Vec2crd min_movable = movable_shape.min_vertex(mi);
+
+                Vec2crd dtouch = max_fixed - min_movable;
+                Vec2crd top_other = mref + dtouch;
+                Vec2crd max_nfp = Slic3r::reference_vertex(subnfp);
+                auto dnfp = top_other - max_nfp;
+
+                auto d = ref_whole - mref + dnfp;
+                subnfp.translate(d);
+                nfps.emplace_back(subnfp);
+            }
+        }
+
+        if (nfps.size() > 1)
+            nfps = union_(nfps);
+
+        for (Polygon &p : nfps)
+            p.translate(-fixed_shape.translation());
+
+        cache.insert(key, nfps);
+    }
+
+    for (Polygon &p : nfps)
+        p.translate(fixed_shape.translation());
+
+    return nfps;
+}
+
 DecomposedShape decompose(const ExPolygons &shape)
 {
     return DecomposedShape{convex_decomposition_tess(shape)};
@@ -47,6 +47,7 @@ inline bool check_polygons_are_convex(const Polygons &pp) {
 class DecomposedShape
 {
     Polygons m_shape;
+    std::string m_shape_digest; // MD5 digest of m_shape, independent of the transformation
 
     Vec2crd m_translation{0, 0}; // The translation of the poly
     double  m_rotation{0.0};     // The rotation of the poly in radians
@@ -72,6 +73,7 @@ public:
     explicit DecomposedShape(Polygon sh)
     {
         m_shape.emplace_back(std::move(sh));
+        m_shape_digest = digest_shape(m_shape);
         assert(check_polygons_are_convex(m_shape));
     }
 
@@ -81,11 +83,16 @@ public:
 
     explicit DecomposedShape(Polygons sh) : m_shape{std::move(sh)}
     {
+        m_shape_digest = digest_shape(m_shape);
         assert(check_polygons_are_convex(m_shape));
     }
 
     const Polygons &contours() const { return m_shape; }
 
+    // Identical shapes (e.g. copies of the same object) have the same digest.
+    const std::string &shape_digest() const { return m_shape_digest; }
+    static std::string digest_shape(const Polygons &shape);
+
     const Vec2crd &translation() const { return m_translation; }
     double         rotation() const { return m_rotation; }
 
@@ -281,54 +288,22 @@ template<> struct WritableDataStoreTraits_<ArrangeItem>
     }
 };
 
+// NFP of the envelope of the movable item orbiting around the shape of the
+// fixed item, not normalized, looked up in or stored into the cache. The
+// transformed outlines of the fixed item have to be already cached, if called
+// concurrently.
+Polygons calculate_pair_nfp(const ArrangeItem &fixed, const ArrangeItem &movable, PairNFPCache &cache);
+
 template<class FixedIt, class StopCond = DefaultStopCondition>
 static Polygons calculate_nfp_unnormalized(const ArrangeItem    &item,
                                            const Range<FixedIt> &fixed_items,
+                                           PairNFPCache         &cache,
                                            StopCond &&stop_cond = {})
 {
-    size_t cap = 0;
-
-    for (const ArrangeItem &fixitem : fixed_items) {
-        const Polygons &outlines = fixitem.shape().transformed_outline();
-        cap += outlines.size();
-    }
-
-    const Polygons &item_outlines = item.envelope().transformed_outline();
-
-    auto nfps = reserve_polygons(cap * item_outlines.size());
-
-    Vec2crd ref_whole = item.envelope().reference_vertex();
-    Polygon subnfp;
+    Polygons nfps;
 
     for (const ArrangeItem &fixed : fixed_items) {
-        // fixed_polys should already be a set of strictly convex polygons,
-        // as ArrangeItem stores convex-decomposed polygons
-        const Polygons & fixed_polys = fixed.shape().transformed_outline();
-
-        for (const Polygon &fixed_poly : fixed_polys) {
-            Point max_fixed = Slic3r::reference_vertex(fixed_poly);
-            for (size_t mi = 0; mi < item_outlines.size(); ++mi) {
-                const Polygon &movable = item_outlines[mi];
-                const Vec2crd &mref = item.envelope().reference_vertex(mi);
-                subnfp = nfp_convex_convex_legacy(fixed_poly, movable);
-
-                Vec2crd min_movable = item.envelope().min_vertex(mi);
-
-                Vec2crd dtouch = max_fixed - min_movable;
-                Vec2crd top_other = mref + dtouch;
-                Vec2crd max_nfp = Slic3r::reference_vertex(subnfp);
-                auto dnfp = top_other - max_nfp;
-
-                auto d = ref_whole - mref + dnfp;
-                subnfp.translate(d);
-                nfps.emplace_back(subnfp);
-            }
-
-            if (stop_cond())
-                break;
-
-            nfps = union_(nfps);
-        }
+        append(nfps, calculate_pair_nfp(fixed, item, cache));
 
         if (stop_cond()) {
             nfps.clear();
@@ -336,7 +311,9 @@ static Polygons calculate_nfp_unnormalized(const ArrangeItem    &item,
         }
     }
 
-    return nfps;
+    // A single union of all the pair NFPs is cheaper than merging them
+    // one fixed item after the other.
+    return union_(nfps);
 }
 
 template<> struct NFPArrangeItemTraits_<ArrangeItem> {
@@ -347,7 +324,7 @@ template<> struct NFPArrangeItemTraits_<ArrangeItem> {
                                     StopCond &&stopcond)
     {
         auto static_items = all_items_range(packing_context);
-        Polygons nfps = arr2::calculate_nfp_unnormalized(item, static_items, stopcond);
+        Polygons nfps = arr2::calculate_nfp_unnormalized(item, static_items, nfp_cache(packing_context), stopcond);
 
         ExPolygons nfp_ex;
 
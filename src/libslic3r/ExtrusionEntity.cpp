@@ -548,6 +548,27 @@ void ExtrusionVisitorRecursive::use(ExtrusionEntityCollection &collection)
     }
 }
 
+void ShrinkToFitVisitor::use(ExtrusionMultiPath &multipath)
+{
+    multipath.paths.shrink_to_fit();
+    ExtrusionVisitorRecursive::use(multipath);
+}
+void ShrinkToFitVisitor::use(ExtrusionMultiPath3D &multipath3D)
+{
+    multipath3D.paths.shrink_to_fit();
+    ExtrusionVisitorRecursive::use(multipath3D);
+}
+void ShrinkToFitVisitor::use(ExtrusionLoop &loop)
+{
+    loop.paths.shrink_to_fit();
+    ExtrusionVisitorRecursive::use(loop);
+}
+void ShrinkToFitVisitor::use(ExtrusionEntityCollection &collection)
+{
+    collection.set_entities().shrink_to_fit();
+    ExtrusionVisitorRecursive::use(collection);
+}
+
 void HasRoleVisitor::use(const ExtrusionMultiPath& multipath) {
     for (const ExtrusionPath& path : multipath.paths) {
         path.visit(*this);
@@ -727,6 +727,20 @@ public:
     }
 };
 
+// Release the unused capacity of all the vectors of the extrusions, once they are not going to grow anymore.
+// Millions of small paths are produced for a large print with a fine infill and their vectors are built
+// by push_back() and then simplified, thus a significant part of their memory is never used.
+class ShrinkToFitVisitor : public ExtrusionVisitorRecursive {
+public:
+    using ExtrusionVisitorRecursive::use;
+    void use(ExtrusionPath &path) override { path.polyline.shrink_to_fit(); }
+    void use(ExtrusionPath3D &path3D) override { path3D.polyline.shrink_to_fit(); path3D.z_offsets.shrink_to_fit(); }
+    void use(ExtrusionMultiPath &multipath) override;
+    void use(ExtrusionMultiPath3D &multipath3D) override;
+    void use(ExtrusionLoop &loop) override;
+    void use(ExtrusionEntityCollection &collection) override;
+};
+
 class ExtrusionVolume : public ExtrusionVisitorRecursiveConst {
     bool _with_gap_fill = true;
 public:
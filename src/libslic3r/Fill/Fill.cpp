@@ -1298,6 +1298,7 @@ Polylines Layer::generate_sparse_infill_polylines_for_anchoring(FillAdaptive::Oc
         case ipHoneycomb:
         case ip3DHoneycomb:
         case ipGyroid:
+        case ipSchwarzD:
         case ipHilbertCurve:
         case ipArchimedeanChords:
         case ipOctagramSpiral: break;
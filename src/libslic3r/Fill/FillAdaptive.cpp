@@ -9,6 +9,7 @@
 #include "../Layer.hpp"
 #include "../Print.hpp"
 #include "../ShortestPath.hpp"
+#include "../Utils.hpp"
 
 #include "FillAdaptive.hpp"
 
@@ -29,6 +30,10 @@
 #include <boost/geometry/geometries/segment.hpp>
 #include <boost/geometry/index/rtree.hpp>
 
+#include <oneapi/tbb/blocked_range.h>
+#include <oneapi/tbb/enumerable_thread_specific.h>
+#include <oneapi/tbb/parallel_for.h>
+
 
 namespace Slic3r {
 namespace FillAdaptive {
@@ -263,14 +268,19 @@ struct Octree
     // Octree will allocate its Cubes from the pool. The pool only supports deletion of the complete pool,
     // perfect for building up our octree.
     boost::object_pool<Cube>    pool;
+    // The subtrees are built in parallel, each one allocates its Cubes from its own pool.
+    std::vector<std::unique_ptr<boost::object_pool<Cube>>> subtree_pools;
     Cube*                       root_cube { nullptr };
     Vec3d                       origin;
     std::vector<CubeProperties> cubes_properties;
+    // Fingerprint of the input of build_octree(), to reuse the octree if the input did not change.
+    std::string                 key;
 
     Octree(const Vec3d &origin, const std::vector<CubeProperties> &cubes_properties)
         : root_cube(pool.construct(origin)), origin(origin), cubes_properties(cubes_properties) {}
 
-    void insert_triangle(const Vec3d &a, const Vec3d &b, const Vec3d &c, Cube *current_cube, const BoundingBoxf3 &current_bbox, int depth);
+    void insert_triangle(const Vec3d &a, const Vec3d &b, const Vec3d &c, Cube *current_cube, const BoundingBoxf3 &current_bbox, int depth,
+                         boost::object_pool<Cube> &pool);
 };
 
 void OctreeDeleter::operator()(Octree *p) {
@@ -1471,6 +1481,38 @@ static void transform_center(Cube *current_cube, const Eigen::Matrix3d &rot)
             transform_center(child, rot);
 }
 
+// Bounding box of a child cube, slightly expanded to cope with triangles touching a cube wall and other numeric errors.
+// We will rather densify the octree a bit more than necessary instead of missing a triangle.
+static inline BoundingBoxf3 child_bbox(const Vec3d &center, const BoundingBoxf3 &current_bbox, const Vec3d &child_center_dir)
+{
+    BoundingBoxf3 bbox;
+    for (int k = 0; k < 3; ++ k) {
+        if (child_center_dir[k] == -1.) {
+            bbox.min[k] = current_bbox.min[k];
+            bbox.max[k] = center[k] + EPSILON;
+        } else {
+            bbox.min[k] = center[k] - EPSILON;
+            bbox.max[k] = current_bbox.max[k];
+        }
+    }
+    return bbox;
+}
+
+static std::string octree_key(
+    const indexed_triangle_set  &triangle_mesh,
+    const std::vector<Vec3d>    &overhang_triangles,
+    coordf_t                     line_spacing,
+    bool                         support_overhangs_only)
+{
+    MD5Hasher hasher;
+    hasher.process(&line_spacing, sizeof(line_spacing));
+    hasher.process(&support_overhangs_only, sizeof(support_overhangs_only));
+    hasher.process(triangle_mesh.vertices.data(), triangle_mesh.vertices.size() * sizeof(stl_vertex));
+    hasher.process(triangle_mesh.indices.data(), triangle_mesh.indices.size() * sizeof(stl_triangle_vertex_indices));
+    hasher.process(overhang_triangles.data(), overhang_triangles.size() * sizeof(Vec3d));
+    return hasher.digest();
+}
+
 OctreePtr build_octree(
     // Mesh is rotated to the coordinate system of the octree.
     const indexed_triangle_set  &triangle_mesh,
@@ -1478,50 +1520,140 @@ OctreePtr build_octree(
     // rotated to the coordinate system of the octree.
     const std::vector<Vec3d>    &overhang_triangles, 
     coordf_t                     line_spacing,
-    bool                         support_overhangs_only)
+    bool                         support_overhangs_only,
+    OctreePtr                    previous,
+    bool                         serial)
 {
     assert(line_spacing > 0);
     assert(! std::isnan(line_spacing));
 
+    std::string key = octree_key(triangle_mesh, overhang_triangles, line_spacing, support_overhangs_only);
+    if (previous && previous->key == key) {
+        BOOST_LOG_TRIVIAL(debug) << "Adaptive infill: reusing the octree with line spacing " << line_spacing;
+        return previous;
+    }
+
     BoundingBox3Base<Vec3f>     bbox(triangle_mesh.vertices);
     Vec3d                       cube_center      = bbox.center().cast<double>();
     std::vector<CubeProperties> cubes_properties = make_cubes_properties(double(bbox.size().maxCoeff()), line_spacing);
     auto                        octree           = OctreePtr(new Octree(cube_center, cubes_properties));
+    octree->key = std::move(key);
 
     if (cubes_properties.size() > 1) {
-        Octree *octree_ptr = octree.get();
-        double edge_length_half = 0.5 * cubes_properties.back().edge_length;
-        Vec3d  diag_half(edge_length_half, edge_length_half, edge_length_half);
-        int    max_depth = int(cubes_properties.size()) - 1;
-        auto process_triangle = [octree_ptr, max_depth, diag_half](const Vec3d &a, const Vec3d &b, const Vec3d &c) {
-            octree_ptr->insert_triangle(
-                a, b, c,
-                octree_ptr->root_cube,
-                BoundingBoxf3(octree_ptr->root_cube->center - diag_half, octree_ptr->root_cube->center + diag_half),
-                max_depth);
-        };
-        auto up_vector = support_overhangs_only ? Vec3d(transform_to_octree() * Vec3d(0., 0., 1.)) : Vec3d();
-        for (auto &tri : triangle_mesh.indices) {
-            auto a = triangle_mesh.vertices[tri[0]].cast<double>();
-            auto b = triangle_mesh.vertices[tri[1]].cast<double>();
-            auto c = triangle_mesh.vertices[tri[2]].cast<double>();
-            if (! support_overhangs_only || is_overhang_triangle(a, b, c, up_vector))
-                process_triangle(a, b, c);
-        }
-        for (size_t i = 0; i < overhang_triangles.size(); i += 3)
-            process_triangle(overhang_triangles[i], overhang_triangles[i + 1], overhang_triangles[i + 2]);
+        // Triangles to insert, three vertices per triangle.
+        std::vector<Vec3d> triangles;
         {
-            // Transform the octree to world coordinates to reduce computation when extracting infill lines.
-            auto rot = transform_to_world().toRotationMatrix();
-            transform_center(octree->root_cube, rot);
-            octree->origin = rot * octree->origin;
+            auto up_vector = support_overhangs_only ? Vec3d(transform_to_octree() * Vec3d(0., 0., 1.)) : Vec3d();
+            triangles.reserve(triangle_mesh.indices.size() * 3 + overhang_triangles.size());
+            for (auto &tri : triangle_mesh.indices) {
+                auto a = triangle_mesh.vertices[tri[0]].cast<double>();
+                auto b = triangle_mesh.vertices[tri[1]].cast<double>();
+                auto c = triangle_mesh.vertices[tri[2]].cast<double>();
+                if (! support_overhangs_only || is_overhang_triangle(a, b, c, up_vector)) {
+                    triangles.emplace_back(a);
+                    triangles.emplace_back(b);
+                    triangles.emplace_back(c);
+                }
+            }
+            append(triangles, overhang_triangles);
         }
+
+        Cube              *root_cube        = octree->root_cube;
+        double             edge_length_half = 0.5 * cubes_properties.back().edge_length;
+        Vec3d              diag_half(edge_length_half, edge_length_half, edge_length_half);
+        int                max_depth = int(cubes_properties.size()) - 1;
+        const BoundingBoxf3 root_bbox(root_cube->center - diag_half, root_cube->center + diag_half);
+        auto rot = transform_to_world().toRotationMatrix();
+
+        if (max_depth <= 2 || serial) {
+            // Shallow octree, not worth splitting.
+            for (size_t i = 0; i < triangles.size(); i += 3)
+                octree->insert_triangle(triangles[i], triangles[i + 1], triangles[i + 2], root_cube, root_bbox, max_depth, octree->pool);
+            transform_center(root_cube, rot);
+        } else {
+            // The two top levels of the octree are built serially, then the 64 subtrees below them are built in parallel.
+            // The result is the same as if the triangles were inserted one by one, as a Cube is created
+            // if and only if it intersects a triangle, independently of the order of insertion.
+            static constexpr size_t num_subtrees = 64;
+            const double edge_length_half1 = 0.5 * cubes_properties[max_depth - 1].edge_length;
+            const double edge_length_half2 = 0.5 * cubes_properties[max_depth - 2].edge_length;
+            auto subtree_center = [&root_cube, edge_length_half1, edge_length_half2](size_t subtree_idx) {
+                return Vec3d(root_cube->center + child_centers[subtree_idx / 8] * edge_length_half1 + child_centers[subtree_idx % 8] * edge_length_half2);
+            };
+            auto subtree_bbox = [&root_cube, &root_bbox, edge_length_half1](size_t subtree_idx) {
+                return child_bbox(root_cube->center + child_centers[subtree_idx / 8] * edge_length_half1,
+                    child_bbox(root_cube->center, root_bbox, child_centers[subtree_idx / 8]), child_centers[subtree_idx % 8]);
+            };
+
+            // Distribute the triangles to the subtrees they intersect.
+            using SubtreeTriangles = std::vector<std::vector<size_t>>;
+            tbb::enumerable_thread_specific<SubtreeTriangles> triangles_per_thread([]() { return SubtreeTriangles(num_subtrees); });
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, triangles.size() / 3),
+                [&triangles, &triangles_per_thread, &root_cube, &root_bbox, edge_length_half1](const tbb::blocked_range<size_t> &range) {
+                    SubtreeTriangles &subtree_triangles = triangles_per_thread.local();
+                    for (size_t tri_idx = range.begin(); tri_idx < range.end(); ++ tri_idx) {
+                        const Vec3d &a = triangles[tri_idx * 3];
+                        const Vec3d &b = triangles[tri_idx * 3 + 1];
+                        const Vec3d &c = triangles[tri_idx * 3 + 2];
+                        for (size_t i = 0; i < 8; ++ i)
+                            if (BoundingBoxf3 bbox1 = child_bbox(root_cube->center, root_bbox, child_centers[i]); triangle_AABB_intersects(a, b, c, bbox1)) {
+                                Vec3d center1 = root_cube->center + child_centers[i] * edge_length_half1;
+                                for (size_t j = 0; j < 8; ++ j)
+                                    if (triangle_AABB_intersects(a, b, c, child_bbox(center1, bbox1, child_centers[j])))
+                                        subtree_triangles[i * 8 + j].emplace_back(tri_idx);
+                            }
+                    }
+                });
+
+            // Create the top two levels.
+            std::array<Cube*, num_subtrees> subtrees {};
+            for (size_t subtree_idx = 0; subtree_idx < num_subtrees; ++ subtree_idx)
+                for (const SubtreeTriangles &subtree_triangles : triangles_per_thread)
+                    if (! subtree_triangles[subtree_idx].empty()) {
+                        Cube *&child = root_cube->children[subtree_idx / 8];
+                        if (! child)
+                            child = octree->pool.construct(Vec3d(root_cube->center + child_centers[subtree_idx / 8] * edge_length_half1));
+                        subtrees[subtree_idx] = child->children[subtree_idx % 8] = octree->pool.construct(subtree_center(subtree_idx));
+                        break;
+                    }
+            octree->subtree_pools.resize(num_subtrees);
+
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, num_subtrees, 1),
+                [octree_ptr = octree.get(), &triangles, &triangles_per_thread, &subtrees, &subtree_bbox, &rot, max_depth](const tbb::blocked_range<size_t> &range) {
+                    for (size_t subtree_idx = range.begin(); subtree_idx < range.end(); ++ subtree_idx)
+                        if (Cube *subtree = subtrees[subtree_idx]; subtree) {
+                            auto &pool = octree_ptr->subtree_pools[subtree_idx];
+                            pool = std::make_unique<boost::object_pool<Cube>>();
+                            const BoundingBoxf3 bbox = subtree_bbox(subtree_idx);
+                            for (const SubtreeTriangles &subtree_triangles : triangles_per_thread)
+                                for (size_t tri_idx : subtree_triangles[subtree_idx])
+                                    octree_ptr->insert_triangle(triangles[tri_idx * 3], triangles[tri_idx * 3 + 1], triangles[tri_idx * 3 + 2],
+                                        subtree, bbox, max_depth - 2, *pool);
+                            transform_center(subtree, rot);
+                        }
+                });
+
+            // Transform the two top levels, their subtrees were transformed already.
+            auto transform_one = [&rot](Cube *cube) {
+#ifndef NDEBUG
+                cube->center_octree = cube->center;
+#endif // NDEBUG
+                cube->center = rot * cube->center;
+            };
+            transform_one(root_cube);
+            for (Cube *child : root_cube->children)
+                if (child)
+                    transform_one(child);
+        }
+        // The octree is transformed to world coordinates to reduce computation when extracting infill lines.
+        octree->origin = rot * octree->origin;
     }
 
     return octree;
 }
 
-void Octree::insert_triangle(const Vec3d &a, const Vec3d &b, const Vec3d &c, Cube *current_cube, const BoundingBoxf3 &current_bbox, int depth)
+void Octree::insert_triangle(const Vec3d &a, const Vec3d &b, const Vec3d &c, Cube *current_cube, const BoundingBoxf3 &current_bbox, int depth,
+                             boost::object_pool<Cube> &pool)
 {
     assert(current_cube);
     assert(depth > 0);
@@ -1533,26 +1665,15 @@ void Octree::insert_triangle(const Vec3d &a, const Vec3d &b, const Vec3d &c, Cub
 
     for (size_t i = 0; i < 8; ++ i) {
         const Vec3d &child_center_dir = child_centers[i];
-        // Calculate a slightly expanded bounding box of a child cube to cope with triangles touching a cube wall and other numeric errors.
-        // We will rather densify the octree a bit more than necessary instead of missing a triangle.
-        BoundingBoxf3 bbox;
-        for (int k = 0; k < 3; ++ k) {
-            if (child_center_dir[k] == -1.) {
-                bbox.min[k] = current_bbox.min[k];
-                bbox.max[k] = current_cube->center[k] + EPSILON;
-            } else {
-                bbox.min[k] = current_cube->center[k] - EPSILON;
-                bbox.max[k] = current_bbox.max[k];
-            }
-        }
+        BoundingBoxf3 bbox = child_bbox(current_cube->center, current_bbox, child_center_dir);
         Vec3d child_center = current_cube->center + (child_center_dir * (this->cubes_properties[depth].edge_length / 2.));
         //if (dist2_to_triangle(a, b, c, child_center) < r2_cube) {
         // dist2_to_triangle and r2_cube are commented out too.
         if (triangle_AABB_intersects(a, b, c, bbox)) {
             if (! current_cube->children[i])
-                current_cube->children[i] = this->pool.construct(child_center);
+                current_cube->children[i] = pool.construct(child_center);
             if (depth > 0)
-                this->insert_triangle(a, b, c, current_cube->children[i], bbox, depth);
+                this->insert_triangle(a, b, c, current_cube->children[i], bbox, depth, pool);
         }
     }
 }
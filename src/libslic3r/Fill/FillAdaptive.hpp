@@ -50,7 +50,11 @@ FillAdaptive::OctreePtr         build_octree(
     const std::vector<Vec3d>    &overhang_triangles, 
     coordf_t                     line_spacing, 
     // If true, octree is densified below internal overhangs only.
-    bool                         support_overhangs_only);
+    bool                         support_overhangs_only,
+    // Octree built before, returned back if it was built from the same input.
+    OctreePtr                    previous = OctreePtr(),
+    // Insert the triangles one by one instead of building the subtrees in parallel. For testing.
+    bool                         serial = false);
 
 //
 // Some of the algorithms used by class FillAdaptive were inspired by
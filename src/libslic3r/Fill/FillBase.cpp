@@ -48,6 +48,7 @@ Fill* Fill::new_from_type(const InfillPattern type)
     case ipHoneycomb:           return new FillHoneycomb();
     case ip3DHoneycomb:         return new Fill3DHoneycomb();
     case ipGyroid:              return new FillGyroid();
+    case ipSchwarzD:            return new FillSchwarzD();
     case ipRectilinear:         return new FillRectilinear();
     case ipRectilinearWGapFill: return new FillRectilinearWGapFill();
     case ipAlignedRectilinear:  return new FillAlignedRectilinear();
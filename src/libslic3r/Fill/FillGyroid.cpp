@@ -9,6 +9,7 @@
 #include <cmath>
 #include <algorithm>
 #include <iostream>
+#include <limits>
 
 #include "FillGyroid.hpp"
 
@@ -33,50 +34,70 @@ static inline double f(double x, double z_sin, double z_cos, bool vertical, bool
     }
 }
 
-static inline Polyline make_wave(
-    const std::vector<Vec2d>& one_period, double width, double height, double offset, double scaleFactor,
-    double z_cos, double z_sin, bool vertical, bool flip)
+// One period of a wave, sampled up to the requested tolerance. The waves are built by repeating it along their whole width.
+struct WavePeriod
 {
-    std::vector<Vec2d> points = one_period;
-    double period = points.back()(0);
-    if (width != period) // do not extend if already truncated
-    {
-        points.reserve(one_period.size() * size_t(floor(width / period)));
-        points.pop_back();
-
-        size_t n = points.size();
-        do {
-            points.emplace_back(points[points.size()-n].x() + period, points[points.size()-n].y());
-        } while (points.back()(0) < width - EPSILON);
+    std::vector<Vec2d> points;
+    // Difference of y between the end and the start of the period, the Schwarz D waves are slanted.
+    double             drift { 0. };
+};
 
-        points.emplace_back(Vec2d(width, f(width, z_sin, z_cos, vertical, flip)));
-    }
+// Builds a wave from its period. wave(x, y_near) evaluates the wave at x, on the branch the closest to y_near.
+template<typename WaveFn>
+static inline Polyline make_wave(
+    const WavePeriod &one_period, double width, double height, double offset, double scaleFactor,
+    bool vertical, bool clamp, WaveFn &&wave)
+{
+    const std::vector<Vec2d> &points = one_period.points;
+    const double period = points.back().x();
 
-    // and construct the final polyline to return:
+    // Construct the final polyline directly from the period samples, without an intermediate copy.
     Polyline polyline;
-    polyline.points.reserve(points.size());
-    for (auto& point : points) {
-        point(1) += offset;
-        point(1) = std::clamp(double(point.y()), 0., height);
-        if (vertical)
-            std::swap(point(0), point(1));
-        polyline.points.push_back(Point::round(point * scaleFactor));
+    auto emit = [&polyline, height, offset, scaleFactor, vertical, clamp](double x, double y) {
+        y += offset;
+        if (clamp)
+            y = std::clamp(y, 0., height);
+        polyline.points.push_back(Point::round((vertical ? Vec2d(y, x) : Vec2d(x, y)) * scaleFactor));
+    };
+    if (width == period) {
+        // do not extend if already truncated
+        polyline.points.reserve(points.size());
+        for (const Vec2d &point : points)
+            emit(point.x(), point.y());
+    } else {
+        // The last point of a period is the first point of the next one.
+        const size_t n = points.size() - 1;
+        polyline.points.reserve(n * size_t(ceil(width / period)) + 2);
+        double y_last = 0.;
+        for (size_t i = 0;; ++ i) {
+            const Vec2d &point = points[i % n];
+            const size_t iperiod = i / n;
+            const double x = point.x() + period * double(iperiod);
+            y_last = point.y() + one_period.drift * double(iperiod);
+            emit(x, y_last);
+            if (iperiod > 0 && x >= width - EPSILON)
+                break;
+        }
+        emit(width, wave(width, y_last));
     }
-
     return polyline;
 }
 
-static std::vector<Vec2d> make_one_period(double width, double scaleFactor, double z_cos, double z_sin, bool vertical, bool flip, double tolerance)
+template<typename WaveFn>
+static WavePeriod make_one_period(double width, double dx, double tolerance, WaveFn &&wave)
 {
-    std::vector<Vec2d> points;
-    double dx = M_PI_2; // exact coordinates on main inflexion lobes
+    WavePeriod one_period;
+    std::vector<Vec2d> &points = one_period.points;
     double limit = std::min(2*M_PI, width);
     points.reserve(size_t(ceil(limit / tolerance / 3)));
 
+    // dx: exact coordinates on main inflexion lobes
+    double y = wave(0., 0.);
     for (double x = 0.; x < limit - EPSILON; x += dx) {
-        points.emplace_back(Vec2d(x, f(x, z_sin, z_cos, vertical, flip)));
+        y = wave(x, y);
+        points.emplace_back(Vec2d(x, y));
     }
-    points.emplace_back(Vec2d(limit, f(limit, z_sin, z_cos, vertical, flip)));
+    points.emplace_back(Vec2d(limit, wave(limit, y)));
 
     // piecewise increase in resolution up to requested tolerance
     for(;;)
@@ -86,8 +107,7 @@ static std::vector<Vec2d> make_one_period(double width, double scaleFactor, doub
             auto& lp = points[i-1]; // left point
             auto& rp = points[i];   // right point
             double x = lp(0) + (rp(0) - lp(0)) / 2;
-            double y = f(x, z_sin, z_cos, vertical, flip);
-            Vec2d ip = {x, y};
+            Vec2d ip = {x, wave(x, lp(1))};
             if (std::abs(cross2(Vec2d(ip - lp), Vec2d(ip - rp))) > sqr(tolerance)) {
                 points.emplace_back(std::move(ip));
             }
@@ -103,9 +123,30 @@ static std::vector<Vec2d> make_one_period(double width, double scaleFactor, doub
         }
     }
 
-    return points;
+    if (limit == 2*M_PI)
+        one_period.drift = points.back().y() - points.front().y();
+    return one_period;
 }
 
+// The periods depend on the phase of the layer only, they are shared by all the surfaces of a layer
+// and by the layers with the same phase.
+struct WavePeriodsCache
+{
+    double      z_sin { 0. };
+    double      z_cos { 0. };
+    double      limit { -1. };
+    double      tolerance { -1. };
+    WavePeriod  odd;
+    WavePeriod  even;
+
+    bool matches(double z_sin, double z_cos, double width, double tolerance) const {
+        return this->z_sin == z_sin && this->z_cos == z_cos && this->limit == std::min(2*M_PI, width) && this->tolerance == tolerance;
+    }
+    void set_key(double z_sin, double z_cos, double width, double tolerance) {
+        this->z_sin = z_sin; this->z_cos = z_cos; this->limit = std::min(2*M_PI, width); this->tolerance = tolerance;
+    }
+};
+
 static Polylines make_gyroid_waves(coordf_t gridZ, coordf_t scaleFactor, double width, double height, double tolerance)
 {
 
@@ -126,24 +167,83 @@ static Polylines make_gyroid_waves(coordf_t gridZ, coordf_t scaleFactor, double
         std::swap(width,height);
     }
 
-    std::vector<Vec2d> one_period_odd = make_one_period(width, scaleFactor, z_cos, z_sin, vertical, flip, tolerance); // creates one period of the waves, so it doesn't have to be recalculated all the time
-    flip = !flip;                                                                   // even polylines are a bit shifted
-    std::vector<Vec2d> one_period_even = make_one_period(width, scaleFactor, z_cos, z_sin, vertical, flip, tolerance);
+    auto wave_odd  = [z_sin, z_cos, vertical, flip](double x, double) { return f(x, z_sin, z_cos, vertical, flip); };
+    auto wave_even = [z_sin, z_cos, vertical, flip](double x, double) { return f(x, z_sin, z_cos, vertical, ! flip); };
+    // creates one period of the waves, so it doesn't have to be recalculated all the time
+    static thread_local WavePeriodsCache cache;
+    if (! cache.matches(z_sin, z_cos, width, tolerance)) {
+        cache.set_key(z_sin, z_cos, width, tolerance);
+        cache.odd  = make_one_period(width, M_PI_2, tolerance, wave_odd);
+        // even polylines are a bit shifted
+        cache.even = make_one_period(width, M_PI_2, tolerance, wave_even);
+    }
     Polylines result;
 
     for (double y0 = lower_bound; y0 < upper_bound + EPSILON; y0 += M_PI) {
         // creates odd polylines
-        result.emplace_back(make_wave(one_period_odd, width, height, y0, scaleFactor, z_cos, z_sin, vertical, flip));
+        result.emplace_back(make_wave(cache.odd, width, height, y0, scaleFactor, vertical, true, wave_odd));
         // creates even polylines
         y0 += M_PI;
         if (y0 < upper_bound + EPSILON) {
-            result.emplace_back(make_wave(one_period_even, width, height, y0, scaleFactor, z_cos, z_sin, vertical, flip));
+            result.emplace_back(make_wave(cache.even, width, height, y0, scaleFactor, vertical, true, wave_even));
         }
     }
 
     return result;
 }
 
+// Schwarz D surface: sin(x)sin(y)sin(z) + sin(x)cos(y)cos(z) + cos(x)sin(y)cos(z) + cos(x)cos(y)sin(z) = 0.
+// At a given z it reads cos(x - z) sin(y) + sin(x + z) cos(y) = 0, thus the waves are y = atan2(-sin(x + z), cos(x - z)) + k * PI.
+// The waves are slanted, over one period y changes by 2 * PI, in a direction alternating with z.
+static Polylines make_schwarz_d_waves(coordf_t gridZ, coordf_t scaleFactor, double width, double height, double tolerance)
+{
+    const double z     = gridZ / scaleFactor;
+    const double z_sin = sin(z);
+    const double z_cos = cos(z);
+
+    // Continuous branch of the wave the closest to y_near.
+    auto wave = [z_sin, z_cos](double x, double y_near) {
+        const double x_sin = sin(x);
+        const double x_cos = cos(x);
+        double y = atan2(- (x_sin * z_cos + x_cos * z_sin), x_cos * z_cos + x_sin * z_sin);
+        return y + 2. * M_PI * std::round((y_near - y) / (2. * M_PI));
+    };
+    static thread_local WavePeriodsCache cache;
+    if (! cache.matches(z_sin, z_cos, width, tolerance)) {
+        cache.set_key(z_sin, z_cos, width, tolerance);
+        // Denser initial sampling, the waves are steep close to the saddle points.
+        cache.odd = make_one_period(width, M_PI / 8., tolerance, wave);
+    }
+    const WavePeriod &one_period = cache.odd;
+
+    // Range of y of the wave over the whole width, to generate just the waves crossing the bounding box.
+    double y_min = std::numeric_limits<double>::max();
+    double y_max = std::numeric_limits<double>::lowest();
+    for (const Vec2d &point : one_period.points) {
+        y_min = std::min(y_min, point.y());
+        y_max = std::max(y_max, point.y());
+    }
+    const double drift = one_period.drift * ceil(width / (2*M_PI));
+    y_min += std::min(0., drift);
+    y_max += std::max(0., drift);
+
+    // The waves are clipped by the caller, they are not clamped to the bounding box as they are slanted.
+    Polylines result;
+    for (double y0 = floor(- y_max / M_PI) * M_PI; y0 + y_min < height + EPSILON; y0 += M_PI)
+        result.emplace_back(make_wave(one_period, width, height, y0, scaleFactor, false, false, wave));
+    return result;
+}
+
+Polylines FillGyroid::make_waves(coordf_t gridZ, coordf_t scaleFactor, double width, double height, double tolerance) const
+{
+    return make_gyroid_waves(gridZ, scaleFactor, width, height, tolerance);
+}
+
+Polylines FillSchwarzD::make_waves(coordf_t gridZ, coordf_t scaleFactor, double width, double height, double tolerance) const
+{
+    return make_schwarz_d_waves(gridZ, scaleFactor, width, height, tolerance);
+}
+
 void FillGyroid::_fill_surface_single(
     const FillParams                &params, 
     unsigned int                     thickness_layers,
@@ -159,7 +259,7 @@ void FillGyroid::_fill_surface_single(
     // Distance between the gyroid waves in scaled coordinates.
     coord_t     line_spacing = _line_spacing_for_density(params);
     // Density adjusted to have a good %of weight.
-    line_spacing /= FillGyroid::DENSITY_ADJUST;
+    line_spacing /= this->density_adjust();
 
     // align bounding box to a multiple of our grid module
     bb.merge(align_to_grid(bb.min, Point(2*M_PI*line_spacing, 2*M_PI*line_spacing)));
@@ -169,7 +269,7 @@ void FillGyroid::_fill_surface_single(
     const double tolerance = params.config->get_computed_value("resolution_internal") / unscaled(line_spacing);
 
     // generate pattern
-    Polylines polylines = make_gyroid_waves(
+    Polylines polylines = this->make_waves(
         scale_d(this->z),
         coordf_t(line_spacing),
         ceil(bb.size()(0) / line_spacing) + 1.,
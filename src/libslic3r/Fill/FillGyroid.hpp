@@ -24,6 +24,10 @@ public:
 
 
 protected:
+    virtual double density_adjust() const { return DENSITY_ADJUST; }
+    // Waves of the surface at gridZ, in the grid units scaled by scaleFactor, not yet clipped.
+    virtual Polylines make_waves(coordf_t gridZ, coordf_t scaleFactor, double width, double height, double tolerance) const;
+
     // Correction applied to regular infill angle to maximize printing
     // speed in default configuration (45 degrees)
     float _layer_angle(size_t idx) const override { return this->can_angle_cross ? float(Geometry::deg2rad(-45.)) : 0.f; }
@@ -36,6 +40,21 @@ protected:
         Polylines                       &polylines_out) const override;
 };
 
+// Schwarz Diamond triply periodic minimal surface, built on the gyroid waves.
+class FillSchwarzD : public FillGyroid
+{
+public:
+    FillSchwarzD() : FillGyroid() {}
+    Fill* clone() const override { return new FillSchwarzD(*this); }
+
+    // Density adjustment to have the same weight as the gyroid: the slanted waves are about 1.24x longer.
+    static constexpr double DENSITY_ADJUST = 1.97;
+
+protected:
+    double density_adjust() const override { return DENSITY_ADJUST; }
+    Polylines make_waves(coordf_t gridZ, coordf_t scaleFactor, double width, double height, double tolerance) const override;
+};
+
 } // namespace Slic3r
 
 #endif // slic3r_FillGyroid_hpp_
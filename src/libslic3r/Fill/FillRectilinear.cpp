@@ -1126,6 +1126,62 @@ bool validate_segment_intersection_connectivity(const std::vector<SegmentedInter
 }
 #endif /* NDEBUG */
 
+// Intersections of a vertical line sorted by their contour, their type and their contour segment.
+// Replaces a linear scan of the vertical line by a binary search when looking up the intersection closest
+// to a contour segment along the contour, which made connecting the lines of large solid surfaces quadratic.
+class ContourIntersectionIndex
+{
+public:
+    ContourIntersectionIndex() = default;
+    explicit ContourIntersectionIndex(const SegmentedIntersectionLine &il) {
+        m_entries.reserve(il.intersections.size());
+        for (size_t i = 0; i < il.intersections.size(); ++ i) {
+            const SegmentIntersection &itsct = il.intersections[i];
+            m_entries.push_back({ itsct.iContour, itsct.type, itsct.iSegment, int(i) });
+        }
+        std::sort(m_entries.begin(), m_entries.end());
+    }
+
+    // Index of the intersection with contour iContour of the given type, closest to iSegment in the number of contour segments,
+    // and that distance. If before, the distance is measured from the intersection to iSegment in the direction of increasing segment indices,
+    // otherwise from iSegment to the intersection. On a tie, the intersection with the lowest index is returned.
+    // Returns (-1, max int) if there is no such intersection.
+    std::pair<int, int> closest(size_t iContour, SegmentIntersection::SegmentIntersectionType type, size_t iSegment, size_t num_segments, bool before) const
+    {
+        auto begin = std::lower_bound(m_entries.begin(), m_entries.end(), Entry{ iContour, type, 0, std::numeric_limits<int>::min() });
+        auto end   = std::lower_bound(begin, m_entries.end(), Entry{ iContour, SegmentIntersection::SegmentIntersectionType(type + 1), 0, std::numeric_limits<int>::min() });
+        if (begin == end)
+            return { -1, std::numeric_limits<int>::max() };
+        auto first_of_segment = [begin](auto it) { return std::lower_bound(begin, it, Entry{ it->iContour, it->type, it->iSegment, std::numeric_limits<int>::min() }); };
+        auto it = std::lower_bound(begin, end, Entry{ iContour, type, iSegment, std::numeric_limits<int>::min() });
+        if (before) {
+            // The last segment not above iSegment, wrapping around to the last segment.
+            if (it == end || it->iSegment != iSegment)
+                it = first_of_segment(it == begin ? end - 1 : it - 1);
+        } else if (it == end) {
+            // The first segment not below iSegment, wrapping around to the first segment.
+            it = begin;
+        }
+        int d = before ? int(iSegment) - int(it->iSegment) : int(it->iSegment) - int(iSegment);
+        if (d < 0)
+            d += int(num_segments);
+        return { it->idx, d };
+    }
+
+private:
+    struct Entry {
+        size_t                                      iContour;
+        SegmentIntersection::SegmentIntersectionType type;
+        size_t                                      iSegment;
+        int                                         idx;
+        bool operator<(const Entry &rhs) const {
+            return iContour < rhs.iContour || (iContour == rhs.iContour &&
+                (type < rhs.type || (type == rhs.type && (iSegment < rhs.iSegment || (iSegment == rhs.iSegment && idx < rhs.idx)))));
+        }
+    };
+    std::vector<Entry> m_entries;
+};
+
 // Connect each contour / vertical line intersection point with another two contour / vertical line intersection points.
 // (fill in SegmentIntersection::{prev_on_contour, prev_on_contour_vertical, next_on_contour, next_on_contour_vertical}.
 // These contour points are either on the same vertical line, or on the vertical line left / right to the current one.
@@ -1133,10 +1189,18 @@ static void connect_segment_intersections_by_contours(
     const ExPolygonWithOffset& poly_with_offset, std::vector<SegmentedIntersectionLine>& segs,
     const FillParams& params, const coord_t link_max_length)
 {
-    for (size_t i_vline = 0; i_vline < segs.size(); ++i_vline) {
+    std::vector<ContourIntersectionIndex> indices(segs.size());
+    Slic3r::parallel_for(size_t(0), segs.size(), [&segs, &indices](size_t i_vline) {
+        indices[i_vline] = ContourIntersectionIndex(segs[i_vline]);
+    });
+
+    // The vertical lines are processed independently: only the links of the intersections of the processed line are written,
+    // the contour, segment and type of the intersections of the neighbor lines are read only.
+    Slic3r::parallel_for(size_t(0), segs.size(), [&poly_with_offset, &segs, &indices, &params, link_max_length](size_t i_vline) {
         SegmentedIntersectionLine& il = segs[i_vline];
-        const SegmentedIntersectionLine* il_prev = i_vline > 0 ? &segs[i_vline - 1] : nullptr;
-        const SegmentedIntersectionLine* il_next = i_vline + 1 < segs.size() ? &segs[i_vline + 1] : nullptr;
+        const ContourIntersectionIndex& index = indices[i_vline];
+        const ContourIntersectionIndex* index_prev = i_vline > 0 ? &indices[i_vline - 1] : nullptr;
+        const ContourIntersectionIndex* index_next = i_vline + 1 < segs.size() ? &indices[i_vline + 1] : nullptr;
 
         for (size_t i_intersection = 0; i_intersection < il.intersections.size(); ++i_intersection) {
             SegmentIntersection& itsct = il.intersections[i_intersection];
@@ -1144,64 +1208,46 @@ static void connect_segment_intersections_by_contours(
             const bool           forward = itsct.is_low(); // == poly_with_offset.is_contour_ccw(intrsctn->iContour);
 
             // 1) Find possible connection points on the previous / next vertical line.
-            // Find an intersection point on il_prev, intersecting i_intersection
+            // Find an intersection point on the previous line, intersecting i_intersection
             // at the same orientation as i_intersection, and being closest to i_intersection
             // in the number of contour segments, when following the direction of the contour.
-            //FIXME this has O(n) time complexity. Likely an O(log(n)) scheme is possible.
-            int iprev = -1;
-            int d_prev = std::numeric_limits<int>::max();
-            if (il_prev) {
-                for (int i = 0; i < il_prev->intersections.size(); ++i) {
-                    const SegmentIntersection& itsct2 = il_prev->intersections[i];
-                    if (itsct.iContour == itsct2.iContour && itsct.type == itsct2.type) {
-                        // The intersection points lie on the same contour and have the same orientation.
-                        // Find the intersection point with a shortest path in the direction of the contour.
-                        int d = distance_of_segmens(poly, itsct2.iSegment, itsct.iSegment, forward);
-                        if (d < d_prev) {
-                            iprev = i;
-                            d_prev = d;
-                        }
-                    }
-                }
-            }
-
-            // The same for il_next.
-            int inext = -1;
-            int d_next = std::numeric_limits<int>::max();
-            if (il_next) {
-                for (size_t i = 0; i < il_next->intersections.size(); ++i) {
-                    const SegmentIntersection& itsct2 = il_next->intersections[i];
-                    if (itsct.iContour == itsct2.iContour && itsct.type == itsct2.type) {
-                        // The intersection points lie on the same contour and have the same orientation.
-                        // Find the intersection point with a shortest path in the direction of the contour.
-                        int d = distance_of_segmens(poly, itsct.iSegment, itsct2.iSegment, forward);
-                        if (d < d_next) {
-                            inext = int(i);
-                            d_next = d;
-                        }
-                    }
-                }
-            }
+            auto [iprev, d_prev] = index_prev ?
+                index_prev->closest(itsct.iContour, itsct.type, itsct.iSegment, poly.points.size(), forward) :
+                std::pair<int, int>(-1, std::numeric_limits<int>::max());
+            // The same for the next line.
+            auto [inext, d_next] = index_next ?
+                index_next->closest(itsct.iContour, itsct.type, itsct.iSegment, poly.points.size(), ! forward) :
+                std::pair<int, int>(-1, std::numeric_limits<int>::max());
 
             // 2) Find possible connection points on the same vertical line.
             bool same_prev = false;
             bool same_next = false;
             // Does the perimeter intersect the current vertical line above intrsctn?
-            for (size_t i = 0; i < il.intersections.size(); ++i)
-                if (const SegmentIntersection& it2 = il.intersections[i];
-                    i != i_intersection && it2.iContour == itsct.iContour && it2.type != itsct.type) {
-                int d = distance_of_segmens(poly, it2.iSegment, itsct.iSegment, forward);
-                if (d < d_prev) {
-                    iprev = i;
-                    d_prev = d;
-                    same_prev = true;
-                }
-                d = distance_of_segmens(poly, itsct.iSegment, it2.iSegment, forward);
-                if (d < d_next) {
-                    inext = i;
-                    d_next = d;
-                    same_next = true;
+            // Only intersections of other types than itsct are considered, thus itsct itself is never returned.
+            int  iprev_same = -1, d_prev_same = std::numeric_limits<int>::max();
+            int  inext_same = -1, d_next_same = std::numeric_limits<int>::max();
+            for (auto type : { SegmentIntersection::OUTER_LOW, SegmentIntersection::OUTER_HIGH, SegmentIntersection::INNER_LOW, SegmentIntersection::INNER_HIGH })
+                if (type != itsct.type) {
+                    auto [i, d] = index.closest(itsct.iContour, type, itsct.iSegment, poly.points.size(), forward);
+                    if (d < d_prev_same || (d == d_prev_same && i < iprev_same)) {
+                        iprev_same  = i;
+                        d_prev_same = d;
+                    }
+                    std::tie(i, d) = index.closest(itsct.iContour, type, itsct.iSegment, poly.points.size(), ! forward);
+                    if (d < d_next_same || (d == d_next_same && i < inext_same)) {
+                        inext_same  = i;
+                        d_next_same = d;
+                    }
                 }
+            if (d_prev_same < d_prev) {
+                iprev = iprev_same;
+                d_prev = d_prev_same;
+                same_prev = true;
+            }
+            if (d_next_same < d_next) {
+                inext = inext_same;
+                d_next = d_next_same;
+                same_next = true;
             }
             // note: here, an intersection can have its prev to vertical on the same line, but the other intersection can have its intersection on horizontal
             // it can be problematic...
@@ -1316,7 +1362,7 @@ static void connect_segment_intersections_by_contours(
                 it2.next_on_contour_quality = SegmentIntersection::LinkQuality::Invalid;
             }
         }
-    }
+    });
 
     assert(validate_segment_intersection_connectivity(segs));
 }
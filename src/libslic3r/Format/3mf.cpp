@@ -23,6 +23,10 @@
 #include <stdexcept>
 #include <optional>
 #include <string_view>
+#include <algorithm>
+#include <charconv>
+#include <functional>
+#include <atomic>
 
 #include <boost/assign.hpp>
 #include <boost/bimap.hpp>
@@ -49,6 +53,10 @@ namespace pt = boost::property_tree;
 
 #include <fast_float/fast_float.h>
 
+#include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/blocked_range.h>
+#include <oneapi/tbb/task_arena.h>
+
 #include "bbs_3mf.hpp"
 
 // Slightly faster than sprintf("%.9g"), but there is an issue with the karma floating point formatter,
@@ -339,6 +347,264 @@ bool is_valid_object_type(const std::string& type)
     return false;
 }
 
+// Splits the stream of the .model file: the content of the <vertices> and <triangles> elements, which makes
+// the bulk of the file, is not passed to the xml parser, but collected as raw text to be decoded later
+// by tokenize_mesh_elements(). The rest of the file is passed to the xml parser, including the start and
+// end tags of the <vertices> and <triangles> elements. Comments, CDATA sections and processing instructions
+// are passed to the xml parser without looking for tags inside of them, and a <vertices> or <triangles>
+// element containing any of them is passed to the xml parser as a whole.
+class ModelMeshDataSplitter
+{
+public:
+    enum class ESection { Vertices, Triangles };
+
+    // Passes data to the xml parser, returns false if the parser failed.
+    using ParseFn   = std::function<bool(const char* data, size_t len, bool is_final)>;
+    // Receives the content of a <vertices> or <triangles> element, called after the start tag of the element
+    // was passed to the xml parser.
+    using SectionFn = std::function<void(ESection section, std::string&& data)>;
+
+    ModelMeshDataSplitter(ParseFn parse_fn, SectionFn section_fn) : m_parse_fn(std::move(parse_fn)), m_section_fn(std::move(section_fn)) {}
+
+    // Processes the next chunk of the file.
+    bool process(const char* data, size_t len);
+    // Passes the data kept from the last chunk to the xml parser, to be called at the end of the file.
+    bool finalize() { return m_parse_fn(m_pending.data(), m_pending.size(), true); }
+
+private:
+    ParseFn   m_parse_fn;
+    SectionFn m_section_fn;
+    // Inside of the content of a <vertices> or <triangles> element.
+    bool      m_in_section{ false };
+    ESection  m_section{ ESection::Vertices };
+    // End of the comment, CDATA section or processing instruction being passed to the xml parser, if any.
+    const char* m_markup_end{ nullptr };
+    // Content of the current section or a tag possibly split by the end of the last chunk.
+    std::string m_pending;
+};
+
+static bool is_xml_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Position of the first comment, CDATA section or processing instruction starting in [from, to) of data.
+static size_t find_xml_markup(const std::string& data, size_t from, size_t to)
+{
+    for (size_t lt = data.find('<', from); lt < to && lt + 1 < data.size(); lt = data.find('<', lt + 1))
+        if (data[lt + 1] == '!' || data[lt + 1] == '?')
+            return lt;
+    return std::string::npos;
+}
+
+bool ModelMeshDataSplitter::process(const char* data, size_t len)
+{
+    // the longest tag looked for including its leading '<' and the following character
+    static constexpr const size_t MAX_TAG_LEN = 11;
+
+    std::string buffer;
+    if (!m_in_section && !m_pending.empty()) {
+        // complete the tag split by the end of the last chunk
+        buffer = std::move(m_pending);
+        m_pending.clear();
+        buffer.append(data, len);
+        data = buffer.data();
+        len = buffer.size();
+    }
+
+    const char* p = data;
+    const char* end = data + len;
+    // beginning of the data not passed to the xml parser yet, outside of a section
+    const char* xml_begin = p;
+    while (p != end) {
+        if (m_in_section) {
+            const std::string_view end_tag = (m_section == ESection::Vertices) ? "</vertices" : "</triangles";
+            // the end tag may have been split by the end of the last chunk
+            const size_t search_from = (m_pending.size() < end_tag.size()) ? 0 : m_pending.size() - end_tag.size() + 1;
+            const size_t markup_from = m_pending.empty() ? 0 : m_pending.size() - 1;
+            m_pending.append(p, end);
+            p = end;
+            const size_t pos = m_pending.find(end_tag.data(), search_from, end_tag.size());
+            if (find_xml_markup(m_pending, markup_from, pos) != std::string::npos) {
+                // the end tag may be hidden by a comment or a CDATA section, or faked inside of one,
+                // the section is passed to the xml parser with the rest of the file
+                buffer = std::move(m_pending);
+                m_pending.clear();
+                m_in_section = false;
+                p = xml_begin = buffer.data();
+                end = p + buffer.size();
+                continue;
+            }
+            if (pos == std::string::npos)
+                return true;
+
+            // the data following the section go to the xml parser again
+            buffer = m_pending.substr(pos);
+            m_pending.resize(pos);
+            // skip sections containing no element
+            if (m_pending.find('<') != std::string::npos)
+                m_section_fn(m_section, std::move(m_pending));
+            m_pending.clear();
+            m_in_section = false;
+            p = xml_begin = buffer.data();
+            end = p + buffer.size();
+        }
+        else if (m_markup_end != nullptr) {
+            const std::string_view markup_end(m_markup_end);
+            const char* found = std::search(p, end, markup_end.begin(), markup_end.end());
+            if (found == end) {
+                // the end of the markup may be split by the end of the chunk, keep its beginning for the next chunk
+                const char* keep = end - std::min(size_t(end - p), markup_end.size() - 1);
+                if (!m_parse_fn(xml_begin, keep - xml_begin, false))
+                    return false;
+                m_pending.assign(keep, end);
+                return true;
+            }
+            p = found + markup_end.size();
+            m_markup_end = nullptr;
+        }
+        else {
+            const char* lt = static_cast<const char*>(::memchr(p, '<', end - p));
+            if (lt == nullptr)
+                break;
+
+            if (size_t(end - lt) < MAX_TAG_LEN) {
+                // the tag may be split by the end of the chunk, keep it for the next chunk
+                if (!m_parse_fn(xml_begin, lt - xml_begin, false))
+                    return false;
+                m_pending.assign(lt, end);
+                return true;
+            }
+
+            if (lt[1] == '?' || lt[1] == '!') {
+                // the content of a comment, a CDATA section or a processing instruction is not looked into
+                m_markup_end = (lt[1] == '?') ? "?>" : (::strncmp(lt + 2, "--", 2) == 0) ? "-->" : (::strncmp(lt + 2, "[CDATA[", 7) == 0) ? "]]>" : ">";
+                p = lt + 2;
+                continue;
+            }
+
+            auto match_tag = [lt](const char* name, size_t name_len) {
+                return ::strncmp(lt + 1, name, name_len) == 0 && (is_xml_space(lt[name_len + 1]) || lt[name_len + 1] == '>' || lt[name_len + 1] == '/');
+            };
+            const bool vertices = match_tag("vertices", 8);
+            if (!vertices && !match_tag("triangles", 9)) {
+                p = lt + 1;
+                continue;
+            }
+
+            const char* gt = static_cast<const char*>(::memchr(lt, '>', end - lt));
+            if (gt == nullptr) {
+                // the tag is split by the end of the chunk, keep it for the next chunk
+                if (!m_parse_fn(xml_begin, lt - xml_begin, false))
+                    return false;
+                m_pending.assign(lt, end);
+                return true;
+            }
+
+            // pass the start tag to the xml parser
+            if (!m_parse_fn(xml_begin, gt + 1 - xml_begin, false))
+                return false;
+            // empty elements have no content
+            if (gt[-1] != '/') {
+                m_in_section = true;
+                m_section = vertices ? ESection::Vertices : ESection::Triangles;
+            }
+            p = xml_begin = gt + 1;
+        }
+    }
+
+    return m_in_section || m_parse_fn(xml_begin, end - xml_begin, false);
+}
+
+// Specialised tokenizer of the content of the <vertices> and <triangles> elements as written by PrusaSlicer
+// and by most of the other applications: a sequence of empty elements with attributes not containing entities.
+// Calls attribute_fn(name, value) for each attribute and end_element_fn() at the end of each element.
+// Returns false for anything else (e.g. comments, entities or other elements), the data has to be passed
+// to the xml parser in that case.
+template<class AttributeFn, class EndElementFn>
+static bool tokenize_mesh_elements(const std::string& data, const char* element_name, AttributeFn attribute_fn, EndElementFn end_element_fn)
+{
+    const size_t name_len = ::strlen(element_name);
+    const char* p = data.data();
+    const char* end = p + data.size();
+    auto skip_spaces = [&p, end]() {
+        while (p != end && is_xml_space(*p))
+            ++p;
+    };
+
+    for (;;) {
+        skip_spaces();
+        if (p == end)
+            return true;
+        if (size_t(end - p) < name_len + 2 || *p != '<' || ::strncmp(p + 1, element_name, name_len) != 0)
+            return false;
+        p += name_len + 1;
+        if (!is_xml_space(*p) && *p != '/' && *p != '>')
+            return false;
+
+        for (;;) {
+            skip_spaces();
+            if (p == end)
+                return false;
+            if (*p == '/') {
+                // end of an empty element
+                if (++p == end || *p != '>')
+                    return false;
+                ++p;
+                break;
+            }
+            if (*p == '>') {
+                // end of the start tag, only the end tag may follow
+                ++p;
+                skip_spaces();
+                if (size_t(end - p) < name_len + 3 || p[0] != '<' || p[1] != '/' || ::strncmp(p + 2, element_name, name_len) != 0)
+                    return false;
+                p += name_len + 2;
+                skip_spaces();
+                if (p == end || *p != '>')
+                    return false;
+                ++p;
+                break;
+            }
+
+            const char* name_begin = p;
+            while (p != end && *p != '=' && !is_xml_space(*p))
+                ++p;
+            const std::string_view name(name_begin, p - name_begin);
+            skip_spaces();
+            if (name.empty() || p == end || *p != '=')
+                return false;
+            ++p;
+            skip_spaces();
+            if (p == end || (*p != '"' && *p != '\''))
+                return false;
+            const char quote = *p++;
+            const char* value_end = static_cast<const char*>(::memchr(p, quote, end - p));
+            if (value_end == nullptr)
+                return false;
+            const std::string_view value(p, value_end - p);
+            if (value.find_first_of("&<") != std::string_view::npos)
+                return false;
+            attribute_fn(name, value);
+            p = value_end + 1;
+        }
+
+        end_element_fn();
+    }
+}
+
+// Same as get_attribute_value_int()
+static int parse_int(std::string_view value)
+{
+    int ret = 0;
+    const char* begin = value.data();
+    const char* end = begin + value.size();
+    if (begin != end && *begin == '+')
+        ++begin;
+    std::from_chars(begin, end, ret);
+    return ret;
+}
+
 namespace Slic3r {
 
     // Base class with error messages management
@@ -387,8 +653,12 @@ namespace Slic3r {
             std::vector<std::string> custom_supports;
             std::vector<std::string> custom_seam;
             std::vector<std::string> mm_segmentation;
+            // Raw content of the <vertices> and <triangles> elements, decoded by _decode_meshes()
+            // once the whole .model file is read.
+            std::string vertices_data;
+            std::string triangles_data;
 
-            bool empty() { return vertices.empty() || triangles.empty(); }
+            bool empty() { return (vertices.empty() && vertices_data.empty()) || (triangles.empty() && triangles_data.empty()); }
 
             void reset() {
                 vertices.clear();
@@ -396,6 +666,8 @@ namespace Slic3r {
                 custom_supports.clear();
                 custom_seam.clear();
                 mm_segmentation.clear();
+                vertices_data.clear();
+                triangles_data.clear();
             }
         };
 
@@ -604,6 +876,17 @@ namespace Slic3r {
         bool _handle_start_triangle(const char** attributes, unsigned int num_attributes);
         bool _handle_end_triangle();
 
+        static void _add_vertex(Geometry& geometry, const char** attributes, unsigned int num_attributes, float unit_factor);
+        static void _add_triangle(Geometry& geometry, const char** attributes, unsigned int num_attributes);
+
+        // Decodes the raw content of the <vertices> and <triangles> elements of all the objects, in parallel.
+        // Reports the id of the first object with invalid mesh data.
+        bool _decode_meshes();
+        static bool _decode_vertices(Geometry& geometry, float unit_factor);
+        static bool _decode_triangles(Geometry& geometry);
+        // Fallback for the content not handled by the specialised tokenizer.
+        static bool _parse_mesh_data_xml(Geometry& geometry, ModelMeshDataSplitter::ESection section, float unit_factor);
+
         bool _handle_start_components(const char** attributes, unsigned int num_attributes);
         bool _handle_end_components();
 
@@ -1154,8 +1437,18 @@ namespace Slic3r {
             XML_Parser& parser;
             _3MF_Importer& importer;
             const mz_zip_archive_file_stat& stat;
-
-            CallbackData(XML_Parser& parser, _3MF_Importer& importer, const mz_zip_archive_file_stat& stat) : parser(parser), importer(importer), stat(stat) {}
+            // The meshes are not parsed by expat, they are collected while the archive is inflated
+            // and decoded in parallel once the whole file is read.
+            ModelMeshDataSplitter splitter;
+
+            CallbackData(XML_Parser& parser, _3MF_Importer& importer, const mz_zip_archive_file_stat& stat) : parser(parser), importer(importer), stat(stat),
+                splitter([this](const char* data, size_t len, bool is_final) {
+                        return XML_Parse(this->parser, data, (int)len, is_final ? 1 : 0) && !this->importer.parse_error();
+                    },
+                    [this](ModelMeshDataSplitter::ESection section, std::string&& data) {
+                        Geometry& geometry = this->importer.m_curr_object.geometry;
+                        (section == ModelMeshDataSplitter::ESection::Vertices ? geometry.vertices_data : geometry.triangles_data) = std::move(data);
+                    }) {}
         };
 
         CallbackData data(m_xml_parser, *this, stat);
@@ -1166,7 +1459,7 @@ namespace Slic3r {
         {
             res = mz_zip_reader_extract_to_callback(&archive, stat.m_file_index, [](void* pOpaque, mz_uint64 file_ofs, const void* pBuf, size_t n)->size_t {
                 CallbackData* data = (CallbackData*)pOpaque;
-                if (!XML_Parse(data->parser, (const char*)pBuf, (int)n, (file_ofs + n == data->stat.m_uncomp_size) ? 1 : 0) || data->importer.parse_error()) {
+                if (!data->splitter.process((const char*)pBuf, n) || (file_ofs + n == data->stat.m_uncomp_size && !data->splitter.finalize())) {
                     char error_buf[1024];
                     ::sprintf(error_buf, "Error (%s) while parsing '%s' at line %d", data->importer.parse_error_message(), data->stat.m_filename, (int)XML_GetCurrentLineNumber(data->parser));
                     throw Slic3r::FileIOError(error_buf);
@@ -1196,6 +1489,9 @@ namespace Slic3r {
             return false;
         }
 
+        if (!_decode_meshes())
+            return false;
+
         return true;
     }
 
@@ -1978,12 +2274,7 @@ namespace Slic3r {
 
     bool _3MF_Importer::_handle_start_vertex(const char** attributes, unsigned int num_attributes)
     {
-        // appends the vertex coordinates
-        // missing values are set equal to ZERO
-        m_curr_object.geometry.vertices.emplace_back(
-            m_unit_factor * get_attribute_value_float(attributes, num_attributes, X_ATTR),
-            m_unit_factor * get_attribute_value_float(attributes, num_attributes, Y_ATTR),
-            m_unit_factor * get_attribute_value_float(attributes, num_attributes, Z_ATTR));
+        _add_vertex(m_curr_object.geometry, attributes, num_attributes, m_unit_factor);
         return true;
     }
 
@@ -2007,6 +2298,28 @@ namespace Slic3r {
     }
 
     bool _3MF_Importer::_handle_start_triangle(const char** attributes, unsigned int num_attributes)
+    {
+        _add_triangle(m_curr_object.geometry, attributes, num_attributes);
+        return true;
+    }
+
+    bool _3MF_Importer::_handle_end_triangle()
+    {
+        // do nothing
+        return true;
+    }
+
+    void _3MF_Importer::_add_vertex(Geometry& geometry, const char** attributes, unsigned int num_attributes, float unit_factor)
+    {
+        // appends the vertex coordinates
+        // missing values are set equal to ZERO
+        geometry.vertices.emplace_back(
+            unit_factor * get_attribute_value_float(attributes, num_attributes, X_ATTR),
+            unit_factor * get_attribute_value_float(attributes, num_attributes, Y_ATTR),
+            unit_factor * get_attribute_value_float(attributes, num_attributes, Z_ATTR));
+    }
+
+    void _3MF_Importer::_add_triangle(Geometry& geometry, const char** attributes, unsigned int num_attributes)
     {
         // we are ignoring the following attributes:
         // p1
@@ -2017,23 +2330,141 @@ namespace Slic3r {
 
         // appends the triangle's vertices indices
         // missing values are set equal to ZERO
-        m_curr_object.geometry.triangles.emplace_back(
+        geometry.triangles.emplace_back(
             get_attribute_value_int(attributes, num_attributes, V1_ATTR),
             get_attribute_value_int(attributes, num_attributes, V2_ATTR),
             get_attribute_value_int(attributes, num_attributes, V3_ATTR));
 
-        m_curr_object.geometry.custom_supports.push_back(get_attribute_value_string(attributes, num_attributes, CUSTOM_SUPPORTS_ATTR));
-        m_curr_object.geometry.custom_seam.push_back(get_attribute_value_string(attributes, num_attributes, CUSTOM_SEAM_ATTR));
-        m_curr_object.geometry.mm_segmentation.push_back(get_attribute_value_string(attributes, num_attributes, MM_SEGMENTATION_ATTR));
-        return true;
+        geometry.custom_supports.push_back(get_attribute_value_string(attributes, num_attributes, CUSTOM_SUPPORTS_ATTR));
+        geometry.custom_seam.push_back(get_attribute_value_string(attributes, num_attributes, CUSTOM_SEAM_ATTR));
+        geometry.mm_segmentation.push_back(get_attribute_value_string(attributes, num_attributes, MM_SEGMENTATION_ATTR));
     }
 
-    bool _3MF_Importer::_handle_end_triangle()
+    bool _3MF_Importer::_decode_meshes()
     {
-        // do nothing
+        std::vector<std::pair<int, Geometry*>> geometries;
+        for (IdToGeometryMap::value_type& geometry : m_geometries) {
+            if (!geometry.second.vertices_data.empty() || !geometry.second.triangles_data.empty())
+                geometries.emplace_back(geometry.first, &geometry.second);
+        }
+
+        // the vertices and the triangles of each object are decoded independently
+        // one flag per task, so that the vertices and the triangles of an object do not write the same flag
+        std::vector<char> invalid(2 * geometries.size(), 0);
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, 2 * geometries.size(), 1), [this, &geometries, &invalid](const tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i < range.end(); ++i) {
+                Geometry& geometry = *geometries[i / 2].second;
+                if (i % 2 == 0) {
+                    if (!geometry.vertices_data.empty() && !_decode_vertices(geometry, m_unit_factor)) {
+                        geometry.vertices.clear();
+                        if (!_parse_mesh_data_xml(geometry, ModelMeshDataSplitter::ESection::Vertices, m_unit_factor))
+                            invalid[i] = 1;
+                    }
+                    std::string().swap(geometry.vertices_data);
+                }
+                else {
+                    if (!geometry.triangles_data.empty() && !_decode_triangles(geometry)) {
+                        geometry.triangles.clear();
+                        geometry.custom_supports.clear();
+                        geometry.custom_seam.clear();
+                        geometry.mm_segmentation.clear();
+                        if (!_parse_mesh_data_xml(geometry, ModelMeshDataSplitter::ESection::Triangles, m_unit_factor))
+                            invalid[i] = 1;
+                    }
+                    std::string().swap(geometry.triangles_data);
+                }
+            }
+        });
+
+        for (size_t i = 0; i < geometries.size(); ++i) {
+            if (invalid[2 * i] || invalid[2 * i + 1] || geometries[i].second->empty()) {
+                add_error("Found invalid mesh data of object " + std::to_string(geometries[i].first));
+                return false;
+            }
+        }
+
         return true;
     }
 
+    bool _3MF_Importer::_decode_vertices(Geometry& geometry, float unit_factor)
+    {
+        // missing values are set equal to ZERO
+        Vec3f vertex = Vec3f::Zero();
+        return tokenize_mesh_elements(geometry.vertices_data, VERTEX_TAG,
+            [&vertex](std::string_view name, std::string_view value) {
+                if (name.size() == 1 && name[0] >= 'x' && name[0] <= 'z')
+                    fast_float::from_chars(value.data(), value.data() + value.size(), vertex[name[0] - 'x']);
+            },
+            [&geometry, &vertex, unit_factor]() {
+                geometry.vertices.emplace_back(unit_factor * vertex);
+                vertex = Vec3f::Zero();
+            });
+    }
+
+    bool _3MF_Importer::_decode_triangles(Geometry& geometry)
+    {
+        // missing values are set equal to ZERO
+        Vec3i32 triangle = Vec3i32::Zero();
+        std::string_view custom_supports;
+        std::string_view custom_seam;
+        std::string_view mm_segmentation;
+        return tokenize_mesh_elements(geometry.triangles_data, TRIANGLE_TAG,
+            [&](std::string_view name, std::string_view value) {
+                if (name.size() == 2 && name[0] == 'v' && name[1] >= '1' && name[1] <= '3')
+                    triangle[name[1] - '1'] = parse_int(value);
+                else if (name == CUSTOM_SUPPORTS_ATTR)
+                    custom_supports = value;
+                else if (name == CUSTOM_SEAM_ATTR)
+                    custom_seam = value;
+                else if (name == MM_SEGMENTATION_ATTR)
+                    mm_segmentation = value;
+            },
+            [&]() {
+                geometry.triangles.emplace_back(triangle);
+                geometry.custom_supports.emplace_back(custom_supports);
+                geometry.custom_seam.emplace_back(custom_seam);
+                geometry.mm_segmentation.emplace_back(mm_segmentation);
+                triangle = Vec3i32::Zero();
+                custom_supports = custom_seam = mm_segmentation = std::string_view();
+            });
+    }
+
+    bool _3MF_Importer::_parse_mesh_data_xml(Geometry& geometry, ModelMeshDataSplitter::ESection section, float unit_factor)
+    {
+        struct ParserData
+        {
+            XML_Parser parser;
+            Geometry& geometry;
+            float unit_factor;
+        };
+
+        XML_Parser parser = XML_ParserCreate(nullptr);
+        if (parser == nullptr)
+            return false;
+
+        ParserData data{ parser, geometry, unit_factor };
+        XML_SetUserData(parser, (void*)&data);
+        XML_SetStartElementHandler(parser, [](void* userData, const char* name, const char** attributes) {
+            ParserData* data = (ParserData*)userData;
+            unsigned int num_attributes = (unsigned int)XML_GetSpecifiedAttributeCount(data->parser);
+            if (::strcmp(VERTEX_TAG, name) == 0)
+                _add_vertex(data->geometry, attributes, num_attributes, data->unit_factor);
+            else if (::strcmp(TRIANGLE_TAG, name) == 0)
+                _add_triangle(data->geometry, attributes, num_attributes);
+        });
+
+        const bool vertices = section == ModelMeshDataSplitter::ESection::Vertices;
+        const std::string start_tag = vertices ? "<vertices>" : "<triangles>";
+        const std::string end_tag = vertices ? "</vertices>" : "</triangles>";
+        const std::string& content = vertices ? geometry.vertices_data : geometry.triangles_data;
+        const bool res = XML_Parse(parser, start_tag.data(), (int)start_tag.size(), 0) &&
+                         XML_Parse(parser, content.data(), (int)content.size(), 0) &&
+                         XML_Parse(parser, end_tag.data(), (int)end_tag.size(), 1);
+        XML_ParserFree(parser);
+
+        return res;
+    }
+
     bool _3MF_Importer::_handle_start_components(const char** attributes, unsigned int num_attributes)
     {
         // reset current components
@@ -2677,6 +3108,34 @@ namespace Slic3r {
         typedef std::vector<BuildItem> BuildItemsList;
         typedef std::map<int, ObjectData> IdToObjectDataMap;
 
+        // Piece of the model file: a text followed by the output of serialize(), if any.
+        struct ModelFileChunk
+        {
+            std::string text;
+            std::function<void(std::string&)> serialize;
+            // Expected size of the output of serialize().
+            size_t serialized_size{ 0 };
+        };
+
+        // The model file is assembled as a list of chunks, which are serialized and deflated in parallel
+        // by _add_model_file_chunks_to_archive().
+        struct ModelFileChunks : std::vector<ModelFileChunk>
+        {
+            // Text to be appended to the model file.
+            std::string& text() {
+                if (empty() || back().serialize)
+                    emplace_back();
+                return back().text;
+            }
+            // Data to be serialized into the model file.
+            void add(std::function<void(std::string&)> serialize, size_t serialized_size) {
+                if (empty() || back().serialize)
+                    emplace_back();
+                back().serialize = std::move(serialize);
+                back().serialized_size = serialized_size;
+            }
+        };
+
         OptionStore3mf m_options{};
 
     public:
@@ -2689,8 +3148,9 @@ namespace Slic3r {
         bool _add_thumbnail_file_to_archive(mz_zip_archive& archive, const ThumbnailData& thumbnail_data);
         bool _add_relationships_file_to_archive(mz_zip_archive& archive);
         bool _add_model_file_to_archive(const std::string& filename, mz_zip_archive& archive, const Model& model, IdToObjectDataMap& objects_data);
-        bool _add_object_to_model_stream(mz_zip_writer_staged_context &context, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets);
-        bool _add_mesh_to_object_stream(mz_zip_writer_staged_context &context, ModelObject& object, VolumeToOffsetsMap& volumes_offsets);        
+        bool _add_model_file_chunks_to_archive(mz_zip_writer_staged_context &context, const ModelFileChunks& chunks);
+        bool _add_object_to_model_stream(ModelFileChunks& chunks, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets);
+        bool _add_mesh_to_object_stream(ModelFileChunks& chunks, ModelObject& object, VolumeToOffsetsMap& volumes_offsets);
         bool _add_build_to_model_stream(std::stringstream& stream, const BuildItemsList& build_items);
         bool _add_cut_information_file_to_archive(mz_zip_archive& archive, Model& model);
         bool _add_layer_height_profile_file_to_archive(mz_zip_archive& archive, Model& model);
@@ -2706,6 +3166,7 @@ namespace Slic3r {
     {
         clear_errors();
         m_options = options;
+        m_options.compression_level = std::clamp(m_options.compression_level, 1, int(MZ_UBER_COMPRESSION));
         return _save_model_to_file(filename, model, config);
     }
 
@@ -2868,7 +3329,7 @@ namespace Slic3r {
 
         std::string out = stream.str();
 
-        if (!mz_zip_writer_add_mem(&archive, CONTENT_TYPES_FILE.c_str(), (const void*)out.data(), out.length(), MZ_DEFAULT_COMPRESSION)) {
+        if (!mz_zip_writer_add_mem(&archive, CONTENT_TYPES_FILE.c_str(), (const void*)out.data(), out.length(), mz_uint(m_options.compression_level))) {
             add_error("Unable to add content types file to archive");
             return false;
         }
@@ -2883,7 +3344,7 @@ namespace Slic3r {
         size_t png_size = 0;
         void* png_data = tdefl_write_image_to_png_file_in_memory_ex((const void*)thumbnail_data.pixels.data(), thumbnail_data.width, thumbnail_data.height, 4, &png_size, MZ_DEFAULT_LEVEL, 1);
         if (png_data != nullptr) {
-            res = mz_zip_writer_add_mem(&archive, THUMBNAIL_FILE.c_str(), (const void*)png_data, png_size, MZ_DEFAULT_COMPRESSION);
+            res = mz_zip_writer_add_mem(&archive, THUMBNAIL_FILE.c_str(), (const void*)png_data, png_size, mz_uint(m_options.compression_level));
             mz_free(png_data);
         }
 
@@ -2904,7 +3365,7 @@ namespace Slic3r {
 
         std::string out = stream.str();
 
-        if (!mz_zip_writer_add_mem(&archive, RELATIONSHIPS_FILE.c_str(), (const void*)out.data(), out.length(), MZ_DEFAULT_COMPRESSION)) {
+        if (!mz_zip_writer_add_mem(&archive, RELATIONSHIPS_FILE.c_str(), (const void*)out.data(), out.length(), mz_uint(m_options.compression_level))) {
             add_error("Unable to add relationships file to archive");
             return false;
         }
@@ -2934,11 +3395,12 @@ namespace Slic3r {
                 // Maximum expected 3MF file size is 4GB-1. This is a workaround for interoperability with Windows 10 3D model fixing API, see
                 // GH issue #6193.
                 (uint64_t(1) << 32) - 1,
-            nullptr, nullptr, 0, MZ_DEFAULT_COMPRESSION, nullptr, 0, nullptr, 0)) {
+            nullptr, nullptr, 0, mz_uint(m_options.compression_level), nullptr, 0, nullptr, 0)) {
             add_error("Unable to add model file to archive");
             return false;
         }
 
+        ModelFileChunks chunks;
         {
             std::stringstream stream;
             reset_stream(stream);
@@ -2971,11 +3433,7 @@ namespace Slic3r {
             stream << " <" << METADATA_TAG << " name=\"ApplicationName\">" << SLIC3R_APP_KEY << "</" << METADATA_TAG << ">\n";
             stream << " <" << METADATA_TAG << " name=\"ApplicationVersion\">" << SLIC3R_VERSION_FULL << "</" << METADATA_TAG << ">\n";
             stream << " <" << RESOURCES_TAG << ">\n";
-            std::string buf = stream.str();
-            if (! buf.empty() && ! mz_zip_writer_add_staged_data(&context, buf.data(), buf.size())) {
-                add_error("Unable to add model file to archive");
-                return false;
-            }
+            chunks.text() += stream.str();
         }
 
         // Instance transformations, indexed by the 3MF object ID (which is a linear serialization of all instances of all ModelObjects).
@@ -2995,7 +3453,7 @@ namespace Slic3r {
             // Store geometry of all ModelVolumes contained in a single ModelObject into a single 3MF indexed triangle set object.
             // object_it->second.volumes_offsets will contain the offsets of the ModelVolumes in that single indexed triangle set.
             // object_id will be increased to point to the 1st instance of the next ModelObject.
-            if (!_add_object_to_model_stream(context, object_id, *obj, build_items, object_it->second.volumes_offsets)) {
+            if (!_add_object_to_model_stream(chunks, object_id, *obj, build_items, object_it->second.volumes_offsets)) {
                 add_error("Unable to add object to archive");
                 mz_zip_writer_add_staged_finish(&context);
                 return false;
@@ -3015,20 +3473,97 @@ namespace Slic3r {
             }
 
             stream << "</" << MODEL_TAG << ">\n";
-           
-            std::string buf = stream.str();
+            chunks.text() += stream.str();
+        }
 
-            if ((! buf.empty() && ! mz_zip_writer_add_staged_data(&context, buf.data(), buf.size())) ||
-                ! mz_zip_writer_add_staged_finish(&context)) {
-                add_error("Unable to add model file to archive");
-                return false;
+        if (! _add_model_file_chunks_to_archive(context, chunks) ||
+            ! mz_zip_writer_add_staged_finish(&context)) {
+            add_error("Unable to add model file to archive");
+            return false;
+        }
+
+        return true;
+    }
+
+    // Deflates a block of the model file into a raw deflate stream ending at a byte boundary,
+    // to be stitched with the other blocks by mz_zip_writer_add_staged_compressed_data().
+    static bool deflate_model_file_block(const std::string& data, int level, std::string& out)
+    {
+        tdefl_compressor* compressor = tdefl_compressor_alloc();
+        if (compressor == nullptr)
+            return false;
+
+        auto put_buf = [](const void* buf, int len, void* user) -> mz_bool {
+            static_cast<std::string*>(user)->append(static_cast<const char*>(buf), len);
+            return MZ_TRUE;
+        };
+        const bool res = tdefl_init(compressor, put_buf, &out, tdefl_create_comp_flags_from_zip_params(level, -15, MZ_DEFAULT_STRATEGY)) == TDEFL_STATUS_OKAY &&
+                         tdefl_compress_buffer(compressor, data.data(), data.size(), TDEFL_FULL_FLUSH) == TDEFL_STATUS_OKAY;
+        tdefl_compressor_free(compressor);
+        return res;
+    }
+
+    bool _3MF_Exporter::_add_model_file_chunks_to_archive(mz_zip_writer_staged_context &context, const ModelFileChunks& chunks)
+    {
+        // Consecutive chunks are grouped into blocks of roughly BLOCK_SIZE bytes, which are serialized
+        // and deflated independently of each other.
+        static constexpr const size_t BLOCK_SIZE = 4 * 1024 * 1024;
+        std::vector<std::pair<size_t, size_t>> blocks;
+        size_t block_size = 0;
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            if (blocks.empty() || block_size >= BLOCK_SIZE) {
+                blocks.emplace_back(i, i);
+                block_size = 0;
+            }
+            blocks.back().second = i + 1;
+            block_size += chunks[i].text.size() + chunks[i].serialized_size;
+        }
+
+        struct DeflatedBlock
+        {
+            std::string data;
+            size_t      size{ 0 };
+            mz_uint32   crc32{ 0 };
+            bool        valid{ false };
+        };
+
+        // The blocks are processed in batches to limit the memory occupied by the deflated data.
+        const size_t batch_size = 2 * size_t(tbb::this_task_arena::max_concurrency());
+        for (size_t batch_begin = 0; batch_begin < blocks.size(); batch_begin += batch_size) {
+            std::vector<DeflatedBlock> deflated(std::min(batch_size, blocks.size() - batch_begin));
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, deflated.size(), 1), [this, &chunks, &blocks, &deflated, batch_begin](const tbb::blocked_range<size_t>& range) {
+                std::string text;
+                for (size_t i = range.begin(); i < range.end(); ++i) {
+                    text.clear();
+                    for (size_t chunk_id = blocks[batch_begin + i].first; chunk_id < blocks[batch_begin + i].second; ++chunk_id) {
+                        text += chunks[chunk_id].text;
+                        if (chunks[chunk_id].serialize)
+                            chunks[chunk_id].serialize(text);
+                    }
+                    DeflatedBlock& block = deflated[i];
+                    block.size  = text.size();
+                    block.crc32 = (mz_uint32)mz_crc32(MZ_CRC32_INIT, (const unsigned char*)text.data(), text.size());
+                    block.valid = deflate_model_file_block(text, m_options.compression_level, block.data);
+                }
+            });
+
+            for (const DeflatedBlock& block : deflated) {
+                if (! block.valid) {
+                    add_error("Error during compression");
+                    mz_zip_writer_add_staged_finish(&context);
+                    return false;
+                }
+                if (! mz_zip_writer_add_staged_compressed_data(&context, block.data.data(), block.data.size(), block.size, block.crc32)) {
+                    add_error("Error during writing or compression");
+                    return false;
+                }
             }
         }
 
         return true;
     }
 
-    bool _3MF_Exporter::_add_object_to_model_stream(mz_zip_writer_staged_context &context, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets)
+    bool _3MF_Exporter::_add_object_to_model_stream(ModelFileChunks& chunks, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets)
     {
         std::stringstream stream;
         reset_stream(stream);
@@ -3042,10 +3577,9 @@ namespace Slic3r {
             stream << "  <" << OBJECT_TAG << " id=\"" << instance_id << "\" type=\"model\">\n";
 
             if (id == 0) {
-                std::string buf = stream.str();
+                chunks.text() += stream.str();
                 reset_stream(stream);
-                if ((! buf.empty() && ! mz_zip_writer_add_staged_data(&context, buf.data(), buf.size())) ||
-                    ! _add_mesh_to_object_stream(context, object, volumes_offsets)) {
+                if (! _add_mesh_to_object_stream(chunks, object, volumes_offsets)) {
                     add_error("Unable to add mesh to archive");
                     return false;
                 }
@@ -3067,8 +3601,8 @@ namespace Slic3r {
         }
 
         object_id += id;
-        std::string buf = stream.str();
-        return buf.empty() || mz_zip_writer_add_staged_data(&context, buf.data(), buf.size());
+        chunks.text() += stream.str();
+        return true;
     }
 
 #if EXPORT_3MF_USE_SPIRIT_KARMA_FP
@@ -3091,57 +3625,135 @@ namespace Slic3r {
     using coordinate_type_scientific = boost::spirit::karma::real_generator<float, coordinate_policy_scientific<float>>;
 #endif // EXPORT_3MF_USE_SPIRIT_KARMA_FP
 
-    bool _3MF_Exporter::_add_mesh_to_object_stream(mz_zip_writer_staged_context &context, ModelObject& object, VolumeToOffsetsMap& volumes_offsets)
+    static char* format_coordinate(float f, char *buf)
     {
-        std::string output_buffer;
-        output_buffer += "   <";
-        output_buffer += MESH_TAG;
-        output_buffer += ">\n    <";
-        output_buffer += VERTICES_TAG;
-        output_buffer += ">\n";
-
-        auto flush = [this, &output_buffer, &context](bool force = false) {
-            if ((force && ! output_buffer.empty()) || output_buffer.size() >= 65536 * 16) {
-                if (! mz_zip_writer_add_staged_data(&context, output_buffer.data(), output_buffer.size())) {
-                    add_error("Error during writing or compression");
-                    return false;
-                }
-                output_buffer.clear();
-            }
-            return true;
-        };
-
-        auto format_coordinate = [](float f, char *buf) -> char* {
-            assert(is_decimal_separator_point());
+        assert(is_decimal_separator_point());
 #if EXPORT_3MF_USE_SPIRIT_KARMA_FP
-            // Slightly faster than sprintf("%.9g"), but there is an issue with the karma floating point formatter,
-            // https://github.com/boostorg/spirit/pull/586
-            // where the exported string is one digit shorter than it should be to guarantee lossless round trip.
-            // The code is left here for the ocasion boost guys improve.
-            coordinate_type_fixed      const coordinate_fixed      = coordinate_type_fixed();
-            coordinate_type_scientific const coordinate_scientific = coordinate_type_scientific();
-            // Format "f" in a fixed format.
-            char *ptr = buf;
-            boost::spirit::karma::generate(ptr, coordinate_fixed, f);
-            // Format "f" in a scientific format.
-            char *ptr2 = ptr;
-            boost::spirit::karma::generate(ptr2, coordinate_scientific, f);
-            // Return end of the shorter string.
-            auto len2 = ptr2 - ptr;
-            if (ptr - buf > len2) {
-                // Move the shorter scientific form to the front.
-                memcpy(buf, ptr, len2);
-                ptr = buf + len2;
-            }
-            // Return pointer to the end.
-            return ptr;
+        // Slightly faster than sprintf("%.9g"), but there is an issue with the karma floating point formatter,
+        // https://github.com/boostorg/spirit/pull/586
+        // where the exported string is one digit shorter than it should be to guarantee lossless round trip.
+        // The code is left here for the ocasion boost guys improve.
+        coordinate_type_fixed      const coordinate_fixed      = coordinate_type_fixed();
+        coordinate_type_scientific const coordinate_scientific = coordinate_type_scientific();
+        // Format "f" in a fixed format.
+        char *ptr = buf;
+        boost::spirit::karma::generate(ptr, coordinate_fixed, f);
+        // Format "f" in a scientific format.
+        char *ptr2 = ptr;
+        boost::spirit::karma::generate(ptr2, coordinate_scientific, f);
+        // Return end of the shorter string.
+        auto len2 = ptr2 - ptr;
+        if (ptr - buf > len2) {
+            // Move the shorter scientific form to the front.
+            memcpy(buf, ptr, len2);
+            ptr = buf + len2;
+        }
+        // Return pointer to the end.
+        return ptr;
+#elif defined(__APPLE__)
+        // Older stdlib on macOS doesn't support std::to_chars for floating point numbers.
+        // Round-trippable float, shortest possible.
+        return buf + sprintf(buf, "%.9g", f);
 #else
-            // Round-trippable float, shortest possible.
-            return buf + sprintf(buf, "%.9g", f);
+        // Shortest round-trippable float, independent of the locale.
+        return std::to_chars(buf, buf + 32, f).ptr;
 #endif
-        };
+    }
+
+    static char* format_vertex_index(int i, char *buf)
+    {
+#ifdef __APPLE__
+        boost::spirit::karma::generate(buf, boost::spirit::int_, i);
+        return buf;
+#else
+        return std::to_chars(buf, buf + 16, i).ptr;
+#endif
+    }
+
+    // Expected length of the xml elements of a vertex and of a triangle, used to split the model file into blocks of similar size.
+    static constexpr const size_t VERTEX_XML_SIZE   = 60;
+    static constexpr const size_t TRIANGLE_XML_SIZE = 50;
+
+    static void add_vertices_to_object_stream(std::string& out, const ModelVolume& volume, size_t begin, size_t end)
+    {
+        const std::string vertex_begin = std::string("     <") + VERTEX_TAG + " x=\"";
+        const Transform3d& matrix = volume.get_matrix();
+        const indexed_triangle_set &its = volume.mesh().its;
+        char buf[128];
+        for (size_t i = begin; i < end; ++ i) {
+            Vec3f v = (matrix * its.vertices[i].cast<double>()).cast<float>();
+            out += vertex_begin;
+            out.append(buf, format_coordinate(v.x(), buf));
+            out += "\" y=\"";
+            out.append(buf, format_coordinate(v.y(), buf));
+            out += "\" z=\"";
+            out.append(buf, format_coordinate(v.z(), buf));
+            out += "\"/>\n";
+        }
+    }
+
+    static void add_triangles_to_object_stream(std::string& out, const ModelVolume& volume, int first_vertex_id, size_t begin, size_t end)
+    {
+        const std::string triangle_begin = std::string("     <") + TRIANGLE_TAG + " v1=\"";
+        const bool is_left_handed = volume.is_left_handed();
+        const indexed_triangle_set &its = volume.mesh().its;
+        char buf[32];
+        for (int i = int(begin); i < int(end); ++ i) {
+            const Vec3i32 &idx = its.indices[i];
+            out += triangle_begin;
+            out.append(buf, format_vertex_index(idx[is_left_handed ? 2 : 0] + first_vertex_id, buf));
+            out += "\" v2=\"";
+            out.append(buf, format_vertex_index(idx[1] + first_vertex_id, buf));
+            out += "\" v3=\"";
+            out.append(buf, format_vertex_index(idx[is_left_handed ? 0 : 2] + first_vertex_id, buf));
+            out += "\"";
+
+            std::string custom_supports_data_string = volume.supported_facets.get_triangle_as_string(i);
+            if (! custom_supports_data_string.empty()) {
+                out += " ";
+                out += CUSTOM_SUPPORTS_ATTR;
+                out += "=\"";
+                out += custom_supports_data_string;
+                out += "\"";
+            }
+
+            std::string custom_seam_data_string = volume.seam_facets.get_triangle_as_string(i);
+            if (! custom_seam_data_string.empty()) {
+                out += " ";
+                out += CUSTOM_SEAM_ATTR;
+                out += "=\"";
+                out += custom_seam_data_string;
+                out += "\"";
+            }
+
+            std::string mm_painting_data_string = volume.mm_segmentation_facets.get_triangle_as_string(i);
+            if (! mm_painting_data_string.empty()) {
+                out += " ";
+                out += MM_SEGMENTATION_ATTR;
+                out += "=\"";
+                out += mm_painting_data_string;
+                out += "\"";
+            }
+
+            out += "/>\n";
+        }
+    }
+
+    bool _3MF_Exporter::_add_mesh_to_object_stream(ModelFileChunks& chunks, ModelObject& object, VolumeToOffsetsMap& volumes_offsets)
+    {
+        // The vertices and the triangles of the volumes are serialized in ranges of RANGE_SIZE elements,
+        // thus large meshes are serialized and deflated in parallel as well.
+        static constexpr const size_t RANGE_SIZE = 65536;
+
+        {
+            std::string& text = chunks.text();
+            text += "   <";
+            text += MESH_TAG;
+            text += ">\n    <";
+            text += VERTICES_TAG;
+            text += ">\n";
+        }
 
-        char buf[256];
         unsigned int vertices_count = 0;
         for (ModelVolume* volume : object.volumes) {
             if (volume == nullptr)
@@ -3157,36 +3769,26 @@ namespace Slic3r {
 
             vertices_count += (int)its.vertices.size();
 
-            const Transform3d& matrix = volume->get_matrix();
-            for (const auto& vertex: its.vertices) {
-                Vec3f v = (matrix * vertex.cast<double>()).cast<float>();
-                char *ptr = buf;
-                boost::spirit::karma::generate(ptr, boost::spirit::lit("     <") << VERTEX_TAG << " x=\"");
-                ptr = format_coordinate(v.x(), ptr);
-                boost::spirit::karma::generate(ptr, "\" y=\"");
-                ptr = format_coordinate(v.y(), ptr);
-                boost::spirit::karma::generate(ptr, "\" z=\"");
-                ptr = format_coordinate(v.z(), ptr);
-                boost::spirit::karma::generate(ptr, "\"/>\n");
-                *ptr = '\0';
-                output_buffer += buf;
-                if (! flush())
-                    return false;
+            for (size_t begin = 0; begin < its.vertices.size(); begin += RANGE_SIZE) {
+                const size_t end = std::min(begin + RANGE_SIZE, its.vertices.size());
+                chunks.add([volume, begin, end](std::string& out) { add_vertices_to_object_stream(out, *volume, begin, end); }, (end - begin) * VERTEX_XML_SIZE);
             }
         }
 
-        output_buffer += "    </";
-        output_buffer += VERTICES_TAG;
-        output_buffer += ">\n    <";
-        output_buffer += TRIANGLES_TAG;
-        output_buffer += ">\n";
+        {
+            std::string& text = chunks.text();
+            text += "    </";
+            text += VERTICES_TAG;
+            text += ">\n    <";
+            text += TRIANGLES_TAG;
+            text += ">\n";
+        }
 
         unsigned int triangles_count = 0;
         for (ModelVolume* volume : object.volumes) {
             if (volume == nullptr)
                 continue;
 
-            bool is_left_handed = volume->is_left_handed();
             VolumeToOffsetsMap::iterator volume_it = volumes_offsets.find(volume);
             assert(volume_it != volumes_offsets.end());
 
@@ -3197,63 +3799,23 @@ namespace Slic3r {
             triangles_count += (int)its.indices.size();
             volume_it->second.last_triangle_id = triangles_count - 1;
 
-            for (int i = 0; i < int(its.indices.size()); ++ i) {
-                {
-                    const Vec3i32&idx = its.indices[i];
-                    char *ptr = buf;
-                    boost::spirit::karma::generate(ptr, boost::spirit::lit("     <") << TRIANGLE_TAG <<
-                        " v1=\"" << boost::spirit::int_ <<
-                        "\" v2=\"" << boost::spirit::int_ <<
-                        "\" v3=\"" << boost::spirit::int_ << "\"",
-                        idx[is_left_handed ? 2 : 0] + volume_it->second.first_vertex_id,
-                        idx[1] + volume_it->second.first_vertex_id,
-                        idx[is_left_handed ? 0 : 2] + volume_it->second.first_vertex_id);
-                    *ptr = '\0';
-                    output_buffer += buf;
-                }
-
-                std::string custom_supports_data_string = volume->supported_facets.get_triangle_as_string(i);
-                if (! custom_supports_data_string.empty()) {
-                    output_buffer += " ";
-                    output_buffer += CUSTOM_SUPPORTS_ATTR;
-                    output_buffer += "=\"";
-                    output_buffer += custom_supports_data_string;
-                    output_buffer += "\"";
-                }
-
-                std::string custom_seam_data_string = volume->seam_facets.get_triangle_as_string(i);
-                if (! custom_seam_data_string.empty()) {
-                    output_buffer += " ";
-                    output_buffer += CUSTOM_SEAM_ATTR;
-                    output_buffer += "=\"";
-                    output_buffer += custom_seam_data_string;
-                    output_buffer += "\"";
-                }
-
-                std::string mm_painting_data_string = volume->mm_segmentation_facets.get_triangle_as_string(i);
-                if (! mm_painting_data_string.empty()) {
-                    output_buffer += " ";
-                    output_buffer += MM_SEGMENTATION_ATTR;
-                    output_buffer += "=\"";
-                    output_buffer += mm_painting_data_string;
-                    output_buffer += "\"";
-                }
-
-                output_buffer += "/>\n";
-
-                if (! flush())
-                    return false;
+            const int first_vertex_id = int(volume_it->second.first_vertex_id);
+            for (size_t begin = 0; begin < its.indices.size(); begin += RANGE_SIZE) {
+                const size_t end = std::min(begin + RANGE_SIZE, its.indices.size());
+                chunks.add([volume, first_vertex_id, begin, end](std::string& out) { add_triangles_to_object_stream(out, *volume, first_vertex_id, begin, end); }, (end - begin) * TRIANGLE_XML_SIZE);
             }
         }
 
-        output_buffer += "    </";
-        output_buffer += TRIANGLES_TAG;
-        output_buffer += ">\n   </";
-        output_buffer += MESH_TAG;
-        output_buffer += ">\n";
+        {
+            std::string& text = chunks.text();
+            text += "    </";
+            text += TRIANGLES_TAG;
+            text += ">\n   </";
+            text += MESH_TAG;
+            text += ">\n";
+        }
 
-        // Force flush.
-        return flush(true);
+        return true;
     }
 
     void _3MF_Exporter::add_transformation(std::stringstream &stream, const Transform3d &tr)
@@ -3341,7 +3903,7 @@ namespace Slic3r {
         }
 
         if (!out.empty()) {
-            if (!mz_zip_writer_add_mem(&archive, CUT_INFORMATION_FILE.c_str(), (const void*)out.data(), out.length(), MZ_DEFAULT_COMPRESSION)) {
+            if (!mz_zip_writer_add_mem(&archive, CUT_INFORMATION_FILE.c_str(), (const void*)out.data(), out.length(), mz_uint(m_options.compression_level))) {
                 add_error("Unable to add cut information file to archive");
                 return false;
             }
@@ -3375,7 +3937,7 @@ namespace Slic3r {
         }
 
         if (!out.empty()) {
-            if (!mz_zip_writer_add_mem(&archive, LAYER_HEIGHTS_PROFILE_FILE.c_str(), (const void*)out.data(), out.length(), MZ_DEFAULT_COMPRESSION)) {
+            if (!mz_zip_writer_add_mem(&archive, LAYER_HEIGHTS_PROFILE_FILE.c_str(), (const void*)out.data(), out.length(), mz_uint(m_options.compression_level))) {
                 add_error("Unable to add layer heights profile file to archive");
                 return false;
             }
@@ -3486,16 +4048,16 @@ namespace Slic3r {
         }
 
         if (!default_out.empty()) {
-            if (!mz_zip_writer_add_mem(&archive, SLIC3R_LAYER_CONFIG_RANGES_FILE.c_str(), (const void*)default_out.data(), default_out.length(), MZ_DEFAULT_COMPRESSION))
+            if (!mz_zip_writer_add_mem(&archive, SLIC3R_LAYER_CONFIG_RANGES_FILE.c_str(), (const void*)default_out.data(), default_out.length(), mz_uint(m_options.compression_level)))
             {
                 add_error("Unable to add layer heights profile file to archive");
                 return false;
             }
-            if (!mz_zip_writer_add_mem(&archive, SUPER_LAYER_CONFIG_RANGES_FILE.c_str(), (const void*)default_out.data(), default_out.length(), MZ_DEFAULT_COMPRESSION)) {
+            if (!mz_zip_writer_add_mem(&archive, SUPER_LAYER_CONFIG_RANGES_FILE.c_str(), (const void*)default_out.data(), default_out.length(), mz_uint(m_options.compression_level))) {
                 add_error("Unable to add layer heights profile file to archive");
                 return false;
             }
-            if (!prusa_out.empty() && !mz_zip_writer_add_mem(&archive, PRUSA_LAYER_CONFIG_RANGES_FILE.c_str(), (const void*)prusa_out.data(), prusa_out.length(), MZ_DEFAULT_COMPRESSION)) {
+            if (!prusa_out.empty() && !mz_zip_writer_add_mem(&archive, PRUSA_LAYER_CONFIG_RANGES_FILE.c_str(), (const void*)prusa_out.data(), prusa_out.length(), mz_uint(m_options.compression_level))) {
                 add_error("Unable to add layer heights profile file to archive");
                 return false;
             }
@@ -3531,7 +4093,7 @@ namespace Slic3r {
             // Adds version header at the beginning:
             out = std::string("support_points_format_version=") + std::to_string(support_points_format_version) + std::string("\n") + out;
 
-            if (!mz_zip_writer_add_mem(&archive, SLA_SUPPORT_POINTS_FILE.c_str(), (const void*)out.data(), out.length(), MZ_DEFAULT_COMPRESSION)) {
+            if (!mz_zip_writer_add_mem(&archive, SLA_SUPPORT_POINTS_FILE.c_str(), (const void*)out.data(), out.length(), mz_uint(m_options.compression_level))) {
                 add_error("Unable to add sla support points file to archive");
                 return false;
             }
@@ -3582,7 +4144,7 @@ namespace Slic3r {
             // Adds version header at the beginning:
             out = std::string("drain_holes_format_version=") + std::to_string(drain_holes_format_version) + std::string("\n") + out;
             
-            if (!mz_zip_writer_add_mem(&archive, SLA_DRAIN_HOLES_FILE.c_str(), static_cast<const void*>(out.data()), out.length(), mz_uint(MZ_DEFAULT_COMPRESSION))) {
+            if (!mz_zip_writer_add_mem(&archive, SLA_DRAIN_HOLES_FILE.c_str(), static_cast<const void*>(out.data()), out.length(), mz_uint(m_options.compression_level))) {
                 add_error("Unable to add sla support points file to archive");
                 return false;
             }
@@ -3611,7 +4173,7 @@ namespace Slic3r {
         }
 
         if (!out.empty()) {
-            if (!mz_zip_writer_add_mem(&archive, config_name.c_str(), (const void*)out.data(), out.length(), MZ_DEFAULT_COMPRESSION)) {
+            if (!mz_zip_writer_add_mem(&archive, config_name.c_str(), (const void*)out.data(), out.length(), mz_uint(m_options.compression_level))) {
                 add_error("Unable to add print config file to archive");
                 return false;
             }
@@ -3862,7 +4424,7 @@ namespace Slic3r {
 
         std::string out = stream.str();
 
-        if (!mz_zip_writer_add_mem(&archive, file_path.c_str(), (const void*)out.data(), out.length(), MZ_DEFAULT_COMPRESSION)) {
+        if (!mz_zip_writer_add_mem(&archive, file_path.c_str(), (const void*)out.data(), out.length(), mz_uint(m_options.compression_level))) {
             add_error("Unable to add model config file to archive");
             return false;
         }
@@ -3914,7 +4476,7 @@ bool _3MF_Exporter::_add_custom_gcode_per_print_z_file_to_archive( mz_zip_archiv
     } 
 
     if (!out.empty()) {
-        if (!mz_zip_writer_add_mem(&archive, CUSTOM_GCODE_PER_PRINT_Z_FILE.c_str(), (const void*)out.data(), out.length(), MZ_DEFAULT_COMPRESSION)) {
+        if (!mz_zip_writer_add_mem(&archive, CUSTOM_GCODE_PER_PRINT_Z_FILE.c_str(), (const void*)out.data(), out.length(), mz_uint(m_options.compression_level))) {
             add_error("Unable to add custom Gcodes per print_z file to archive");
             return false;
         }
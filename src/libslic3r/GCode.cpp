@@ -2225,9 +2225,22 @@ void GCodeGenerator::process_layers(
                 }
             }
         });
-    const auto generator = tbb::make_filter<size_t, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
+    // Everything which doesn't depend on the state of the generator is computed in parallel, ahead of the generator.
+    const auto prepare = tbb::make_filter<size_t, PreparedLayer>(slic3r_tbb_filtermode::parallel,
+        [this, &print, &print_object_instances_ordering, &layers_to_print](size_t layer_to_print_idx) -> PreparedLayer {
+            PreparedLayer prepared;
+            if (layer_to_print_idx < layers_to_print.size()) {
+                this->m_throw_if_canceled();
+                prepared = prepare_layer(print, layers_to_print[layer_to_print_idx].second, &print_object_instances_ordering,
+                                         size_t(-1), m_spiral_vase != nullptr);
+            }
+            prepared.layer_to_print_idx = layer_to_print_idx;
+            return prepared;
+        });
+    const auto generator = tbb::make_filter<PreparedLayer, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
         [this, &print, &status_monitor, &tool_ordering, &print_object_instances_ordering, &layers_to_print, &preamble](
-            size_t layer_to_print_idx) -> LayerResult {
+            PreparedLayer prepared) -> LayerResult {
+            const size_t layer_to_print_idx = prepared.layer_to_print_idx;
             if (layer_to_print_idx == layers_to_print.size()) {
                 // Pressure equalizer need insert empty input. Because it returns one layer back.
                 // Insert NOP (no operation) layer;
@@ -2245,7 +2258,7 @@ void GCodeGenerator::process_layers(
                 if (m_wipe_tower && layer_tools->has_wipe_tower)
                     m_wipe_tower->next_layer();
                  this->m_throw_if_canceled();
-                LayerResult result = this->process_layer(print, status_monitor, layer.second, *layer_tools,
+                LayerResult result = this->process_layer(print, status_monitor, layer.second, *layer_tools, prepared,
                                                          &layer == &layers_to_print.back(),
                                                          &print_object_instances_ordering, size_t(-1));
                 result.gcode = preamble + result.gcode;
@@ -2277,7 +2290,9 @@ void GCodeGenerator::process_layers(
              CNumericLocalesSetter locales_setter;
              return cooling_buffer->process_layer(std::move(in.gcode), in.layer_id, in.cooling_buffer_flush);
         });
-    const auto find_replace = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::serial_in_order,
+    // The substitutions are applied to a single layer at a time and GCodeFindReplace::process_layer() is const,
+    // thus the layers are processed in parallel, the output filter restores their order.
+    const auto find_replace = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::parallel,
         [this, find_replace = this->m_find_replace.get()](std::string s) -> std::string {
             CNumericLocalesSetter locales_setter;
             this->m_throw_if_canceled();
@@ -2307,7 +2322,7 @@ void GCodeGenerator::process_layers(
         return fan_mover->process_gcode(in, true);
     });
 
-    tbb::filter<void, LayerResult> pipeline_to_layerresult = layer_select & generator;
+    tbb::filter<void, LayerResult> pipeline_to_layerresult = layer_select & prepare & generator;
     if (m_spiral_vase)
         pipeline_to_layerresult = pipeline_to_layerresult & spiral_vase;
     if (m_pressure_equalizer)
@@ -2379,8 +2394,20 @@ void GCodeGenerator::process_layers(
                 return layer_to_print_idx++;
             }
         });
-    const auto generator = tbb::make_filter<size_t, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [this, &print, &status_monitor, &tool_ordering, &layers_to_print, single_object_idx, &preamble](size_t layer_to_print_idx) -> LayerResult {
+    // Everything which doesn't depend on the state of the generator is computed in parallel, ahead of the generator.
+    const auto prepare = tbb::make_filter<size_t, PreparedLayer>(slic3r_tbb_filtermode::parallel,
+        [this, &print, &layers_to_print, single_object_idx](size_t layer_to_print_idx) -> PreparedLayer {
+            PreparedLayer prepared;
+            if (layer_to_print_idx < layers_to_print.size()) {
+                this->m_throw_if_canceled();
+                prepared = prepare_layer(print, {layers_to_print[layer_to_print_idx]}, nullptr, single_object_idx, m_spiral_vase != nullptr);
+            }
+            prepared.layer_to_print_idx = layer_to_print_idx;
+            return prepared;
+        });
+    const auto generator = tbb::make_filter<PreparedLayer, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
+        [this, &print, &status_monitor, &tool_ordering, &layers_to_print, single_object_idx, &preamble](PreparedLayer prepared) -> LayerResult {
+            const size_t layer_to_print_idx = prepared.layer_to_print_idx;
             if (layer_to_print_idx == layers_to_print.size()) {
                 // Pressure equalizer need insert empty input. Because it returns one layer back.
                 // Insert NOP (no operation) layer;
@@ -2396,7 +2423,7 @@ void GCodeGenerator::process_layers(
                 assert(layer_tool_ptr);
                 if(!layer_tool_ptr)
                     return LayerResult::make_nop_layer_result();
-                LayerResult result = this->process_layer(print, status_monitor, {std::move(layer)}, *layer_tool_ptr,
+                LayerResult result = this->process_layer(print, status_monitor, {std::move(layer)}, *layer_tool_ptr, prepared,
                                                          &layer == &layers_to_print.back(),
                                                          nullptr, single_object_idx);
                 result.gcode = preamble + result.gcode;
@@ -2427,7 +2454,9 @@ void GCodeGenerator::process_layers(
             this->m_throw_if_canceled();            CNumericLocalesSetter locales_setter;
             return cooling_buffer->process_layer(std::move(in.gcode), in.layer_id, in.cooling_buffer_flush);
         });
-    const auto find_replace = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::serial_in_order,
+    // The substitutions are applied to a single layer at a time and GCodeFindReplace::process_layer() is const,
+    // thus the layers are processed in parallel, the output filter restores their order.
+    const auto find_replace = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::parallel,
         [this, find_replace = this->m_find_replace.get()](std::string s) -> std::string {
             this->m_throw_if_canceled();
             CNumericLocalesSetter locales_setter;
@@ -2455,7 +2484,7 @@ void GCodeGenerator::process_layers(
         return fan_mover->process_gcode(in, true);
     });
 
-    tbb::filter<void, LayerResult> pipeline_to_layerresult = layer_select & generator;
+    tbb::filter<void, LayerResult> pipeline_to_layerresult = layer_select & prepare & generator;
     if (m_spiral_vase)
         pipeline_to_layerresult = pipeline_to_layerresult & spiral_vase;
     if (m_pressure_equalizer)
@@ -2973,6 +3002,46 @@ std::vector<GCodeGenerator::InstanceToPrint> GCodeGenerator::sort_print_object_i
 	return out;
 }
 
+GCodeGenerator::PreparedLayer GCodeGenerator::prepare_layer(
+    const Print                             &print,
+    const ObjectsLayerToPrint               &layers,
+    const std::vector<const PrintInstance*> *ordering,
+    const size_t                             single_object_instance_idx,
+    const bool                               spiral_vase)
+{
+    // Only read the print & the layers here: this is called from a parallel stage of the pipeline,
+    // concurrently with process_layer() working on the previous layers.
+    PreparedLayer out;
+    out.instances_to_print = sort_print_object_instances(layers, ordering, single_object_instance_idx);
+
+    // Same checks as process_layer(): spiral vase is allowed for a single object, without support.
+    const Layer *layer = layers.size() == 1 && layers.front().support_layer == nullptr ? layers.front().object_layer : nullptr;
+    if (spiral_vase && layer != nullptr) {
+        bool enable = (layer->id() > 0 || !layer->object()->has_brim()) && (layer->id() >= (size_t)print.config().skirt_height.value && ! print.has_infinite_skirt());
+        if (enable) {
+            for (const LayerRegion *layer_region : layer->regions())
+                if (size_t(layer_region->region().config().bottom_solid_layers.value) > layer->id() ||
+                    layer_region->perimeters().items_count() > 1u ||
+                    layer_region->fills().items_count() > 0 ||
+                    // there should be a fills if there is an ironings anyway
+                    layer_region->ironings().items_count() > 0) {
+                    enable = false;
+                    break;
+                }
+        }
+        out.spiral_vase_enable = enable;
+    }
+
+    double layer_area = 0;
+    for (const GCode::ObjectLayerToPrint &print_layer : layers) {
+        //note: a layer can be null if the objetc doesn't have aanything to print at this height.
+        if (print_layer.layer())
+            for (const ExPolygon &poly : print_layer.layer()->lslices()) layer_area += poly.area();
+    }
+    out.layer_area = unscaled(unscaled(layer_area));
+    return out;
+}
+
 namespace ProcessLayer
 {
 
@@ -3215,6 +3284,8 @@ LayerResult GCodeGenerator::process_layer(
     // Set of object & print layers of the same PrintObject and with the same print_z.
     const ObjectsLayerToPrint               &layers,
     const LayerTools                        &layer_tools,
+    // Output of prepare_layer() for these layers.
+    const PreparedLayer                     &prepared,
     const bool                               last_layer,
     // Pairs of PrintObject index and its instance index.
     const std::vector<const PrintInstance*> *ordering,
@@ -3286,18 +3357,7 @@ LayerResult GCodeGenerator::process_layer(
     // Just a reminder: A spiral vase mode is allowed for a single object, single material print only.
     m_enable_loop_clipping = true;
     if (m_spiral_vase && layers.size() == 1 && support_layer == nullptr) {
-        bool enable = (layer.id() > 0 || !layer.object()->has_brim()) && (layer.id() >= (size_t)print.config().skirt_height.value && ! print.has_infinite_skirt());
-        if (enable) {
-            for (const LayerRegion *layer_region : layer.regions())
-                if (size_t(layer_region->region().config().bottom_solid_layers.value) > layer.id() ||
-                    layer_region->perimeters().items_count() > 1u ||
-                    layer_region->fills().items_count() > 0 ||
-                    // there should be a fills if there is an ironings anyway
-                    layer_region->ironings().items_count() > 0) {
-                    enable = false;
-                    break;
-                }
-        }
+        const bool enable = prepared.spiral_vase_enable;
         result.spiral_vase_enable = enable;
         if (enable)
             m_spiral_vase_layer = std::abs(m_spiral_vase_layer) + 1;
@@ -3576,7 +3636,7 @@ LayerResult GCodeGenerator::process_layer(
 
         }
 
-        std::vector<InstanceToPrint> instances_to_print = sort_print_object_instances(layers, ordering, single_object_instance_idx);
+        const std::vector<InstanceToPrint> &instances_to_print = prepared.instances_to_print;
 
         // We are almost ready to print. However, we must go through all the objects twice to print the the overridden extrusions first (infill/perimeter wiping feature):
         bool is_anything_overridden = layer_tools.wiping_extrusions().is_anything_overridden();
@@ -3604,14 +3664,7 @@ LayerResult GCodeGenerator::process_layer(
     emit_milling_commands(gcode, layers);
 
     // set area used in this layer
-    double layer_area = 0;
-    for (const GCode::ObjectLayerToPrint &print_layer : layers) {
-        //note: a layer can be null if the objetc doesn't have aanything to print at this height.
-        if (print_layer.layer())
-            for (auto poly : print_layer.layer()->lslices()) layer_area += poly.area();
-    }
-    layer_area = unscaled(unscaled(layer_area));
-    status_monitor.stats().layer_area_stats.emplace_back(print_z, layer_area);
+    status_monitor.stats().layer_area_stats.emplace_back(print_z, prepared.layer_area);
 
     BOOST_LOG_TRIVIAL(trace) << "Exported layer " << layer.id() << " print_z " << print_z <<
     log_memory_info();
@@ -3652,7 +3705,7 @@ void GCodeGenerator::process_layer_single_object(
             m_print_object_instance_id = static_cast<uint16_t>(print_args.print_instance.instance_id);
             const PrintInstance &instance = print_object.instances()[print_args.print_instance.instance_id];
             if (print.config().avoid_crossing_perimeters)
-                m_avoid_crossing_perimeters.init_layer(*m_layer);
+                m_avoid_crossing_perimeters.init_layer(*m_layer, print.avoid_crossing_perimeters_boundaries(m_layer));
             // ask for a bigger lift for travel to object when moving to another object
             if (m_last_instance == nullptr || (&instance != m_last_instance))
                 set_extra_lift(m_last_layer_z, layer()->id(), print.config(), m_writer, print_args.extruder_id);
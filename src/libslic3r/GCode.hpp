@@ -245,6 +245,37 @@ private:
     static ObjectsLayerToPrint         		                     collect_layers_to_print(const PrintObject &object, Print::StatusMonitor &status_monitor);
     static std::vector<std::pair<coordf_t, ObjectsLayerToPrint>> collect_layers_to_print(const Print &print, Print::StatusMonitor &status_monitor);
 
+	struct InstanceToPrint
+	{
+        InstanceToPrint(size_t object_layer_to_print_id, const PrintObject &print_object, size_t instance_id) :
+            object_layer_to_print_id(object_layer_to_print_id), print_object(print_object), instance_id(instance_id) {}
+
+        // Index into std::vector<ObjectLayerToPrint>, which contains Object and Support layers for the current print_z, collected for a single object, or for possibly multiple objects with multiple instances.
+        const size_t             object_layer_to_print_id;
+		const PrintObject 		&print_object;
+		// Instance idx of the copy of a print object.
+		const size_t			 instance_id;
+	};
+
+    // Data of a layer, which doesn't depend on the state of the G-code generator (position, extruder, retraction, travel...).
+    // It is computed by a parallel stage of process_layers(), ahead of the serial process_layer().
+    struct PreparedLayer
+    {
+        // Index into layers_to_print of process_layers(). Equal to layers_to_print.size() for the NOP layer of the pressure equalizer.
+        size_t                       layer_to_print_idx { 0 };
+        // Instances sorted in the order they are extruded, see sort_print_object_instances().
+        std::vector<InstanceToPrint> instances_to_print;
+        // May the spiral vase be enabled for this layer? Only valid if spiral vase mode is active.
+        bool                         spiral_vase_enable { false };
+        // Area of the lslices of all the layers, unscaled (mm^2).
+        double                       layer_area { 0. };
+    };
+    static PreparedLayer prepare_layer(
+        const Print                             &print,
+        const ObjectsLayerToPrint               &layers,
+        const std::vector<const PrintInstance*> *ordering,
+        const size_t                             single_object_instance_idx,
+        const bool                               spiral_vase);
 
     LayerResult process_layer(
         const Print                     &print,
@@ -252,6 +283,8 @@ private:
         // Set of object & print layers of the same PrintObject and with the same print_z.
         const ObjectsLayerToPrint       &layers,
         const LayerTools  				&layer_tools,
+        // Output of prepare_layer() for these layers.
+        const PreparedLayer             &prepared,
         const bool                       last_layer,
 		// Pairs of PrintObject index and its instance index.
 		const std::vector<const PrintInstance*> *ordering,
@@ -312,19 +345,7 @@ private:
         ExtrusionPaths& notch_extrusion_start, ExtrusionPaths& notch_extrusion_end, bool is_hole_loop, bool is_full_loop_ccw);
 
 
-	struct InstanceToPrint
-	{
-        InstanceToPrint(size_t object_layer_to_print_id, const PrintObject &print_object, size_t instance_id) :
-            object_layer_to_print_id(object_layer_to_print_id), print_object(print_object), instance_id(instance_id) {}
-
-        // Index into std::vector<ObjectLayerToPrint>, which contains Object and Support layers for the current print_z, collected for a single object, or for possibly multiple objects with multiple instances.
-        const size_t             object_layer_to_print_id;
-		const PrintObject 		&print_object;
-		// Instance idx of the copy of a print object.
-		const size_t			 instance_id;
-	};
-
-	std::vector<InstanceToPrint> sort_print_object_instances(
+	static std::vector<InstanceToPrint> sort_print_object_instances(
 		// Object and Support layers for the current print_z, collected for a single object, or for possibly multiple objects with multiple instances.
         const std::vector<ObjectLayerToPrint>           &layers,
 		// Ordering must be defined for normal (non-sequential print).
@@ -11,10 +11,13 @@
 #include "../Geometry.hpp"
 #include "../ClipperUtils.hpp"
 #include "../SVG.hpp"
+#include "../Utils.hpp"
 #include "AvoidCrossingPerimeters.hpp"
 
 #include <boost/log/trivial.hpp>
 
+#include <oneapi/tbb/parallel_for.h>
+
 #include <numeric>
 #include <unordered_set>
 #include <boost/range/adaptor/reversed.hpp>
@@ -1465,30 +1468,32 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCodeGenerator &gcodegen, cons
     const ExPolygons &lslices           = gcodegen.layer()->lslices();
     const coord_t     perimeter_spacing = get_perimeter_spacing(*gcodegen.layer());
     bool              is_support_layer  = dynamic_cast<const SupportLayer *>(gcodegen.layer()) != nullptr;
-    if (!use_external && (is_support_layer || (!m_lslices_offset.empty() 
+    if (!use_external && (is_support_layer || (m_layer_boundaries && !m_layer_boundaries->lslices_offset.empty()
          /* already done by the caller && !any_expolygon_contains(m_lslices_offset, m_lslices_offset_bboxes, m_grid_lslices_offset, travel)*/))) {
-        // Initialize m_internal only when it is necessary.
-        if (m_internal.boundaries.empty()) {
+        // Initialize m_internal only when it is necessary and when it was not precomputed.
+        const bool precomputed = ! is_support_layer && m_layer_boundaries && m_layer_boundaries->has_internal;
+        if (! precomputed && m_internal.boundaries.empty()) {
             std::vector<std::pair<ExPolygon, ExPolygon>> boundary_growth;
             init_boundary(&m_internal, to_polygons(get_boundary(*gcodegen.layer(), boundary_growth, m_internal.to_avoid)), perimeter_spacing * 2);
             m_internal.boundary_growth = std::move(boundary_growth);
         }
+        const Boundary &internal = precomputed ? m_layer_boundaries->internal : m_internal;
 
         // Don't
         // Trim the travel line by the bounding box.
-        if (!m_internal.boundaries.empty() && Geometry::liang_barsky_line_clipping(startf, endf, m_internal.bbox)) {
+        if (!internal.boundaries.empty() && Geometry::liang_barsky_line_clipping(startf, endf, internal.bbox)) {
             Point nearest_start = start;
             Point nearest_end = end;
             // get nearest point
-            if (!m_internal.bbox.contains(nearest_start.cast<double>())) {
-                BoundingBox bb_coord_t(m_internal.bbox.min.cast<coord_t>(), m_internal.bbox.max.cast<coord_t>());
+            if (!internal.bbox.contains(nearest_start.cast<double>())) {
+                BoundingBox bb_coord_t(internal.bbox.min.cast<coord_t>(), internal.bbox.max.cast<coord_t>());
                 nearest_start = bb_coord_t.nearest_point(nearest_start);
             }
-            if (!m_internal.bbox.contains(nearest_end.cast<double>())) {
-                BoundingBox bb_coord_t(m_internal.bbox.min.cast<coord_t>(), m_internal.bbox.max.cast<coord_t>());
+            if (!internal.bbox.contains(nearest_end.cast<double>())) {
+                BoundingBox bb_coord_t(internal.bbox.min.cast<coord_t>(), internal.bbox.max.cast<coord_t>());
                 nearest_end = bb_coord_t.nearest_point(nearest_end);
             }
-            travel_intersection_count = avoid_perimeters(m_internal, nearest_start/*startf.cast<coord_t>()*/, nearest_end/*endf.cast<coord_t>()*/, perimeter_spacing, *gcodegen.layer(), result_pl);
+            travel_intersection_count = avoid_perimeters(internal, nearest_start/*startf.cast<coord_t>()*/, nearest_end/*endf.cast<coord_t>()*/, perimeter_spacing, *gcodegen.layer(), result_pl);
             result_pl.points.front()  = start;
             result_pl.points.back()   = end;
         }
@@ -1552,28 +1557,113 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCodeGenerator &gcodegen, cons
 
 // ************************************* AvoidCrossingPerimeters::init_layer() *****************************************
 
-void AvoidCrossingPerimeters::init_layer(const Layer &layer)
+static void init_layer_boundaries(const Layer &layer, AvoidCrossingPerimeters::LayerBoundaries &out)
 {
-    m_internal.clear();
-    m_external.clear();
-    m_lslices_offset.clear();
-    m_lslices_offset_bboxes.clear();
-
     float perimeter_offset = -get_external_perimeter_width(layer) / float(2.);
-    m_lslices_offset        = offset_ex(layer.lslices(), perimeter_offset);
+    out.lslices_offset     = offset_ex(layer.lslices(), perimeter_offset);
 
-    m_lslices_offset_bboxes.reserve(m_lslices_offset.size());
-    for (const ExPolygon &ex_poly : m_lslices_offset)
-        m_lslices_offset_bboxes.emplace_back(get_extents(ex_poly));
+    out.lslices_offset_bboxes.reserve(out.lslices_offset.size());
+    for (const ExPolygon &ex_poly : out.lslices_offset)
+        out.lslices_offset_bboxes.emplace_back(get_extents(ex_poly));
 
     BoundingBox bbox_slice(get_extents(layer.lslices()));
     bbox_slice.offset(SCALED_EPSILON);
 
-    m_grid_lslices_offset.set_bbox(bbox_slice);
-    m_grid_lslices_offset.create(m_lslices_offset, coord_t(scale_(1.)));
+    out.grid_lslices_offset.set_bbox(bbox_slice);
+    out.grid_lslices_offset.create(out.lslices_offset, coord_t(scale_(1.)));
+}
+
+void AvoidCrossingPerimeters::init_layer(const Layer &layer, std::shared_ptr<const LayerBoundaries> precomputed)
+{
+    m_internal.clear();
+    m_external.clear();
+
+    if (precomputed) {
+        m_layer_boundaries = std::move(precomputed);
+    } else {
+        auto layer_boundaries = std::make_shared<LayerBoundaries>();
+        init_layer_boundaries(layer, *layer_boundaries);
+        m_layer_boundaries = std::move(layer_boundaries);
+    }
     m_init = true;
 }
 
+// Fingerprint of everything the boundaries of an object layer depend on, to share them between identical layers.
+static std::string layer_boundaries_key(const Layer &layer)
+{
+    MD5Hasher hasher;
+    auto hash_expolygon = [&hasher](const ExPolygon &expoly) {
+        hasher.process(expoly.contour.points.data(), expoly.contour.points.size() * sizeof(Point));
+        for (const Polygon &hole : expoly.holes)
+            hasher.process(hole.points.data(), hole.points.size() * sizeof(Point));
+    };
+    const coord_t perimeter_spacing       = get_perimeter_spacing(layer);
+    const float   external_perimeter_width = get_external_perimeter_width(layer);
+    hasher.process(&perimeter_spacing, sizeof(perimeter_spacing));
+    hasher.process(&external_perimeter_width, sizeof(external_perimeter_width));
+    for (const ExPolygon &expoly : layer.lslices())
+        hash_expolygon(expoly);
+    // The top surfaces are excluded from the internal boundary, see get_boundary().
+    for (const LayerRegion *layer_region : layer.regions())
+        if (layer_region->region().config().avoid_crossing_top) {
+            const bool keep_perimeter = layer_region->region().config().perimeters > 0 && ! layer_region->region().config().ironing;
+            hasher.process(&keep_perimeter, sizeof(keep_perimeter));
+            for (const Surface &surface : layer_region->fill_surfaces())
+                if (surface.has_pos_top())
+                    hash_expolygon(surface.expolygon);
+        }
+    return hasher.digest();
+}
+
+AvoidCrossingPerimeters::LayersBoundaries AvoidCrossingPerimeters::precompute_layers(const Print &print, const std::function<void()> &throw_if_canceled)
+{
+    std::vector<const Layer*> layers;
+    for (const PrintObject *object : print.objects())
+        layers.insert(layers.end(), object->layers().begin(), object->layers().end());
+
+    std::vector<std::string> keys(layers.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()), [&layers, &keys, &throw_if_canceled](const tbb::blocked_range<size_t> &range) {
+        throw_if_canceled();
+        for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx)
+            keys[layer_idx] = layer_boundaries_key(*layers[layer_idx]);
+    });
+
+    // A layer identical to the layer below it reuses its boundaries, typical for prismatic parts of an object.
+    std::vector<size_t> computed_by(layers.size());
+    std::vector<size_t> to_compute;
+    for (size_t layer_idx = 0; layer_idx < layers.size(); ++ layer_idx) {
+        if (layer_idx > 0 && layers[layer_idx]->object() == layers[layer_idx - 1]->object() && keys[layer_idx] == keys[layer_idx - 1]) {
+            computed_by[layer_idx] = computed_by[layer_idx - 1];
+        } else {
+            computed_by[layer_idx] = layer_idx;
+            to_compute.emplace_back(layer_idx);
+        }
+    }
+
+    std::vector<std::shared_ptr<const LayerBoundaries>> boundaries(layers.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, to_compute.size()), [&layers, &to_compute, &boundaries, &throw_if_canceled](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            throw_if_canceled();
+            const Layer &layer = *layers[to_compute[i]];
+            auto layer_boundaries = std::make_shared<LayerBoundaries>();
+            init_layer_boundaries(layer, *layer_boundaries);
+            std::vector<std::pair<ExPolygon, ExPolygon>> boundary_growth;
+            init_boundary(&layer_boundaries->internal, to_polygons(get_boundary(layer, boundary_growth, layer_boundaries->internal.to_avoid)),
+                          get_perimeter_spacing(layer) * 2);
+            layer_boundaries->internal.boundary_growth = std::move(boundary_growth);
+            layer_boundaries->has_internal = true;
+            boundaries[to_compute[i]] = std::move(layer_boundaries);
+        }
+    });
+
+    LayersBoundaries out;
+    out.reserve(layers.size());
+    for (size_t layer_idx = 0; layer_idx < layers.size(); ++ layer_idx)
+        out.emplace(layers[layer_idx], boundaries[computed_by[layer_idx]]);
+    BOOST_LOG_TRIVIAL(debug) << "Avoid crossing perimeters: " << to_compute.size() << " boundaries computed for " << layers.size() << " layers";
+    return out;
+}
+
 #if 0
 static double travel_length(const std::vector<TravelPoint> &travel) {
     double total_length = 0;
@@ -9,12 +9,17 @@
 #include "../ExPolygon.hpp"
 #include "../EdgeGrid.hpp"
 
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
 namespace Slic3r {
 
 // Forward declarations.
 class GCodeGenerator;
 class Layer;
 class Point;
+class Print;
 
 class AvoidCrossingPerimeters
 {
@@ -27,7 +32,9 @@ public:
     bool        disabled_once() const   { return m_disabled_once; }
     void        reset_once_modifiers()  { m_use_external_mp_once = false; m_disabled_once = false; }
 
-    void        init_layer(const Layer &layer);
+    struct LayerBoundaries;
+    // Use the boundaries precomputed by precompute_layers() if provided, otherwise compute them.
+    void        init_layer(const Layer &layer, std::shared_ptr<const LayerBoundaries> precomputed = {});
     bool        is_init() { return m_init; }
 
     Polyline    travel_to(const GCodeGenerator &gcodegen, const Point& point)
@@ -63,6 +70,23 @@ public:
         }
     };
 
+    // Boundaries of an object layer, which do not depend on the state of the G-code generator nor on the object instance.
+    struct LayerBoundaries {
+        // Lslices offseted by half an external perimeter width. Used for detection if line or polyline is inside of any polygon.
+        ExPolygons               lslices_offset;
+        std::vector<BoundingBox> lslices_offset_bboxes;
+        // Used for detection of line or polyline is inside of any polygon.
+        EdgeGrid::Grid           grid_lslices_offset;
+        // Store all needed data for travels inside object, valid if has_internal.
+        Boundary                 internal;
+        bool                     has_internal { false };
+    };
+    using LayersBoundaries = std::unordered_map<const Layer*, std::shared_ptr<const LayerBoundaries>>;
+
+    // Compute the boundaries of all the object layers of a print in parallel.
+    // Consecutive layers of an object with the same slices and top surfaces share their boundaries.
+    static LayersBoundaries precompute_layers(const Print &print, const std::function<void()> &throw_if_canceled);
+
 private:
     bool           m_use_external_mp { false };
     // just for the next travel move
@@ -73,12 +97,9 @@ private:
 
     bool m_init{ false };
 
-    // Lslices offseted by half an external perimeter width. Used for detection if line or polyline is inside of any polygon.
-    ExPolygons               m_lslices_offset;
-    std::vector<BoundingBox> m_lslices_offset_bboxes;
-    // Used for detection of line or polyline is inside of any polygon.
-    EdgeGrid::Grid           m_grid_lslices_offset;
-    // Store all needed data for travels inside object
+    // Boundaries of the current layer, precomputed or computed by init_layer().
+    std::shared_ptr<const LayerBoundaries> m_layer_boundaries;
+    // Store all needed data for travels inside object, if not precomputed in m_layer_boundaries.
     Boundary m_internal;
     // Store all needed data for travels outside object
     Boundary m_external;
@@ -11,6 +11,9 @@
 #include <map>
 #include <functional>
 #include <atomic>
+#include <unordered_map>
+
+#include <boost/container_hash/hash.hpp>
 
 namespace Slic3r {
 
@@ -229,6 +232,15 @@ double LinesBucketQueue::removeLowests()
     return curHeight;
 }
 
+std::vector<std::pair<size_t, unsigned>> LinesBucketQueue::getCurPiles() const
+{
+    std::vector<std::pair<size_t, unsigned>> piles;
+    for (size_t bucket_idx = 0; bucket_idx < _buckets.size(); ++ bucket_idx)
+        if (_buckets[bucket_idx].valid())
+            piles.emplace_back(bucket_idx, _buckets[bucket_idx].curPileIdx());
+    return piles;
+}
+
 LineWithIDs LinesBucketQueue::getCurLines() const
 {
     LineWithIDs lines;
@@ -290,7 +302,7 @@ std::pair<std::vector<ExtrusionPaths>, std::vector<ExtrusionPaths>> getAllLayers
 ConflictComputeOpt ConflictChecker::find_inter_of_lines(const LineWithIDs &lines)
 {
     using namespace RasterizationImpl;
-    std::map<IndexPair, std::vector<int>> indexToLine;
+    std::unordered_map<IndexPair, std::vector<int>, boost::hash<IndexPair>> indexToLine;
 
     for (int i = 0; i < (int)lines.size(); ++i) {
         const LineWithID &l1      = lines[i];
@@ -307,6 +319,88 @@ ConflictComputeOpt ConflictChecker::find_inter_of_lines(const LineWithIDs &lines
     return {};
 }
 
+LineWithIDs ConflictChecker::overlapping_lines(const LinesBucketQueue &queue, const std::vector<std::pair<size_t, unsigned>> &piles,
+                                               const std::vector<std::vector<BoundingBox>> &piles_bboxes)
+{
+    struct InstanceBox {
+        BoundingBox box;
+        size_t      bucket_idx;
+        unsigned    pile_idx;
+        int         obj_id;
+        int         inst_id;
+        bool        overlaps { false };
+    };
+    std::vector<InstanceBox> boxes;
+    for (const auto &[bucket_idx, pile_idx] : piles) {
+        const LinesBucket &bucket = queue.buckets()[bucket_idx];
+        const BoundingBox &bbox   = piles_bboxes[bucket_idx][pile_idx];
+        if (! bbox.defined)
+            continue;
+        for (int inst_id = 0; inst_id < int(bucket.offsets().size()); ++ inst_id) {
+            BoundingBox box = bbox;
+            box.translate(bucket.offsets()[inst_id]);
+            box.offset(SCALED_EPSILON);
+            boxes.push_back({ box, bucket_idx, pile_idx, bucket.id(), inst_id });
+        }
+    }
+
+    // Sweep and prune along the X axis: only boxes already started and not yet ended may overlap the next box.
+    std::sort(boxes.begin(), boxes.end(), [](const InstanceBox &l, const InstanceBox &r) { return l.box.min.x() < r.box.min.x(); });
+    std::vector<InstanceBox*> active;
+    for (InstanceBox &box : boxes) {
+        active.erase(std::remove_if(active.begin(), active.end(), [&box](const InstanceBox *other) { return other->box.max.x() < box.box.min.x(); }), active.end());
+        for (InstanceBox *other : active)
+            if ((other->obj_id != box.obj_id || other->inst_id != box.inst_id) &&
+                other->box.min.y() <= box.box.max.y() && box.box.min.y() <= other->box.max.y())
+                other->overlaps = box.overlaps = true;
+        active.emplace_back(&box);
+    }
+
+    LineWithIDs lines;
+    for (const InstanceBox &box : boxes)
+        if (box.overlaps) {
+            const LinesBucket &bucket = queue.buckets()[box.bucket_idx];
+            for (const ExtrusionPath &path : bucket.piles()[box.pile_idx]) {
+                Polyline check_polyline = path.as_polyline().to_polyline();
+                check_polyline.translate(bucket.offsets()[box.inst_id]);
+                for (size_t idx_pt = 1; idx_pt < check_polyline.size(); ++idx_pt)
+                    lines.emplace_back(Line(check_polyline.points[idx_pt - 1], check_polyline.points[idx_pt]), box.obj_id, box.inst_id, path.role());
+            }
+        }
+    return lines;
+}
+
+// Everything the conflicting tool paths depend on: the objects, the timestamps of their steps producing or modifying extrusions,
+// their instances and the parameters of the fake wipe tower extrusions.
+std::string ConflictChecker::tool_paths_key(SpanOfConstPtrs<PrintObject> objs, const WipeTowerData &wtd)
+{
+    std::string key;
+    auto append = [&key](const auto &value) { key.append(reinterpret_cast<const char*>(&value), sizeof(value)); };
+    for (const PrintObject *obj : objs) {
+        append(obj);
+        for (PrintObjectStep step : { posPerimeters, posInfill, posIroning, posSupportMaterial, posEstimateCurledExtrusions, posCalculateOverhangingPerimeters, posSimplifyPath }) {
+            PrintStateBase::StateWithTimeStamp state = obj->step_state_with_timestamp(step);
+            append(state.state);
+            append(state.timestamp);
+        }
+        append(obj->instances().size());
+        for (const PrintInstance &inst : obj->instances())
+            append(inst.shift);
+    }
+    append(wtd.number_of_toolchanges);
+    append(wtd.depth);
+    append(wtd.brim_width);
+    append(wtd.height);
+    append(wtd.width);
+    append(wtd.first_layer_height);
+    append(wtd.cone_angle);
+    append(wtd.position);
+    append(wtd.rotation_angle);
+    for (const std::pair<float, float> &z_and_depth : wtd.z_and_depth_pairs)
+        append(z_and_depth);
+    return key;
+}
+
 ConflictResultOpt ConflictChecker::find_inter_of_lines_in_diff_objs(SpanOfConstPtrs<PrintObject> objs,
                                                                     const WipeTowerData& wipe_tower_data) // find the first intersection point of lines in different objects
 {
@@ -335,50 +429,68 @@ ConflictResultOpt ConflictChecker::find_inter_of_lines_in_diff_objs(SpanOfConstP
     }
     conflictQueue.build_queue();
 
-    std::vector<LineWithIDs> layersLines;
-    std::vector<double>      heights;
+    // Bounding boxes of the piles, without the instance offsets. Shared by all the instances of an object.
+    std::vector<std::vector<BoundingBox>> piles_bboxes(conflictQueue.buckets().size());
+    for (size_t bucket_idx = 0; bucket_idx < piles_bboxes.size(); ++ bucket_idx)
+        piles_bboxes[bucket_idx].assign(conflictQueue.buckets()[bucket_idx].piles().size(), BoundingBox());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, piles_bboxes.size(), 1), [&conflictQueue, &piles_bboxes](const tbb::blocked_range<size_t> &range) {
+        for (size_t bucket_idx = range.begin(); bucket_idx < range.end(); ++ bucket_idx) {
+            const std::vector<ExtrusionPaths> &piles = conflictQueue.buckets()[bucket_idx].piles();
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, piles.size()), [&piles, &bboxes = piles_bboxes[bucket_idx]](const tbb::blocked_range<size_t> &range) {
+                for (size_t pile_idx = range.begin(); pile_idx < range.end(); ++ pile_idx)
+                    for (const ExtrusionPath &path : piles[pile_idx])
+                        bboxes[pile_idx].merge(get_extents(path.as_polyline().to_polyline()));
+            });
+        }
+    });
+
+    // Only the piles are collected for each height, the lines are produced later for the overlapping instances only.
+    std::vector<std::vector<std::pair<size_t, unsigned>>> layersPiles;
+    std::vector<double>                                   heights;
     while (conflictQueue.valid()) {
-        LineWithIDs lines     = conflictQueue.getCurLines();
-        double      curHeight = conflictQueue.removeLowests();
+        std::vector<std::pair<size_t, unsigned>> piles = conflictQueue.getCurPiles();
+        double curHeight = conflictQueue.removeLowests();
         heights.push_back(curHeight);
-        layersLines.push_back(std::move(lines));
+        layersPiles.push_back(std::move(piles));
     }
 
-    bool                                   find = false;
-    tbb::concurrent_vector<std::tuple<ConflictComputeResult, double, int>> conflict;
-
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, layersLines.size()), [&](tbb::blocked_range<size_t> range) {
-        for (size_t i = range.begin(); i < range.end(); i++) {
-            auto interRes = find_inter_of_lines(layersLines[i]);
-            if (interRes.has_value()) {
-                find = true;
-                conflict.emplace_back(*interRes, heights[i], i);
+    // The heights are increasing, the lowest conflict is the one with the lowest layer index.
+    // Once a conflict is found, the layers above it are not checked anymore.
+    std::atomic<size_t>             first_conflict_layer(layersPiles.size());
+    std::vector<ConflictComputeOpt> conflicts(layersPiles.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, layersPiles.size()), [&](tbb::blocked_range<size_t> range) {
+        for (size_t i = range.begin(); i < range.end() && i < first_conflict_layer.load(std::memory_order_relaxed); i++) {
+            conflicts[i] = find_inter_of_lines(overlapping_lines(conflictQueue, layersPiles[i], piles_bboxes));
+            if (conflicts[i].has_value()) {
+                size_t first = first_conflict_layer.load();
+                while (i < first && ! first_conflict_layer.compare_exchange_weak(first, i)) ;
                 break;
             }
         }
     });
 
-    if (find) {
-        std::sort(conflict.begin(), conflict.end(), [](const std::tuple<ConflictComputeResult, double, int>& i1, const std::tuple<ConflictComputeResult, double, int>& i2) {
-            return std::get<1>(i1) < std::get<1>(i2);
-        });
-
-        auto &[ccr, conflict_height, conflict_layer_id] = conflict[0];
+    ConflictResultOpt result;
+    if (size_t conflict_layer_id = first_conflict_layer.load(); conflict_layer_id < layersPiles.size()) {
+        const ConflictComputeResult &ccr = *conflicts[conflict_layer_id];
+        const double conflict_height = heights[conflict_layer_id];
         const void *ptr1           = conflictQueue.idToObjsPtr(ccr._obj1);
         const void *ptr2           = conflictQueue.idToObjsPtr(ccr._obj2);
         if (ptr1 == &wtptr || ptr2 == &wtptr) {
             assert(! wipe_tower_data.z_and_depth_pairs.empty());
             if (ptr2 == &wtptr) { std::swap(ptr1, ptr2); }
             assert(ptr2 != &wtptr);
-            if (ptr2 == &wtptr) { return {}; }
+            if (ptr2 != &wtptr) {
+                const PrintObject *obj2 = reinterpret_cast<const PrintObject *>(ptr2);
+                result = std::make_optional<ConflictResult>("WipeTower", obj2->model_object()->name, conflict_height, nullptr, ptr2, int(conflict_layer_id));
+            }
+        } else {
+            const PrintObject *obj1 = reinterpret_cast<const PrintObject *>(ptr1);
             const PrintObject *obj2 = reinterpret_cast<const PrintObject *>(ptr2);
-            return std::make_optional<ConflictResult>("WipeTower", obj2->model_object()->name, conflict_height, nullptr, ptr2, conflict_layer_id);
+            result = std::make_optional<ConflictResult>(obj1->model_object()->name, obj2->model_object()->name, conflict_height, ptr1, ptr2, int(conflict_layer_id));
         }
-        const PrintObject *obj1 = reinterpret_cast<const PrintObject *>(ptr1);
-        const PrintObject *obj2 = reinterpret_cast<const PrintObject *>(ptr2);
-        return std::make_optional<ConflictResult>(obj1->model_object()->name, obj2->model_object()->name, conflict_height, ptr1, ptr2, conflict_layer_id);
-    } else
-        return {};
+    }
+
+    return result;
 }
 
 ConflictComputeOpt ConflictChecker::line_intersect(const LineWithID &l1, const LineWithID &l2)
@@ -53,6 +53,10 @@ public:
         }
     }
     double      curHeight() const { return _curHeight; }
+    unsigned    curPileIdx() const { return _curPileIdx; }
+    int         id() const { return _id; }
+    const std::vector<ExtrusionPaths> &piles() const { return _piles; }
+    const Points &offsets() const { return _offsets; }
     LineWithIDs curLines() const
     {
         LineWithIDs lines;
@@ -100,6 +104,9 @@ public:
     }
     double      removeLowests();
     LineWithIDs getCurLines() const;
+    // Pairs of (index of a bucket, index of its current pile) of the valid buckets, the piles returned by getCurLines().
+    std::vector<std::pair<size_t, unsigned>> getCurPiles() const;
+    const std::vector<LinesBucket> &buckets() const { return _buckets; }
 };
 
 void getExtrusionPathsFromEntity(const ExtrusionEntityCollection *entity, ExtrusionPaths &paths);
@@ -126,7 +133,13 @@ using ConflictObjName = std::optional<std::pair<std::string, std::string>>;
 struct ConflictChecker
 {
     static ConflictResultOpt  find_inter_of_lines_in_diff_objs(SpanOfConstPtrs<PrintObject> objs, const WipeTowerData& wtd);
+    // Key of the tool paths checked by find_inter_of_lines_in_diff_objs(), the result may be reused while the key does not change.
+    static std::string        tool_paths_key(SpanOfConstPtrs<PrintObject> objs, const WipeTowerData& wtd);
     static ConflictComputeOpt find_inter_of_lines(const LineWithIDs &lines);
+    // Lines of the piles of one height, only of the instances whose bounding box overlaps
+    // a bounding box of another object or instance. The other instances cannot conflict.
+    static LineWithIDs        overlapping_lines(const LinesBucketQueue &queue, const std::vector<std::pair<size_t, unsigned>> &piles,
+                                                const std::vector<std::vector<BoundingBox>> &piles_bboxes);
     static ConflictComputeOpt line_intersect(const LineWithID &l1, const LineWithID &l2);
 };
 
@@ -3,8 +3,11 @@
 #include "GCodeReader.hpp"
 #include "LocalesUtils.hpp"
 
+#include <cstring>
 #include <iomanip>
 
+#include <boost/algorithm/string/predicate.hpp>
+
 #include <boost/log/trivial.hpp>
 
 
@@ -14,6 +17,11 @@ const std::string& FanMover::process_gcode(const std::string& gcode, bool flush)
 {
     m_process_output = "";
 
+    if (allow_fan_only_scan && nb_seconds_delay == 0 && kickstart <= 0) {
+        _process_gcode_fan_only(gcode, flush);
+        return m_process_output;
+    }
+
     // recompute buffer time to recover from rounding
     m_buffer_time_size = 0;
     for (auto &data : m_buffer) {
@@ -90,6 +98,59 @@ int16_t get_fan_speed(const std::string &line, GCodeFlavor flavor) {
 
 }
 
+void FanMover::_process_gcode_fan_only(const std::string& gcode, bool flush)
+{
+    // Same output as _process_gcode_line() with an empty buffer window: a fan command is dropped
+    // if it is directly followed by another one or if it doesn't change the fan speed.
+    m_process_output.reserve(gcode.size());
+    const char *ptr = gcode.data();
+    const char *end = ptr + gcode.size();
+    while (ptr < end) {
+        const char *eol = static_cast<const char*>(::memchr(ptr, '\n', end - ptr));
+        if (eol == nullptr)
+            eol = end;
+        std::string_view line(ptr, eol - ptr);
+        // like GCodeReader, drop the carriage return
+        if (! line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+        int16_t fan_speed = -1;
+        if (line.size() > 3 && line.front() == 'M') {
+            fan_speed = get_fan_speed(std::string(line), m_writer.config.gcode_flavor);
+            if (fan_speed >= 0)
+                fan_speed = 100 * fan_speed / (m_writer.config.fan_percentage.value ? 100.0 : 255.0);
+        } else if (line.size() > 16 && line.front() == ';' && boost::starts_with(line, "; custom gcode")) {
+            m_is_custom_gcode = !boost::starts_with(line, "; custom gcode end");
+        }
+        if (fan_speed >= 0) {
+            // replaces the previous fan command if it was the previous line
+            m_pending_fan_line.assign(line);
+            m_pending_fan_speed = fan_speed;
+            // inside custom gcode, the fan commands are not merged with the next ones.
+            if (m_is_custom_gcode)
+                _write_pending_fan();
+        } else {
+            _write_pending_fan();
+            m_process_output.append(line);
+            m_process_output += '\n';
+        }
+        ptr = eol + 1;
+    }
+    if (flush)
+        _write_pending_fan();
+}
+
+void FanMover::_write_pending_fan()
+{
+    if (m_pending_fan_speed >= 0) {
+        if (m_pending_fan_speed != m_front_buffer_fan_speed) {
+            m_process_output += m_pending_fan_line;
+            m_process_output += '\n';
+            m_front_buffer_fan_speed = m_pending_fan_speed;
+        }
+        m_pending_fan_speed = -1;
+    }
+}
+
 void FanMover::_put_in_middle_G1(std::list<BufferData>::iterator item_to_split, float nb_sec_since_itemtosplit_start, BufferData &&line_to_write, float max_time) {
     assert(item_to_split != m_buffer.end());
     // if the fan is at the end of the g1 and the diff is less than 10% of the delay, then don't bother
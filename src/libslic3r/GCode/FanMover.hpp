@@ -40,6 +40,8 @@ private:
     const bool relative_e;
     const bool only_overhangs;
     const float kickstart; // in s
+    // Allow the line scan of _process_gcode_fan_only() when nothing has to be moved (disabled to test the buffered path).
+    const bool allow_fan_only_scan;
 
     GCodeReader m_parser{};
     const GCodeWriter& m_writer;
@@ -61,16 +63,20 @@ private:
     std::list<BufferData> m_buffer;
     double m_buffer_time_size = 0;
 
+    // Fan command held back by _process_gcode_fan_only(), as the next line may supersede it.
+    std::string m_pending_fan_line;
+    int16_t m_pending_fan_speed = -1;
+
     // The output of process_layer()
     std::string m_process_output;
 
 public:
     FanMover(const GCodeWriter& writer, const float nb_seconds_delay, const bool with_D_option, const bool relative_e,
-        const bool only_overhangs, const float kickstart)
+        const bool only_overhangs, const float kickstart, const bool allow_fan_only_scan = true)
         : regex_fan_speed("S[0-9]+"), 
         nb_seconds_delay(nb_seconds_delay>0 ? std::max(0.01f,nb_seconds_delay) : 0),
         with_D_option(with_D_option)
-        , relative_e(relative_e), only_overhangs(only_overhangs), kickstart(kickstart), m_writer(writer){}
+        , relative_e(relative_e), only_overhangs(only_overhangs), kickstart(kickstart), allow_fan_only_scan(allow_fan_only_scan), m_writer(writer){}
 
     // Adds the gcode contained in the given string to the analysis and returns it after removing the workcodes
     const std::string& process_gcode(const std::string& gcode, bool flush);
@@ -92,6 +98,9 @@ private:
         m_buffer_time_size -= data->time;
         return m_buffer.erase(data);
     }
+    // Without delay nor kickstart, nothing is moved: only the redundant fan commands are removed, without parsing the moves.
+    void _process_gcode_fan_only(const std::string& gcode, bool flush);
+    void _write_pending_fan();
     // Processes the given gcode line
     void _process_gcode_line(GCodeReader& reader, const GCodeReader::GCodeLine& line);
     void _process_ACTIVATE_EXTRUDER(const std::string_view command);
@@ -6,6 +6,7 @@
 #include "../Utils.hpp"
 
 #include <cctype> // isalpha
+#include <limits>
 #include <boost/algorithm/string/replace.hpp>
 
 namespace Slic3r {
@@ -42,7 +43,13 @@ GCodeFindReplace::GCodeFindReplace(const std::vector<std::string> &gcode_substit
             out.case_insensitive = strchr(params.c_str(), 'i') != nullptr || strchr(params.c_str(), 'I') != nullptr;
             out.whole_word       = strchr(params.c_str(), 'w') != nullptr || strchr(params.c_str(), 'W') != nullptr;
             out.single_line      = strchr(params.c_str(), 's') != nullptr || strchr(params.c_str(), 'S') != nullptr;
-            if (out.regexp) {
+            if (out.regexp && ! out.whole_word && ! out.plain_pattern.empty() &&
+                out.plain_pattern.find_first_of(".[]{}()\\*+?|^$") == std::string::npos &&
+                out.format.find_first_of("$\\()?:") == std::string::npos)
+                // Regular expression without any special character, process it as plain text to match it with the automaton.
+                // Whole word regular expressions are kept, as \b considers underscore a word character.
+                out.regexp = false;
+            else if (out.regexp) {
                 out.regexp_pattern.assign(
                     out.whole_word ? 
                         std::string("\\b") + out.plain_pattern + "\\b" :
@@ -57,6 +64,146 @@ GCodeFindReplace::GCodeFindReplace(const std::vector<std::string> &gcode_substit
         }
         m_substitutions.emplace_back(std::move(out));
     }
+
+    for (size_t i = 0; i < m_substitutions.size(); ++ i) {
+        if (const Substitution &substitution = m_substitutions[i];
+            ! substitution.regexp && substitution.whole_word && substitution.plain_pattern == substitution.format)
+            // Same as find_and_replace_whole_word(), replacing a whole word with itself is a no-op even if case insensitive.
+            continue;
+        if (m_passes.empty() || ! can_join_pass(m_passes.back(), m_substitutions[i]))
+            m_passes.emplace_back();
+        m_passes.back().substitutions.emplace_back(i);
+    }
+    for (Pass &pass : m_passes)
+        if (pass.substitutions.size() > 1)
+            build_automaton(pass);
+}
+
+static inline char fold_case(char c) { return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c; }
+
+static std::string fold_case(const std::string &s)
+{
+    std::string out(s);
+    for (char &c : out)
+        c = fold_case(c);
+    return out;
+}
+
+// Could two occurrences of a and b in a text share a character?
+static bool may_overlap(const std::string &a, const std::string &b)
+{
+    if (a.find(b) != std::string::npos || b.find(a) != std::string::npos)
+        return true;
+    for (size_t len = 1; len < std::min(a.size(), b.size()); ++ len)
+        if (a.compare(a.size() - len, len, b, 0, len) == 0 || b.compare(b.size() - len, len, a, 0, len) == 0)
+            return true;
+    return false;
+}
+
+static inline bool is_word_char(char c) { return std::isalnum(static_cast<unsigned char>(c)) != 0; }
+
+// Applying a plain substitution together with the preceding ones of the pass gives the same result as applying it after them
+// if its pattern could neither overlap their matches nor their replacements, and if the replacements do not change
+// the word boundaries seen by a whole word pattern. The comparisons are case insensitive to stay on the safe side.
+bool GCodeFindReplace::can_join_pass(const Pass &pass, const Substitution &substitution) const
+{
+    if (substitution.regexp || substitution.plain_pattern.empty())
+        return false;
+    const std::string pattern = fold_case(substitution.plain_pattern);
+    for (size_t idx : pass.substitutions) {
+        const Substitution &prev = m_substitutions[idx];
+        if (prev.regexp || prev.plain_pattern.empty() || prev.format.empty() ||
+            may_overlap(fold_case(prev.plain_pattern), pattern) || may_overlap(fold_case(prev.format), pattern))
+            return false;
+        if (substitution.whole_word &&
+            (is_word_char(prev.plain_pattern.front()) != is_word_char(prev.format.front()) ||
+             is_word_char(prev.plain_pattern.back()) != is_word_char(prev.format.back())))
+            return false;
+    }
+    return true;
+}
+
+void GCodeFindReplace::build_automaton(Pass &pass) const
+{
+    pass.char_class.fill(0);
+    pass.num_classes = 1;
+    for (size_t idx : pass.substitutions)
+        for (char c : m_substitutions[idx].plain_pattern) {
+            uint8_t &cls = pass.char_class[static_cast<unsigned char>(fold_case(c))];
+            if (cls == 0)
+                cls = uint8_t(pass.num_classes ++);
+        }
+    for (int c = 'A'; c <= 'Z'; ++ c)
+        pass.char_class[c] = pass.char_class[c - 'A' + 'a'];
+
+    // Build the trie of the patterns.
+    static constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+    pass.transitions.assign(pass.num_classes, none);
+    pass.state_substitution.assign(1, -1);
+    for (size_t i = 0; i < pass.substitutions.size(); ++ i) {
+        uint32_t state = 0;
+        for (char c : m_substitutions[pass.substitutions[i]].plain_pattern) {
+            const size_t transition = state * pass.num_classes + pass.char_class[static_cast<unsigned char>(c)];
+            if (pass.transitions[transition] == none) {
+                pass.transitions[transition] = uint32_t(pass.state_substitution.size());
+                pass.transitions.insert(pass.transitions.end(), pass.num_classes, none);
+                pass.state_substitution.emplace_back(-1);
+            }
+            state = pass.transitions[transition];
+        }
+        pass.state_substitution[state] = int(i);
+    }
+
+    // Turn the trie into a deterministic automaton following the failure links in breadth first order.
+    // The patterns of a pass never contain one another, thus no pattern is reported through a failure link.
+    std::vector<uint32_t> fail(pass.state_substitution.size(), 0);
+    std::vector<uint32_t> queue;
+    queue.reserve(pass.state_substitution.size());
+    queue.emplace_back(0);
+    for (size_t i = 0; i < queue.size(); ++ i) {
+        const uint32_t state = queue[i];
+        for (size_t cls = 0; cls < pass.num_classes; ++ cls) {
+            uint32_t &next = pass.transitions[state * pass.num_classes + cls];
+            const uint32_t fallback = state == 0 ? 0 : pass.transitions[fail[state] * pass.num_classes + cls];
+            if (next == none)
+                next = fallback;
+            else {
+                fail[next] = fallback;
+                queue.emplace_back(next);
+            }
+        }
+    }
+}
+
+void GCodeFindReplace::apply_automaton(const Pass &pass, const std::string &in, std::string &out) const
+{
+    out.clear();
+    // End of the text copied to out so far and end of the last match, the matches of a pattern do not overlap.
+    size_t   copied = 0;
+    size_t   last_match_end = 0;
+    uint32_t state  = 0;
+    for (size_t i = 0; i < in.size(); ++ i) {
+        state = pass.transitions[state * pass.num_classes + pass.char_class[static_cast<unsigned char>(in[i])]];
+        if (const int idx = pass.state_substitution[state]; idx >= 0) {
+            const Substitution &substitution = m_substitutions[pass.substitutions[idx]];
+            const size_t        end          = i + 1;
+            const size_t        start        = end - substitution.plain_pattern.size();
+            if (start < last_match_end ||
+                (! substitution.case_insensitive && in.compare(start, substitution.plain_pattern.size(), substitution.plain_pattern) != 0))
+                continue;
+            if (! substitution.whole_word ||
+                ((start == 0 || ! is_word_char(in[start - 1])) && (end == in.size() || ! is_word_char(in[end])))) {
+                if (copied == 0)
+                    out.reserve(in.size());
+                out.append(in, copied, start - copied);
+                out.append(substitution.format);
+                copied = end;
+            }
+            // Same as find_and_replace_whole_word(), a match failing the whole word test is skipped as well.
+            last_match_end = end;
+        }
+    }
+    out.append(in, copied, in.size() - copied);
 }
 
 class ToStringIterator 
@@ -109,14 +256,21 @@ static void find_and_replace_whole_word(std::string &inout, const std::string &m
     }
 }
 
-std::string GCodeFindReplace::process_layer(const std::string &ain)
+std::string GCodeFindReplace::process_layer(const std::string &ain) const
 {
     std::string out;
     const std::string *in = &ain;
     std::string temp;
     temp.reserve(in->size());
 
-    for (const Substitution &substitution : m_substitutions) {
+    for (const Pass &pass : m_passes) {
+        if (pass.substitutions.size() > 1) {
+            apply_automaton(pass, *in, temp);
+            std::swap(out, temp);
+            in = &out;
+            continue;
+        }
+        const Substitution &substitution = m_substitutions[pass.substitutions.front()];
         if (substitution.regexp) {
             temp.clear();
             temp.reserve(in->size());
@@ -154,6 +308,9 @@ std::string GCodeFindReplace::process_layer(const std::string &ain)
         in = &out;
     }
 
+    if (in == &ain)
+        // No substitution is active.
+        out = ain;
     return out;
 }
 
@@ -9,6 +9,8 @@
 
 #include <boost/regex.hpp>
 
+#include <array>
+
 namespace Slic3r {
 
 class GCodeFindReplace {
@@ -17,7 +19,9 @@ public:
     GCodeFindReplace(const std::vector<std::string> &gcode_substitutions);
 
 
-    std::string process_layer(const std::string &gcode);
+    // Thread safe, the substitutions are applied to the gcode passed in only,
+    // thus the layers may be processed in parallel.
+    std::string process_layer(const std::string &gcode) const;
     
 private:
     struct Substitution {
@@ -32,6 +36,28 @@ private:
         bool            single_line { false };
     };
     std::vector<Substitution> m_substitutions;
+
+    // The substitutions are applied one pass after the other. A pass is either a single substitution
+    // or a run of plain substitutions matched at once by an Aho-Corasick automaton, if applying them at once
+    // produces the same result as applying them one by one.
+    struct Pass {
+        // Indices into m_substitutions.
+        std::vector<size_t>         substitutions;
+        // The following is valid for a run of plain substitutions only.
+        // Characters are matched case insensitive, the case sensitive patterns are verified after matching.
+        // Class zero is assigned to characters not found in any pattern.
+        std::array<uint8_t, 256>    char_class;
+        size_t                      num_classes { 0 };
+        // Transitions of the automaton, num_classes per state.
+        std::vector<uint32_t>       transitions;
+        // Index into substitutions of the pattern ending at a state, -1 if none.
+        std::vector<int>            state_substitution;
+    };
+    std::vector<Pass>         m_passes;
+
+    bool can_join_pass(const Pass &pass, const Substitution &substitution) const;
+    void build_automaton(Pass &pass) const;
+    void apply_automaton(const Pass &pass, const std::string &in, std::string &out) const;
 };
 
 }
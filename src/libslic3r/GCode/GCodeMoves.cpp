@@ -0,0 +1,129 @@
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#include "GCodeMoves.hpp"
+
+namespace Slic3r {
+
+void GCodeMoves::push_back(const GCodeMoveVertex &move)
+{
+    assert(uint8_t(move.type) <= TypeMask);
+    m_gcode_id.emplace_back(move.gcode_id);
+    m_type.emplace_back(uint8_t(move.type) | (move.internal_only ? InternalOnlyFlag : 0));
+    m_extrusion_role.emplace_back(move.extrusion_role);
+    m_extruder_id.push_back(move.extruder_id);
+    m_cp_color_id.push_back(move.cp_color_id);
+    m_object_id.push_back(move.object_id);
+    m_position.push_back(move.position);
+    m_delta_extruder.emplace_back(move.delta_extruder);
+    m_feedrate.emplace_back(move.feedrate);
+    m_width.emplace_back(quantize_size(move.width));
+    m_height.emplace_back(quantize_size(move.height));
+    m_mm3_per_mm.emplace_back(move.mm3_per_mm);
+    m_fan_speed.push_back(move.fan_speed);
+    m_temperature.push_back(move.temperature);
+    m_move_time.emplace_back(move.move_time);
+    m_layer_id.push_back(move.layer_id);
+}
+
+GCodeMoveVertex GCodeMoves::get(size_t idx, RunHints &hints) const
+{
+    assert(idx < this->size());
+    GCodeMoveVertex out;
+    out.gcode_id       = m_gcode_id[idx];
+    out.type           = this->type(idx);
+    out.internal_only  = this->internal_only(idx);
+    out.extrusion_role = m_extrusion_role[idx];
+    out.extruder_id    = m_extruder_id.get(idx, hints[0]);
+    out.cp_color_id    = m_cp_color_id.get(idx, hints[1]);
+    out.object_id      = m_object_id.get(idx, hints[2]);
+    out.position       = m_position.get(idx);
+    out.delta_extruder = m_delta_extruder[idx];
+    out.feedrate       = m_feedrate[idx];
+    out.width          = dequantize_size(m_width[idx]);
+    out.height         = dequantize_size(m_height[idx]);
+    out.mm3_per_mm     = m_mm3_per_mm[idx];
+    out.fan_speed      = m_fan_speed.get(idx, hints[3]);
+    out.temperature    = m_temperature.get(idx, hints[4]);
+    out.move_time      = m_move_time[idx];
+    out.layer_id       = m_layer_id.get(idx, hints[5]);
+    return out;
+}
+
+void GCodeMoves::erase(size_t idx)
+{
+    assert(idx < this->size());
+    // The run length and offset encoded columns cannot be shifted in place, decode the moves following idx and append them again.
+    std::vector<GCodeMoveVertex> tail;
+    tail.reserve(this->size() - idx - 1);
+    for (const_iterator it = this->begin() + idx + 1; it != this->end(); ++ it)
+        tail.emplace_back(*it);
+    m_gcode_id.resize(idx);
+    m_type.resize(idx);
+    m_extrusion_role.resize(idx);
+    m_extruder_id.truncate(idx);
+    m_cp_color_id.truncate(idx);
+    m_object_id.truncate(idx);
+    m_position.truncate(idx);
+    m_delta_extruder.resize(idx);
+    m_feedrate.resize(idx);
+    m_width.resize(idx);
+    m_height.resize(idx);
+    m_mm3_per_mm.resize(idx);
+    m_fan_speed.truncate(idx);
+    m_temperature.truncate(idx);
+    m_move_time.resize(idx);
+    m_layer_id.truncate(idx);
+    for (const GCodeMoveVertex &move : tail)
+        this->push_back(move);
+}
+
+void GCodeMoves::clear()
+{
+    m_gcode_id.clear();
+    m_type.clear();
+    m_extrusion_role.clear();
+    m_extruder_id.clear();
+    m_cp_color_id.clear();
+    m_object_id.clear();
+    m_position.clear();
+    m_delta_extruder.clear();
+    m_feedrate.clear();
+    m_width.clear();
+    m_height.clear();
+    m_mm3_per_mm.clear();
+    m_fan_speed.clear();
+    m_temperature.clear();
+    m_move_time.clear();
+    m_layer_id.clear();
+}
+
+void GCodeMoves::shrink_to_fit()
+{
+    m_gcode_id.shrink_to_fit();
+    m_type.shrink_to_fit();
+    m_extrusion_role.shrink_to_fit();
+    m_extruder_id.shrink_to_fit();
+    m_cp_color_id.shrink_to_fit();
+    m_object_id.shrink_to_fit();
+    m_position.shrink_to_fit();
+    m_delta_extruder.shrink_to_fit();
+    m_feedrate.shrink_to_fit();
+    m_width.shrink_to_fit();
+    m_height.shrink_to_fit();
+    m_mm3_per_mm.shrink_to_fit();
+    m_fan_speed.shrink_to_fit();
+    m_temperature.shrink_to_fit();
+    m_move_time.shrink_to_fit();
+    m_layer_id.shrink_to_fit();
+}
+
+size_t GCodeMoves::memsize() const
+{
+    return m_gcode_id.capacity() * sizeof(uint32_t) + m_type.capacity() * sizeof(uint8_t) +
+        m_extrusion_role.capacity() * sizeof(GCodeExtrusionRole) + m_extruder_id.memsize() + m_cp_color_id.memsize() +
+        m_object_id.memsize() + m_position.memsize() + m_delta_extruder.capacity() * sizeof(float) + m_feedrate.capacity() * sizeof(float) +
+        m_width.capacity() * sizeof(uint16_t) + m_height.capacity() * sizeof(uint16_t) + m_mm3_per_mm.capacity() * sizeof(float) +
+        m_fan_speed.memsize() + m_temperature.memsize() + m_move_time.capacity() * sizeof(float) + m_layer_id.memsize();
+}
+
+} // namespace Slic3r
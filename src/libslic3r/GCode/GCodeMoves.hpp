@@ -0,0 +1,314 @@
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#ifndef slic3r_GCodeMoves_hpp_
+#define slic3r_GCodeMoves_hpp_
+
+#include "libslic3r/Point.hpp"
+#include "libslic3r/ExtrusionRole.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace Slic3r {
+
+    enum class EMoveType : unsigned char
+    {
+        Noop,
+        Retract,
+        Unretract,
+        Seam,
+        Tool_change,
+        Color_change,
+        Pause_Print,
+        Custom_GCode,
+        Travel,
+        Wipe,
+        Extrude,
+        Count
+    };
+
+    struct GCodeMoveVertex
+    {
+        GCodeMoveVertex() {}
+        GCodeMoveVertex(uint32_t gcode_id, EMoveType type, GCodeExtrusionRole extrusion_role, uint8_t extruder_id,
+            uint8_t cp_color_id, uint16_t object_id, Vec3f position, float delta_extruder, float feedrate, float width, float height,
+            float mm3_per_mm, float fan_speed, float temperature, float time, uint16_t layer_id,
+            bool internal_only) :
+            gcode_id(gcode_id), type(type), extrusion_role(extrusion_role), extruder_id(extruder_id),
+            cp_color_id(cp_color_id), object_id(object_id), position(position), delta_extruder(delta_extruder), feedrate(feedrate),
+            width(width), height(height), mm3_per_mm(mm3_per_mm), fan_speed(fan_speed),
+            temperature(temperature), move_time(time), layer_id(layer_id),
+            internal_only(internal_only) {
+        }
+
+        uint32_t gcode_id{ 0 };
+        EMoveType type{ EMoveType::Noop };
+        GCodeExtrusionRole extrusion_role{ GCodeExtrusionRole::None };
+        uint8_t extruder_id{ 0 };
+        uint8_t cp_color_id{ 0 };
+        uint16_t object_id{ 0 };
+        Vec3f position{ Vec3f::Zero() }; // mm
+        float delta_extruder{ 0.0f }; // mm
+        float feedrate{ 0.0f }; // mm/s
+        float width{ 0.0f }; // mm
+        float height{ 0.0f }; // mm
+        float mm3_per_mm{ 0.0f };
+        float fan_speed{ 0.0f }; // percentage
+        float temperature{ 0.0f }; // Celsius degrees
+        float move_time{ 0.0f }; // s (TODO: for each mode (silent or not) )
+        uint16_t layer_id{ 0 };
+        bool internal_only{ false };
+
+        float volumetric_rate() const { return feedrate * mm3_per_mm; }
+    };
+
+    // Column of values, which change rarely from one move to the next, stored as runs of equal values.
+    template<typename T>
+    class GCodeMovesRLEColumn
+    {
+    public:
+        size_t size() const { return m_size; }
+
+        void push_back(T value) {
+            if (m_values.empty() || m_values.back() != value) {
+                m_starts.emplace_back(uint32_t(m_size));
+                m_values.emplace_back(value);
+            }
+            ++ m_size;
+        }
+
+        // Index of the run containing idx. The hint is the run of a neighbor index, typically the previous one,
+        // which makes a sequential scan run in constant time.
+        size_t run(size_t idx, size_t hint) const {
+            assert(idx < m_size);
+            if (hint < m_starts.size() && m_starts[hint] <= idx) {
+                if (hint + 1 == m_starts.size() || idx < m_starts[hint + 1])
+                    return hint;
+                if (hint + 2 == m_starts.size() || idx < m_starts[hint + 2])
+                    return hint + 1;
+            }
+            return std::upper_bound(m_starts.begin(), m_starts.end(), uint32_t(idx)) - m_starts.begin() - 1;
+        }
+
+        T get(size_t idx) const { return m_values[this->run(idx, 0)]; }
+        T get(size_t idx, size_t &hint) const { hint = this->run(idx, hint); return m_values[hint]; }
+
+        // Keep the first size values.
+        void truncate(size_t size) {
+            assert(size <= m_size);
+            const size_t num_runs = std::lower_bound(m_starts.begin(), m_starts.end(), uint32_t(size)) - m_starts.begin();
+            m_starts.erase(m_starts.begin() + num_runs, m_starts.end());
+            m_values.erase(m_values.begin() + num_runs, m_values.end());
+            m_size = size;
+        }
+        void clear() { m_starts.clear(); m_values.clear(); m_size = 0; }
+        void shrink_to_fit() { m_starts.shrink_to_fit(); m_values.shrink_to_fit(); }
+        size_t memsize() const { return m_starts.capacity() * sizeof(uint32_t) + m_values.capacity() * sizeof(T); }
+
+    private:
+        // Index of the first value of each run.
+        std::vector<uint32_t> m_starts;
+        std::vector<T>        m_values;
+        size_t                m_size { 0 };
+    };
+
+    // Positions quantized to a micrometer grid. The positions are stored in blocks of a fixed size, the first position
+    // of a block is stored as is, the other positions as 16 bit offsets from the first one. Positions too far
+    // from the first position of their block are stored as is into a sorted list of exceptions.
+    class GCodeMovesPositionColumn
+    {
+    public:
+        size_t size() const { return m_offsets.size(); }
+
+        void push_back(const Vec3f &position) {
+            const Vec3i32 q = quantize(position);
+            if (m_offsets.size() % BlockSize == 0) {
+                m_anchors.emplace_back(q);
+                m_offsets.push_back({ 0, 0, 0 });
+                return;
+            }
+            const Vec3i32 d = q - m_anchors.back();
+            if (is_offset(d.x()) && is_offset(d.y()) && is_offset(d.z()))
+                m_offsets.push_back({ int16_t(d.x()), int16_t(d.y()), int16_t(d.z()) });
+            else {
+                m_exceptions.emplace_back(uint32_t(m_offsets.size()), q);
+                m_offsets.push_back({ Exception, 0, 0 });
+            }
+        }
+
+        Vec3f get(size_t idx) const {
+            const std::array<int16_t, 3> &offset = m_offsets[idx];
+            if (offset[0] == Exception)
+                return dequantize(std::lower_bound(m_exceptions.begin(), m_exceptions.end(), uint32_t(idx),
+                    [](const std::pair<uint32_t, Vec3i32> &l, uint32_t r) { return l.first < r; })->second);
+            const Vec3i32 &anchor = m_anchors[idx / BlockSize];
+            return dequantize(Vec3i32(anchor.x() + offset[0], anchor.y() + offset[1], anchor.z() + offset[2]));
+        }
+
+        // Keep the first size positions.
+        void truncate(size_t size) {
+            assert(size <= m_offsets.size());
+            m_offsets.erase(m_offsets.begin() + size, m_offsets.end());
+            m_anchors.erase(m_anchors.begin() + (size + BlockSize - 1) / BlockSize, m_anchors.end());
+            m_exceptions.erase(std::lower_bound(m_exceptions.begin(), m_exceptions.end(), uint32_t(size),
+                [](const std::pair<uint32_t, Vec3i32> &l, uint32_t r) { return l.first < r; }), m_exceptions.end());
+        }
+        void clear() { m_anchors.clear(); m_offsets.clear(); m_exceptions.clear(); }
+        void shrink_to_fit() { m_anchors.shrink_to_fit(); m_offsets.shrink_to_fit(); m_exceptions.shrink_to_fit(); }
+        size_t memsize() const {
+            return m_anchors.capacity() * sizeof(Vec3i32) + m_offsets.capacity() * sizeof(std::array<int16_t, 3>) +
+                   m_exceptions.capacity() * sizeof(std::pair<uint32_t, Vec3i32>);
+        }
+
+        // Grid of the quantized positions, mm.
+        static constexpr const double Resolution = 0.001;
+
+    private:
+        static constexpr const size_t  BlockSize = 64;
+        static constexpr const int16_t Exception = std::numeric_limits<int16_t>::min();
+
+        static bool    is_offset(int32_t d) { return d > int32_t(Exception) && d <= int32_t(std::numeric_limits<int16_t>::max()); }
+        static Vec3i32 quantize(const Vec3f &p) { return (p.cast<double>() / Resolution).array().round().cast<int32_t>().matrix(); }
+        static Vec3f   dequantize(const Vec3i32 &q) { return (q.cast<double>() * Resolution).cast<float>(); }
+
+        std::vector<Vec3i32>                      m_anchors;
+        std::vector<std::array<int16_t, 3>>       m_offsets;
+        std::vector<std::pair<uint32_t, Vec3i32>> m_exceptions;
+    };
+
+    // Moves of the processed G-code stored column by column, each column at the width it needs:
+    // positions as offsets to a micrometer grid, widths and heights as micrometers, the attributes
+    // which change rarely (extruder, color, object, layer, fan speed and temperature) run length encoded.
+    // The moves are returned by value, the single columns may be accessed by their index to avoid decoding
+    // the columns which are not needed.
+    class GCodeMoves
+    {
+        // Hints of the runs of the run length encoded columns, see GCodeMovesRLEColumn::run().
+        using RunHints = std::array<size_t, 6>;
+
+    public:
+        using value_type = GCodeMoveVertex;
+
+        class const_iterator
+        {
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type        = GCodeMoveVertex;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = void;
+            using reference         = GCodeMoveVertex;
+
+            const_iterator() = default;
+            const_iterator(const GCodeMoves *moves, size_t idx) : m_moves(moves), m_idx(idx) {}
+
+            GCodeMoveVertex  operator*() const { return m_moves->get(m_idx, m_hints); }
+            GCodeMoveVertex  operator[](difference_type n) const { return m_moves->get(m_idx + n, m_hints); }
+            size_t           index() const { return m_idx; }
+
+            const_iterator&  operator++() { ++ m_idx; return *this; }
+            const_iterator   operator++(int) { const_iterator out(*this); ++ m_idx; return out; }
+            const_iterator&  operator--() { -- m_idx; return *this; }
+            const_iterator   operator--(int) { const_iterator out(*this); -- m_idx; return out; }
+            const_iterator&  operator+=(difference_type n) { m_idx += n; return *this; }
+            const_iterator&  operator-=(difference_type n) { m_idx -= n; return *this; }
+            const_iterator   operator+(difference_type n) const { const_iterator out(*this); out.m_idx += n; return out; }
+            const_iterator   operator-(difference_type n) const { const_iterator out(*this); out.m_idx -= n; return out; }
+            friend const_iterator operator+(difference_type n, const const_iterator &it) { return it + n; }
+            difference_type  operator-(const const_iterator &rhs) const { return difference_type(m_idx) - difference_type(rhs.m_idx); }
+
+            bool operator==(const const_iterator &rhs) const { return m_idx == rhs.m_idx; }
+            bool operator!=(const const_iterator &rhs) const { return m_idx != rhs.m_idx; }
+            bool operator< (const const_iterator &rhs) const { return m_idx <  rhs.m_idx; }
+            bool operator> (const const_iterator &rhs) const { return m_idx >  rhs.m_idx; }
+            bool operator<=(const const_iterator &rhs) const { return m_idx <= rhs.m_idx; }
+            bool operator>=(const const_iterator &rhs) const { return m_idx >= rhs.m_idx; }
+
+        private:
+            const GCodeMoves *m_moves { nullptr };
+            size_t            m_idx   { 0 };
+            mutable RunHints  m_hints {};
+        };
+        using iterator = const_iterator;
+
+        size_t          size() const { return m_gcode_id.size(); }
+        bool            empty() const { return m_gcode_id.empty(); }
+        const_iterator  begin() const { return { this, 0 }; }
+        const_iterator  end() const { return { this, this->size() }; }
+
+        GCodeMoveVertex operator[](size_t idx) const { RunHints hints {}; return this->get(idx, hints); }
+        GCodeMoveVertex back() const { assert(! this->empty()); return (*this)[this->size() - 1]; }
+
+        void            push_back(const GCodeMoveVertex &move);
+        template<typename... Args>
+        void            emplace_back(Args&&... args) { this->push_back(GCodeMoveVertex(std::forward<Args>(args)...)); }
+        // Linear in the number of moves following idx.
+        void            erase(size_t idx);
+        void            clear();
+        void            shrink_to_fit();
+        // Memory allocated by the columns, in bytes.
+        size_t          memsize() const;
+
+        // Access to the individual columns.
+        uint32_t           gcode_id(size_t idx) const       { return m_gcode_id[idx]; }
+        EMoveType          type(size_t idx) const           { return EMoveType(m_type[idx] & TypeMask); }
+        bool               internal_only(size_t idx) const  { return (m_type[idx] & InternalOnlyFlag) != 0; }
+        GCodeExtrusionRole extrusion_role(size_t idx) const { return m_extrusion_role[idx]; }
+        uint8_t            extruder_id(size_t idx) const    { return m_extruder_id.get(idx); }
+        uint8_t            cp_color_id(size_t idx) const    { return m_cp_color_id.get(idx); }
+        uint16_t           object_id(size_t idx) const      { return m_object_id.get(idx); }
+        Vec3f              position(size_t idx) const       { return m_position.get(idx); }
+        float              delta_extruder(size_t idx) const { return m_delta_extruder[idx]; }
+        float              feedrate(size_t idx) const       { return m_feedrate[idx]; }
+        float              width(size_t idx) const          { return dequantize_size(m_width[idx]); }
+        float              height(size_t idx) const         { return dequantize_size(m_height[idx]); }
+        float              mm3_per_mm(size_t idx) const     { return m_mm3_per_mm[idx]; }
+        float              fan_speed(size_t idx) const      { return m_fan_speed.get(idx); }
+        float              temperature(size_t idx) const    { return m_temperature.get(idx); }
+        float              move_time(size_t idx) const      { return m_move_time[idx]; }
+        uint16_t           layer_id(size_t idx) const       { return m_layer_id.get(idx); }
+
+        // The columns updated after the moves were stored.
+        void set_gcode_id(size_t idx, uint32_t gcode_id) { m_gcode_id[idx] = gcode_id; }
+        void set_move_time(size_t idx, float time)       { m_move_time[idx] = time; }
+        void set_width(size_t idx, float width)          { m_width[idx] = quantize_size(width); }
+        void set_height(size_t idx, float height)        { m_height[idx] = quantize_size(height); }
+
+    private:
+        static constexpr const uint8_t TypeMask         = 0x7f;
+        static constexpr const uint8_t InternalOnlyFlag = 0x80;
+
+        // Widths and heights are stored in micrometers.
+        static uint16_t quantize_size(float v) { return uint16_t(std::clamp<float>(std::round(v * 1000.f), 0.f, float(std::numeric_limits<uint16_t>::max()))); }
+        static float    dequantize_size(uint16_t v) { return float(double(v) * 0.001); }
+
+        GCodeMoveVertex get(size_t idx, RunHints &hints) const;
+
+        std::vector<uint32_t>               m_gcode_id;
+        // EMoveType and the internal_only flag.
+        std::vector<uint8_t>                m_type;
+        std::vector<GCodeExtrusionRole>     m_extrusion_role;
+        GCodeMovesRLEColumn<uint8_t>        m_extruder_id;
+        GCodeMovesRLEColumn<uint8_t>        m_cp_color_id;
+        GCodeMovesRLEColumn<uint16_t>       m_object_id;
+        GCodeMovesPositionColumn            m_position;
+        std::vector<float>                  m_delta_extruder;
+        std::vector<float>                  m_feedrate;
+        std::vector<uint16_t>               m_width;
+        std::vector<uint16_t>               m_height;
+        std::vector<float>                  m_mm3_per_mm;
+        GCodeMovesRLEColumn<float>          m_fan_speed;
+        GCodeMovesRLEColumn<float>          m_temperature;
+        std::vector<float>                  m_move_time;
+        GCodeMovesRLEColumn<uint16_t>       m_layer_id;
+    };
+
+} // namespace Slic3r
+
+#endif /* slic3r_GCodeMoves_hpp_ */
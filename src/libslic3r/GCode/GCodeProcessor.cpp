@@ -233,7 +233,7 @@ void GCodeProcessor::TimeMachine::reset()
     layers_time = std::vector<float>();
 }
 
-void GCodeProcessor::TimeMachine::simulate_st_synchronize_call(std::vector<GCodeProcessorResult::MoveVertex> &moves, float additional_time)
+void GCodeProcessor::TimeMachine::simulate_st_synchronize_call(GCodeMoves &moves, float additional_time)
 {
     if (!enabled)
         return;
@@ -311,7 +311,7 @@ static void recalculate_trapezoids(std::vector<GCodeProcessor::TimeBlock>& block
     }
 }
 
-void GCodeProcessor::TimeMachine::calculate_time(std::vector<GCodeProcessorResult::MoveVertex> &moves, size_t keep_last_n_blocks, float additional_time)
+void GCodeProcessor::TimeMachine::calculate_time(GCodeMoves &moves, size_t keep_last_n_blocks, float additional_time)
 {
     if (!enabled || blocks.size() < 2)
         return;
@@ -361,7 +361,7 @@ void GCodeProcessor::TimeMachine::calculate_time(std::vector<GCodeProcessorResul
         //update moves
         for (size_t idx : block.moves) {
             assert(moves.size() > idx);
-            moves[idx].move_time = time;
+            moves.set_move_time(idx, time);
         }
 
     }
@@ -483,7 +483,7 @@ void GCodeProcessor::UsedFilaments::process_caches(const GCodeProcessor* process
 
 #if ENABLE_GCODE_VIEWER_STATISTICS
 void GCodeProcessorResult::reset() {
-    moves = std::vector<GCodeProcessorResult::MoveVertex>();
+    moves = GCodeMoves();
     bed_shape = Pointfs();
     max_print_height = 0.0f;
     z_offset = 0.0f;
@@ -1448,10 +1448,10 @@ void GCodeProcessor::finalize(bool perform_post_process)
     m_result.z_offset = m_z_offset;
 
     // update width/height of wipe moves
-    for (GCodeProcessorResult::MoveVertex& move : m_result.moves) {
-        if (move.type == EMoveType::Wipe) {
-            move.width = Wipe_Width;
-            move.height = Wipe_Height;
+    for (size_t i = 0; i < m_result.moves.size(); ++ i) {
+        if (m_result.moves.type(i) == EMoveType::Wipe) {
+            m_result.moves.set_width(i, Wipe_Width);
+            m_result.moves.set_height(i, Wipe_Height);
         }
     }
 
@@ -3177,7 +3177,7 @@ void GCodeProcessor::process_G1(const std::array<std::optional<double>, 4>& axes
     } else if (m_seams_detector.is_active()) {
         // check for seam starting vertex
         if (type == EMoveType::Extrude && m_extrusion_role == GCodeExtrusionRole::ExternalPerimeter && !m_seams_detector.has_first_vertex())
-            m_seams_detector.set_first_vertex(m_result.moves.back().position - m_extruder_offsets[m_extruder_id]);
+            m_seams_detector.set_first_vertex(m_result.moves.position(m_result.moves.size() - 1) - m_extruder_offsets[m_extruder_id]);
         // check for seam ending vertex and store the resulting move
         else if ((type != EMoveType::Extrude || (m_extrusion_role != GCodeExtrusionRole::ExternalPerimeter && m_extrusion_role != GCodeExtrusionRole::OverhangPerimeter)) && m_seams_detector.has_first_vertex()) {
             auto set_end_position = [this](const Vec3f& pos) {
@@ -3185,7 +3185,7 @@ void GCodeProcessor::process_G1(const std::array<std::optional<double>, 4>& axes
             };
 
             const Vec3f curr_pos(m_end_position[X], m_end_position[Y], m_end_position[Z]);
-            const Vec3f new_pos = m_result.moves.back().position - m_extruder_offsets[m_extruder_id];
+            const Vec3f new_pos = m_result.moves.position(m_result.moves.size() - 1) - m_extruder_offsets[m_extruder_id];
             const std::optional<Vec3f> first_vertex = m_seams_detector.get_first_vertex();
             // the threshold value = 0.0625f == 0.25 * 0.25 is arbitrary, we may find some smarter condition later
 
@@ -3199,7 +3199,7 @@ void GCodeProcessor::process_G1(const std::array<std::optional<double>, 4>& axes
         }
     } else if (type == EMoveType::Extrude && m_extrusion_role == GCodeExtrusionRole::ExternalPerimeter) {
         m_seams_detector.activate(true);
-        m_seams_detector.set_first_vertex(m_result.moves.back().position - m_extruder_offsets[m_extruder_id]);
+        m_seams_detector.set_first_vertex(m_result.moves.position(m_result.moves.size() - 1) - m_extruder_offsets[m_extruder_id]);
     }
 
     if (m_spiral_vase_active && !m_result.spiral_vase_layers.empty()) {
@@ -4498,12 +4498,13 @@ void GCodeProcessor::post_process()
 
         void synchronize_moves(GCodeProcessorResult& result) const {
             auto it = m_gcode_lines_map.begin();
-            for (GCodeProcessorResult::MoveVertex& move : result.moves) {
-                while (it != m_gcode_lines_map.end() && it->first < move.gcode_id) {
+            for (size_t i = 0; i < result.moves.size(); ++ i) {
+                const uint32_t gcode_id = result.moves.gcode_id(i);
+                while (it != m_gcode_lines_map.end() && it->first < gcode_id) {
                     ++it;
                 }
-                if (it != m_gcode_lines_map.end() && it->first == move.gcode_id)
-                    move.gcode_id = it->second;
+                if (it != m_gcode_lines_map.end() && it->first == gcode_id)
+                    result.moves.set_gcode_id(i, it->second);
             }
         }
 
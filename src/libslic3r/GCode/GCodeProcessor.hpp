@@ -13,6 +13,7 @@
 #include "libslic3r/ExtrusionRole.hpp"
 #include "libslic3r/PrintConfig.hpp"
 #include "libslic3r/CustomGCode.hpp"
+#include "libslic3r/GCode/GCodeMoves.hpp"
 
 #include <LibBGCode/binarize/binarize.hpp>
 
@@ -27,22 +28,6 @@
 namespace Slic3r {
     //class StatusMonitor;
 
-    enum class EMoveType : unsigned char
-    {
-        Noop,
-        Retract,
-        Unretract,
-        Seam,
-        Tool_change,
-        Color_change,
-        Pause_Print,
-        Custom_GCode,
-        Travel,
-        Wipe,
-        Extrude,
-        Count
-    };
-
     struct PrintEstimatedStatistics
     {
         enum class ETimeMode : unsigned char
@@ -113,45 +98,13 @@ namespace Slic3r {
             }
         };
 
-        struct MoveVertex
-        {
-            MoveVertex() {}
-            MoveVertex(uint32_t gcode_id, EMoveType type, GCodeExtrusionRole extrusion_role, uint8_t extruder_id,
-                uint8_t cp_color_id, uint16_t object_id, Vec3f position, float delta_extruder, float feedrate, float width, float height,
-                float mm3_per_mm, float fan_speed, float temperature, float time, uint16_t layer_id,
-                bool internal_only) :
-                gcode_id(gcode_id), type(type), extrusion_role(extrusion_role), extruder_id(extruder_id), 
-                cp_color_id(cp_color_id), object_id(object_id), position(position), delta_extruder(delta_extruder), feedrate(feedrate), 
-                width(width), height(height), mm3_per_mm(mm3_per_mm), fan_speed(fan_speed), 
-                temperature(temperature), move_time(time), layer_id(layer_id),
-                internal_only(internal_only) {
-            }
-
-            uint32_t gcode_id{ 0 };
-            EMoveType type{ EMoveType::Noop };
-            GCodeExtrusionRole extrusion_role{ GCodeExtrusionRole::None };
-            uint8_t extruder_id{ 0 };
-            uint8_t cp_color_id{ 0 };
-            uint16_t object_id{ 0 };
-            Vec3f position{ Vec3f::Zero() }; // mm
-            float delta_extruder{ 0.0f }; // mm
-            float feedrate{ 0.0f }; // mm/s
-            float width{ 0.0f }; // mm
-            float height{ 0.0f }; // mm
-            float mm3_per_mm{ 0.0f };
-            float fan_speed{ 0.0f }; // percentage
-            float temperature{ 0.0f }; // Celsius degrees
-            float move_time{ 0.0f }; // s (TODO: for each mode (silent or not) )
-            uint16_t layer_id{ 0 };
-            bool internal_only{ false };
-
-            float volumetric_rate() const { return feedrate * mm3_per_mm; }
-        };
+        using MoveVertex = GCodeMoveVertex;
 
         std::string filename;
         bool is_binary_file;
         unsigned int id;
-        std::vector<MoveVertex> moves;
+        // Stored column by column, see GCodeMoves.
+        GCodeMoves moves;
         // Positions of ends of lines of the final G-code this->filename after TimeProcessor::post_process() finalizes the G-code.
         // Binarized gcodes usually have several gcode blocks. Each block has its own list on ends of lines.
         // Ascii gcodes have only one list on ends of lines
@@ -370,8 +323,8 @@ namespace Slic3r {
             void reset();
 
             // Simulates firmware st_synchronize() call
-            void simulate_st_synchronize_call(std::vector<GCodeProcessorResult::MoveVertex> &moves, float additional_time = 0.0f);
-            void calculate_time(std::vector<GCodeProcessorResult::MoveVertex> &moves, size_t keep_last_n_blocks = 0, float additional_time = 0.0f);
+            void simulate_st_synchronize_call(GCodeMoves &moves, float additional_time = 0.0f);
+            void calculate_time(GCodeMoves &moves, size_t keep_last_n_blocks = 0, float additional_time = 0.0f);
         };
 
         struct TimeProcessor
@@ -484,12 +437,13 @@ namespace Slic3r {
                 if (!m_move_id.has_value() || !m_custom_gcode_per_print_z_id.has_value())
                     return;
 
-                const Vec3f position = m_result.moves.back().position;
+                const Vec3f position = m_result.moves.position(m_result.moves.size() - 1);
 
-                GCodeProcessorResult::MoveVertex& move = m_result.moves.emplace_back(m_result.moves[*m_move_id]);
+                GCodeProcessorResult::MoveVertex move = m_result.moves[*m_move_id];
                 move.position = position;
                 move.height = height;
-                m_result.moves.erase(m_result.moves.begin() + *m_move_id);
+                m_result.moves.push_back(move);
+                m_result.moves.erase(*m_move_id);
                 m_result.custom_gcode_per_print_z[*m_custom_gcode_per_print_z_id].print_z = position.z();
                 reset();
             }
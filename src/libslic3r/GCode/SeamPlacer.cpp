@@ -13,6 +13,7 @@
 #include "tbb/parallel_reduce.h"
 #include <boost/log/trivial.hpp>
 #include <algorithm>
+#include <mutex>
 #include <queue>
 #include <random>
 #include <tuple>
@@ -48,6 +49,11 @@ namespace SeamPlacerImpl {
 // cache for seam modifier
 std::map<ModelVolume*, BoundingBoxf3> cache_volume_to_bb;
 
+struct GlobalOcclusionInfo;
+// cache for the occlusion of the objects exported last time, indexed by global_occlusion_key()
+std::map<std::string, std::shared_ptr<const GlobalOcclusionInfo>> cache_occlusion;
+std::mutex cache_occlusion_mutex;
+
 template<typename T> int sgn(T val) {
     return int(T(0) < val) - int(val < T(0));
 }
@@ -336,39 +342,14 @@ struct CoordinateFunctor {
     }
 };
 
-// structure to store global information about the model - occlusion hits, enforcers, blockers
-struct GlobalModelInfo {
+// visibility of the model surface computed by raycasting, shared by the objects with the same meshes, see compute_global_occlusion()
+struct GlobalOcclusionInfo {
     TriangleSetSamples mesh_samples;
     std::vector<float> mesh_samples_visibility;
     CoordinateFunctor mesh_samples_coordinate_functor;
     KDTreeIndirect<3, float, CoordinateFunctor> mesh_samples_tree { CoordinateFunctor { } };
     float mesh_samples_radius;
 
-    indexed_triangle_set enforcers;
-    indexed_triangle_set blockers;
-    AABBTreeIndirect::Tree<3, float> enforcers_tree;
-    AABBTreeIndirect::Tree<3, float> blockers_tree;
-
-    bool has_custom_seam_modifier{ false };
-
-    bool is_enforced(const Vec3f &position, float radius) const {
-        if (enforcers.empty()) {
-            return false;
-        }
-        float radius_sqr = radius * radius;
-        return AABBTreeIndirect::is_any_triangle_in_radius(enforcers.vertices, enforcers.indices,
-                enforcers_tree, position, radius_sqr);
-    }
-
-    bool is_blocked(const Vec3f &position, float radius) const {
-        if (blockers.empty()) {
-            return false;
-        }
-        float radius_sqr = radius * radius;
-        return AABBTreeIndirect::is_any_triangle_in_radius(blockers.vertices, blockers.indices,
-                blockers_tree, position, radius_sqr);
-    }
-
     float calculate_point_visibility(const Vec3f &position) const {
         std::vector<size_t> points = find_nearby_points(mesh_samples_tree, position, mesh_samples_radius);
         if (points.empty()) {
@@ -447,8 +428,42 @@ struct GlobalModelInfo {
 
     }
 #endif
-}
-;
+};
+
+// structure to store global information about the model - occlusion hits, enforcers, blockers
+struct GlobalModelInfo {
+    std::shared_ptr<const GlobalOcclusionInfo> occlusion;
+
+    indexed_triangle_set enforcers;
+    indexed_triangle_set blockers;
+    AABBTreeIndirect::Tree<3, float> enforcers_tree;
+    AABBTreeIndirect::Tree<3, float> blockers_tree;
+
+    bool has_custom_seam_modifier{ false };
+
+    bool is_enforced(const Vec3f &position, float radius) const {
+        if (enforcers.empty()) {
+            return false;
+        }
+        float radius_sqr = radius * radius;
+        return AABBTreeIndirect::is_any_triangle_in_radius(enforcers.vertices, enforcers.indices,
+                enforcers_tree, position, radius_sqr);
+    }
+
+    bool is_blocked(const Vec3f &position, float radius) const {
+        if (blockers.empty()) {
+            return false;
+        }
+        float radius_sqr = radius * radius;
+        return AABBTreeIndirect::is_any_triangle_in_radius(blockers.vertices, blockers.indices,
+                blockers_tree, position, radius_sqr);
+    }
+
+    float calculate_point_visibility(const Vec3f &position) const {
+        return occlusion->calculate_point_visibility(position);
+    }
+};
+
 //Extract perimeter polylines of the given layer
 PolylineWithEnds extract_perimeter_polylines(const Layer *layer, const SeamPosition configured_seam_preference,
         std::vector<const LayerRegion*> &corresponding_regions_out) {
@@ -836,8 +851,32 @@ std::pair<size_t, size_t> find_previous_and_next_perimeter_point(const std::vect
 }
 
 // Computes all global model info - transforms object, performs raycasting
-void compute_global_occlusion(GlobalModelInfo &result, const PrintObject *po,
+// The occlusion only depends on the meshes and the object transformation: the cache key is a hash of these,
+// so that copies of the same object share the raycasting and a new export with another configuration reuses it.
+std::string global_occlusion_key(const PrintObject *po) {
+    MD5Hasher hasher;
+    const Transform3d obj_transform = po->trafo_centered();
+    hasher.process(obj_transform.data(), sizeof(double) * 16);
+    const bool has_seam_visibility = po->config().seam_visibility.value && po->config().seam_position.value == SeamPosition::spCost;
+    hasher.process(&has_seam_visibility, sizeof(has_seam_visibility));
+    for (const ModelVolume *model_volume : po->model_object()->volumes) {
+        if (model_volume->type() == ModelVolumeType::MODEL_PART
+                || model_volume->type() == ModelVolumeType::NEGATIVE_VOLUME) {
+            const int type = int(model_volume->type());
+            const indexed_triangle_set &its = model_volume->mesh().its;
+            hasher.process(&type, sizeof(type));
+            hasher.process(model_volume->get_matrix().data(), sizeof(double) * 16);
+            hasher.process(its.vertices.data(), its.vertices.size() * sizeof(stl_vertex));
+            hasher.process(its.indices.data(), its.indices.size() * sizeof(stl_triangle_vertex_indices));
+        }
+    }
+    return hasher.digest();
+}
+
+std::shared_ptr<const GlobalOcclusionInfo> compute_global_occlusion(const PrintObject *po,
         std::function<void(void)> throw_if_canceled) {
+    auto result_ptr = std::make_shared<GlobalOcclusionInfo>();
+    GlobalOcclusionInfo &result = *result_ptr;
     BOOST_LOG_TRIVIAL(debug)
     << "SeamPlacer: gather occlusion meshes: start";
     auto obj_transform = po->trafo_centered();
@@ -918,6 +957,7 @@ void compute_global_occlusion(GlobalModelInfo &result, const PrintObject *po,
 #ifdef DEBUG_FILES
     result.debug_export(triangle_set);
 #endif
+    return result_ptr;
 }
 
 void gather_enforcers_blockers(GlobalModelInfo &result, const PrintObject *po) {
@@ -1247,7 +1287,8 @@ void pick_random_seam_point(const std::vector<SeamCandidate> &perimeter_points,
 // Store results in the SeamPlacer variables m_seam_per_object
 void SeamPlacer::gather_seam_candidates(const PrintObject *po, const SeamPlacerImpl::GlobalModelInfo &global_model_info, SeamPosition configured_seam_preference) {
     using namespace SeamPlacerImpl;
-    PrintObjectSeamData &seam_data = m_seam_per_object.emplace(po, PrintObjectSeamData { }).first->second;
+    // the entry is created by init(), as the objects are processed in parallel
+    PrintObjectSeamData &seam_data = m_seam_per_object.find(po)->second;
     seam_data.layers.resize(po->layer_count());
     
     // use an antomic idx instead of the range, to avoid a thread being very late because it's on the difficult layers.
@@ -1280,7 +1321,7 @@ void SeamPlacer::calculate_candidates_visibility(const PrintObject *po,
         const SeamPlacerImpl::GlobalModelInfo &global_model_info) {
     using namespace SeamPlacerImpl;
 
-    std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object[po].layers;
+    std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object.find(po)->second.layers;
     tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()),
             [&layers, &global_model_info](tbb::blocked_range<size_t> r) {
                 for (size_t layer_idx = r.begin(); layer_idx < r.end(); ++layer_idx) {
@@ -1296,7 +1337,7 @@ void SeamPlacer::calculate_overhangs_and_layer_embedding(const PrintObject *po)
     using namespace SeamPlacerImpl;
     using PerimeterDistancer = AABBTreeLines::LinesDistancer<Linef>;
 
-    std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object[po].layers;
+    std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object.find(po)->second.layers;
     tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()),
             [po, &layers](tbb::blocked_range<size_t> r) {
                 std::unique_ptr<PerimeterDistancer> prev_layer_distancer;
@@ -1502,7 +1543,7 @@ void SeamPlacer::align_seam_points(const PrintObject *po, const SeamPlacerImpl::
 #endif
 
     //gather vector of all seams on the print_object - pair of layer_index and seam__index within that layer
-    const std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object[po].layers;
+    const std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object.find(po)->second.layers;
     std::vector<std::pair<size_t, size_t>> seams;
     for (size_t layer_idx = 0; layer_idx < layers.size(); ++layer_idx) {
         const std::vector<SeamCandidate> &layer_perimeter_points = layers[layer_idx].points;
@@ -1756,80 +1797,137 @@ void SeamPlacer::init(const Print &print, std::function<void(void)> throw_if_can
     cache_volume_to_bb.clear();
     this->external_perimeters_first = print.default_region_config().external_perimeters_first;
 
-    for (size_t obj_idx = 0; obj_idx < print.objects().size(); ++ obj_idx) {
-        const PrintObject *po = print.objects()[obj_idx];
-        print.set_status(int((obj_idx * 100) / print.objects().size()),
-                         ("Computing seam visibility areas: object %s / %s"),
-                         {std::to_string(obj_idx + 1), std::to_string(print.objects().size())},
-                         PrintBase::SlicingStatus::SECONDARY_STATE);
-        throw_if_canceled_func();
-        SeamPosition configured_seam_preference = po->config().seam_position.value;
-        SeamComparator comparator { configured_seam_preference, *po };
+    auto objects = print.objects();
+    auto needs_occlusion = [](SeamPosition seam_position) {
+        return seam_position == spAligned || seam_position == spExtremlyAligned ||
+            seam_position == spNearest || seam_position == spCost || seam_position == spCustom;
+    };
+
+    // Raycast the occlusion only once for the objects with the same meshes, and reuse the ones from the previous export.
+    std::vector<std::string> occlusion_keys(objects.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, objects.size()),
+            [&objects, &occlusion_keys, &needs_occlusion](const tbb::blocked_range<size_t> &range) {
+                for (size_t obj_idx = range.begin(); obj_idx < range.end(); ++ obj_idx)
+                    if (needs_occlusion(objects[obj_idx]->config().seam_position.value))
+                        occlusion_keys[obj_idx] = global_occlusion_key(objects[obj_idx]);
+            });
+    std::map<std::string, std::shared_ptr<const GlobalOcclusionInfo>> occlusions;
+    std::vector<std::pair<std::string, const PrintObject*>> occlusions_to_compute;
+    {
+        std::lock_guard<std::mutex> lock(cache_occlusion_mutex);
+        for (size_t obj_idx = 0; obj_idx < objects.size(); ++ obj_idx) {
+            const std::string &key = occlusion_keys[obj_idx];
+            if (key.empty() || occlusions.find(key) != occlusions.end())
+                continue;
+            auto it_cached = cache_occlusion.find(key);
+            if (it_cached == cache_occlusion.end()) {
+                occlusions_to_compute.emplace_back(key, objects[obj_idx]);
+                occlusions[key] = nullptr;
+            } else
+                occlusions[key] = it_cached->second;
+        }
+    }
+    BOOST_LOG_TRIVIAL(debug)
+    << "SeamPlacer: compute_global_occlusion of " << occlusions_to_compute.size() << " meshes, "
+    << occlusions.size() - occlusions_to_compute.size() << " reused";
+    std::vector<std::shared_ptr<const GlobalOcclusionInfo>> computed_occlusions(occlusions_to_compute.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, occlusions_to_compute.size(), 1),
+            [&occlusions_to_compute, &computed_occlusions, &throw_if_canceled_func](const tbb::blocked_range<size_t> &range) {
+                for (size_t idx = range.begin(); idx < range.end(); ++ idx)
+                    computed_occlusions[idx] = compute_global_occlusion(occlusions_to_compute[idx].second, throw_if_canceled_func);
+            });
+    for (size_t idx = 0; idx < occlusions_to_compute.size(); ++ idx)
+        occlusions[occlusions_to_compute[idx].first] = std::move(computed_occlusions[idx]);
+    {
+        // Only keep the occlusion of the objects of this print.
+        std::lock_guard<std::mutex> lock(cache_occlusion_mutex);
+        cache_occlusion = occlusions;
+    }
+    throw_if_canceled_func();
+
+    // Create all the entries first, so that the objects can be processed in parallel.
+    for (const PrintObject *po : objects)
+        m_seam_per_object[po];
+
+    std::atomic<size_t> objects_done(0);
+    std::mutex          status_mutex;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, objects.size(), 1),
+            [this, &print, &objects, &occlusion_keys, &occlusions, &needs_occlusion, &objects_done, &status_mutex, &throw_if_canceled_func]
+            (const tbb::blocked_range<size_t> &range) {
+                for (size_t obj_idx = range.begin(); obj_idx < range.end(); ++ obj_idx) {
+                    const PrintObject *po = objects[obj_idx];
+                    throw_if_canceled_func();
+                    SeamPosition configured_seam_preference = po->config().seam_position.value;
+                    SeamComparator comparator { configured_seam_preference, *po };
 
-        {
-            GlobalModelInfo global_model_info { };
-            gather_enforcers_blockers(global_model_info, po);
-            throw_if_canceled_func();
-            if (configured_seam_preference == spAligned || configured_seam_preference == spExtremlyAligned ||
-                configured_seam_preference == spNearest || configured_seam_preference == spCost || configured_seam_preference == spCustom) {
-                compute_global_occlusion(global_model_info, po, throw_if_canceled_func);
-            }
-            throw_if_canceled_func();
-            BOOST_LOG_TRIVIAL(debug)
-            << "SeamPlacer: gather_seam_candidates: start";
-            gather_seam_candidates(po, global_model_info, configured_seam_preference);
-            BOOST_LOG_TRIVIAL(debug)
-            << "SeamPlacer: gather_seam_candidates: end";
-            throw_if_canceled_func();
-            if (configured_seam_preference == spAligned || configured_seam_preference == spExtremlyAligned ||
-                configured_seam_preference == spNearest || configured_seam_preference == spCost || configured_seam_preference == spCustom) {
-                BOOST_LOG_TRIVIAL(debug)
-                << "SeamPlacer: calculate_candidates_visibility : start";
-                calculate_candidates_visibility(po, global_model_info);
-                BOOST_LOG_TRIVIAL(debug)
-                << "SeamPlacer: calculate_candidates_visibility : end";
-            }
-        } // destruction of global_model_info (large structure, no longer needed)
-        throw_if_canceled_func();
-        BOOST_LOG_TRIVIAL(debug)
-        << "SeamPlacer: calculate_overhangs and layer embdedding : start";
-        calculate_overhangs_and_layer_embedding(po);
-        BOOST_LOG_TRIVIAL(debug)
-        << "SeamPlacer: calculate_overhangs and layer embdedding: end";
-        throw_if_canceled_func();
-        if (configured_seam_preference != spNearest && configured_seam_preference != spCost && configured_seam_preference != spCustom) { // For spNearest, the seam is picked in the place_seam method with actual nozzle position information
-            BOOST_LOG_TRIVIAL(debug)
-            << "SeamPlacer: pick_seam_point : start";
-            //pick seam point
-            std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object[po].layers;
-            tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()),
-                    [&layers, configured_seam_preference, comparator, po](tbb::blocked_range<size_t> r) {
-                        for (size_t layer_idx = r.begin(); layer_idx < r.end(); ++layer_idx) {
-                            std::vector<SeamCandidate> &layer_perimeter_points = layers[layer_idx].points;
-                            for (size_t current = 0; current < layer_perimeter_points.size();
-                                    current = layer_perimeter_points[current].perimeter.end_index)
-                                if (configured_seam_preference == spRandom || configured_seam_preference == SeamPosition::spAllRandom)
-                                    pick_random_seam_point(layer_perimeter_points, current, *po);
-                                else
-                                    pick_seam_point(layer_perimeter_points, current, comparator);
+                    {
+                        GlobalModelInfo global_model_info { };
+                        gather_enforcers_blockers(global_model_info, po);
+                        throw_if_canceled_func();
+                        if (needs_occlusion(configured_seam_preference)) {
+                            global_model_info.occlusion = occlusions.find(occlusion_keys[obj_idx])->second;
                         }
-                    });
-            BOOST_LOG_TRIVIAL(debug)
-            << "SeamPlacer: pick_seam_point : end";
-        }
-        throw_if_canceled_func();
-        if (configured_seam_preference == spAligned || configured_seam_preference == spExtremlyAligned || configured_seam_preference == spRear) {
-            BOOST_LOG_TRIVIAL(debug)
-            << "SeamPlacer: align_seam_points : start";
-            align_seam_points(po, comparator);
-            BOOST_LOG_TRIVIAL(debug)
-            << "SeamPlacer: align_seam_points : end";
-        }
+                        BOOST_LOG_TRIVIAL(debug)
+                        << "SeamPlacer: gather_seam_candidates: start";
+                        gather_seam_candidates(po, global_model_info, configured_seam_preference);
+                        BOOST_LOG_TRIVIAL(debug)
+                        << "SeamPlacer: gather_seam_candidates: end";
+                        throw_if_canceled_func();
+                        if (needs_occlusion(configured_seam_preference)) {
+                            BOOST_LOG_TRIVIAL(debug)
+                            << "SeamPlacer: calculate_candidates_visibility : start";
+                            calculate_candidates_visibility(po, global_model_info);
+                            BOOST_LOG_TRIVIAL(debug)
+                            << "SeamPlacer: calculate_candidates_visibility : end";
+                        }
+                    } // destruction of global_model_info (large structure, no longer needed)
+                    throw_if_canceled_func();
+                    BOOST_LOG_TRIVIAL(debug)
+                    << "SeamPlacer: calculate_overhangs and layer embdedding : start";
+                    calculate_overhangs_and_layer_embedding(po);
+                    BOOST_LOG_TRIVIAL(debug)
+                    << "SeamPlacer: calculate_overhangs and layer embdedding: end";
+                    throw_if_canceled_func();
+                    if (configured_seam_preference != spNearest && configured_seam_preference != spCost && configured_seam_preference != spCustom) { // For spNearest, the seam is picked in the place_seam method with actual nozzle position information
+                        BOOST_LOG_TRIVIAL(debug)
+                        << "SeamPlacer: pick_seam_point : start";
+                        //pick seam point
+                        std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object.find(po)->second.layers;
+                        tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()),
+                                [&layers, configured_seam_preference, comparator, po](tbb::blocked_range<size_t> r) {
+                                    for (size_t layer_idx = r.begin(); layer_idx < r.end(); ++layer_idx) {
+                                        std::vector<SeamCandidate> &layer_perimeter_points = layers[layer_idx].points;
+                                        for (size_t current = 0; current < layer_perimeter_points.size();
+                                                current = layer_perimeter_points[current].perimeter.end_index)
+                                            if (configured_seam_preference == spRandom || configured_seam_preference == SeamPosition::spAllRandom)
+                                                pick_random_seam_point(layer_perimeter_points, current, *po);
+                                            else
+                                                pick_seam_point(layer_perimeter_points, current, comparator);
+                                    }
+                                });
+                        BOOST_LOG_TRIVIAL(debug)
+                        << "SeamPlacer: pick_seam_point : end";
+                    }
+                    throw_if_canceled_func();
+                    if (configured_seam_preference == spAligned || configured_seam_preference == spExtremlyAligned || configured_seam_preference == spRear) {
+                        BOOST_LOG_TRIVIAL(debug)
+                        << "SeamPlacer: align_seam_points : start";
+                        align_seam_points(po, comparator);
+                        BOOST_LOG_TRIVIAL(debug)
+                        << "SeamPlacer: align_seam_points : end";
+                    }
 
 #ifdef DEBUG_FILES
-        debug_export_points(m_seam_per_object[po].layers, po->bounding_box(), comparator);
+                    debug_export_points(m_seam_per_object.find(po)->second.layers, po->bounding_box(), comparator);
 #endif
-    }
+                    const size_t done = ++ objects_done;
+                    std::lock_guard<std::mutex> lock(status_mutex);
+                    print.set_status(int((done * 100) / objects.size()),
+                                     ("Computing seam visibility areas: object %s / %s"),
+                                     {std::to_string(done), std::to_string(objects.size())},
+                                     PrintBase::SlicingStatus::SECONDARY_STATE);
+                }
+            });
 }
 
 static constexpr float MINIMAL_POLYGON_SIDE = scaled<float>(0.2f);
@@ -7,6 +7,7 @@
 #include <boost/algorithm/string/split.hpp>
 #include <boost/nowide/fstream.hpp>
 #include <boost/nowide/cstdio.hpp>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
@@ -16,6 +17,9 @@
 
 #include <fast_float/fast_float.h>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 namespace Slic3r {
 
 static inline char get_extrusion_axis_char(const GCodeConfig &config)
@@ -38,10 +42,9 @@ void GCodeReader::apply_config(const DynamicPrintConfig &config)
     m_extrusion_axis = get_extrusion_axis_char(m_config);
 }
 
-const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, GCodeLine &gline, std::pair<const char*, const char*> &command)
+// Only reads the configuration of the reader, thus it may be called from worker threads in parallel.
+const char* GCodeReader::tokenize_line(const char *ptr, const char *end, GCodeLine &gline, std::pair<const char*, const char*> &command) const
 {
-    assert(is_decimal_separator_point());
-    
     // command and args
     const char *c = ptr;
     {
@@ -90,9 +93,7 @@ const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, G
                 c = skip_word(c);
         }
     }
-    
-    if (gline.has(E) && m_config.use_relative_e_distances)
-        m_position[E] = 0;
+
 
     // Skip the rest of the line.
     for (; ! is_end_of_line(*c); ++ c);
@@ -107,12 +108,27 @@ const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, G
 	if (*c == '\n')
 		++ c;
 
-    if (m_verbose)
-        std::cout << gline.m_raw << std::endl;
+    return c;
+}
 
+const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, GCodeLine &gline, std::pair<const char*, const char*> &command)
+{
+    assert(is_decimal_separator_point());
+
+    const char *c = this->tokenize_line(ptr, end, gline, command);
+    this->update_relative_extrusion(gline);
     return c;
 }
 
+void GCodeReader::update_relative_extrusion(const GCodeLine &gline)
+{
+    if (gline.has(E) && m_config.use_relative_e_distances)
+        m_position[E] = 0;
+
+    if (m_verbose)
+        std::cout << gline.m_raw << std::endl;
+}
+
 void GCodeReader::update_coordinates(GCodeLine &gline, std::pair<const char*, const char*> &command)
 {
     if (*command.first == 'G') {
@@ -126,12 +142,28 @@ void GCodeReader::update_coordinates(GCodeLine &gline, std::pair<const char*, co
     }
 }
 
+// Find the first '\r' or '\n' in <begin, end), return end if there is none.
+// memchr() is vectorized by the C library, which is much faster than testing the characters one by one.
+static inline const char* find_end_of_line(const char *begin, const char *end)
+{
+    const char *eol = static_cast<const char*>(::memchr(begin, '\n', end - begin));
+    if (eol == nullptr)
+        eol = end;
+    // A lone '\r' is accepted as an end of line as well.
+    if (const char *cr = static_cast<const char*>(::memchr(begin, '\r', eol - begin)); cr != nullptr)
+        eol = cr;
+    return eol;
+}
+
 template<typename ParseLineCallback, typename LineEndCallback>
 bool GCodeReader::parse_file_raw_internal(const std::string &filename, ParseLineCallback parse_line_callback, LineEndCallback line_end_callback)
 {
     FilePtr in{ boost::nowide::fopen(filename.c_str(), "rb") };
+    if (in.f == nullptr)
+        return false;
 
-    // Read the input stream 64kB at a time, extract lines and process them.
+    // Read the input stream 640kB at a time, extract lines and process them.
+    // Lines are passed to the callback as pointers into the buffer, only a line split between two reads is copied.
     std::vector<char> buffer(65536 * 10, 0);
     // Line buffer.
     std::string gcode_line;
@@ -142,20 +174,16 @@ bool GCodeReader::parse_file_raw_internal(const std::string &filename, ParseLine
         if (::ferror(in.f))
             return false;
         bool eof       = cnt_read == 0;
-        auto it        = buffer.begin();
-        auto it_bufend = buffer.begin() + cnt_read;
+        const char *it        = buffer.data();
+        const char *it_bufend = buffer.data() + cnt_read;
         while (it != it_bufend || (eof && ! gcode_line.empty())) {
             // Find end of line.
-            bool eol    = false;
-            auto it_end = it;
-            for (; it_end != it_bufend && ! (eol = *it_end == '\r' || *it_end == '\n'); ++ it_end)
-                if (*it_end == '\n')
-                    line_end_callback(file_pos + (it_end - buffer.begin()) + 1);
+            const char *it_end = find_end_of_line(it, it_bufend);
             // End of line is indicated also if end of file was reached.
-            eol |= eof && it_end == it_bufend;
+            bool eol = it_end != it_bufend || eof;
             if (eol) {
                 if (gcode_line.empty())
-                    parse_line_callback(&(*it), &(*it_end));
+                    parse_line_callback(it, it_end);
                 else {
                     gcode_line.insert(gcode_line.end(), it, it_end);
                     parse_line_callback(gcode_line.c_str(), gcode_line.c_str() + gcode_line.size());
@@ -171,7 +199,7 @@ bool GCodeReader::parse_file_raw_internal(const std::string &filename, ParseLine
             if (it != it_bufend && *it == '\r')
                 ++ it;
             if (it != it_bufend && *it == '\n') {
-                line_end_callback(file_pos + (it - buffer.begin()) + 1);
+                line_end_callback(file_pos + (it - buffer.data()) + 1);
                 ++ it;
             }
         }
@@ -182,16 +210,110 @@ bool GCodeReader::parse_file_raw_internal(const std::string &filename, ParseLine
     return true;
 }
 
+// Tokenizing a line (splitting it to axes and parsing the numbers) does not depend on the lines before,
+// only updating the current position does. Each block of the file is thus split into chunks of complete lines,
+// the chunks are tokenized in parallel and then the tokenized lines are passed to the callback in the order
+// of the file on the calling thread, so the callback may use the thread local numeric locale and throw.
 template<typename ParseLineCallback, typename LineEndCallback>
 bool GCodeReader::parse_file_internal(const std::string &filename, ParseLineCallback parse_line_callback, LineEndCallback line_end_callback)
 {
-    GCodeLine gline;    
-    return this->parse_file_raw_internal(filename, 
-        [this, &gline, parse_line_callback](const char *begin, const char *end) {
-            gline.reset();
-            this->parse_line(begin, end, gline, parse_line_callback);
-        }, 
-        line_end_callback);
+    FilePtr in{ boost::nowide::fopen(filename.c_str(), "rb") };
+    if (in.f == nullptr)
+        return false;
+
+    struct TokenizedLine {
+        GCodeLine                           gline;
+        std::pair<const char*, const char*> command;
+        // File position just after the terminating '\n', zero if the line is not terminated by '\n'.
+        size_t                              line_end { 0 };
+    };
+    // Size of a chunk of the block tokenized by a single task.
+    static constexpr const size_t chunk_size = 65536;
+
+    // Read the input stream 640kB at a time.
+    std::vector<char> buffer(chunk_size * 10, 0);
+    // Complete lines read from the file, zero terminated as tokenize_line() expects.
+    std::string block;
+    // The incomplete line at the end of the last read, to be prepended to the next block.
+    std::string carry;
+    // File position of the start of block.
+    size_t block_pos = 0;
+    std::vector<const char*>                 chunk_begins;
+    std::vector<std::vector<TokenizedLine>>  chunks;
+    m_parsing = true;
+    for (bool eof = false; ! eof;) {
+        size_t cnt_read = ::fread(buffer.data(), 1, buffer.size(), in.f);
+        if (::ferror(in.f))
+            return false;
+        eof = cnt_read == 0;
+        const char *buffer_end = buffer.data() + cnt_read;
+        const char *last_eol   = buffer_end;
+        if (! eof) {
+            // Only complete lines are parsed, split the buffer after its last '\n'.
+            for (; last_eol != buffer.data() && last_eol[-1] != '\n'; -- last_eol);
+            if (last_eol == buffer.data()) {
+                // No line ends in this read, the line continues in the next one.
+                carry.append(buffer.data(), cnt_read);
+                continue;
+            }
+        }
+        block.swap(carry);
+        block.append(buffer.data(), last_eol - buffer.data());
+        carry.assign(last_eol, buffer_end);
+        if (block.empty())
+            continue;
+
+        // Split the block into chunks of complete lines.
+        const char *block_begin = block.data();
+        const char *block_end   = block_begin + block.size();
+        chunk_begins.clear();
+        for (const char *it = block_begin; it != block_end;) {
+            chunk_begins.emplace_back(it);
+            it += std::min(chunk_size, size_t(block_end - it));
+            if (it != block_end) {
+                const char *eol = static_cast<const char*>(::memchr(it, '\n', block_end - it));
+                it = eol == nullptr ? block_end : eol + 1;
+            }
+        }
+        chunks.resize(chunk_begins.size());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, chunk_begins.size()),
+            [this, &chunk_begins, &chunks, block_begin, block_end, block_pos](const tbb::blocked_range<size_t> &range) {
+                for (size_t chunk_id = range.begin(); chunk_id < range.end(); ++ chunk_id) {
+                    std::vector<TokenizedLine> &lines = chunks[chunk_id];
+                    lines.clear();
+                    const char *it        = chunk_begins[chunk_id];
+                    const char *chunk_end = chunk_id + 1 < chunk_begins.size() ? chunk_begins[chunk_id + 1] : block_end;
+                    while (it != chunk_end) {
+                        const char    *it_end = find_end_of_line(it, chunk_end);
+                        TokenizedLine &line   = lines.emplace_back();
+                        this->tokenize_line(it, it_end, line.gline, line.command);
+                        // Skip EOL.
+                        it = it_end;
+                        if (it != chunk_end && *it == '\r')
+                            ++ it;
+                        if (it != chunk_end && *it == '\n') {
+                            ++ it;
+                            line.line_end = block_pos + (it - block_begin);
+                        }
+                    }
+                }
+            });
+
+        for (std::vector<TokenizedLine> &lines : chunks)
+            for (TokenizedLine &line : lines) {
+                this->update_relative_extrusion(line.gline);
+                parse_line_callback(*this, line.gline);
+                this->update_coordinates(line.gline, line.command);
+                if (! m_parsing)
+                    // The callback wishes to exit.
+                    return true;
+                if (line.line_end != 0)
+                    line_end_callback(line.line_end);
+            }
+        block_pos += block.size();
+        block.clear();
+    }
+    return true;
 }
 
 bool GCodeReader::parse_file(const std::string &file, callback_t callback)
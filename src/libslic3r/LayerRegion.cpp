@@ -1372,6 +1372,13 @@ void LayerRegion::simplify_extrusion_entity()
     this->m_fills.visit(visitor);
     this->m_ironings.visit(visitor);
     this->m_millings.visit(visitor);
+    // This is the last step producing the extrusions of the region, release the memory the simplification made unused.
+    ShrinkToFitVisitor shrink_visitor;
+    this->m_perimeters.visit(shrink_visitor);
+    this->m_fills.visit(shrink_visitor);
+    this->m_ironings.visit(shrink_visitor);
+    this->m_millings.visit(shrink_visitor);
+    this->m_thin_fills.visit(shrink_visitor);
 }
 
 }
@@ -325,6 +325,8 @@ public:
     void clear();
     void swap(ArcPolyline &other) { m_path.swap(other.m_path); this->m_only_strait = other.m_only_strait; assert(is_valid()); }
     void reverse() { Geometry::ArcWelder::reverse(m_path); }
+    // Release the capacity of the segment vector not used after the path was built and simplified.
+    void shrink_to_fit() { m_path.shrink_to_fit(); }
     
     // multipoint methods
     const Point &front() const { return m_path.front().point; }
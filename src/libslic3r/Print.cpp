@@ -33,6 +33,7 @@
 #include "I18N.hpp"
 #include "ShortestPath.hpp"
 #include "Thread.hpp"
+#include "Timer.hpp"
 #include "GCode.hpp"
 #include "GCode/WipeTower.hpp"
 #include "GCode/ConflictChecker.hpp"
@@ -72,6 +73,8 @@ void Print::clear()
 	m_objects.clear();
     m_print_regions.clear();
     m_model.clear_objects();
+    m_conflict_result.reset();
+    m_conflict_checker_key.clear();
 }
 
 // Called by Print::apply().
@@ -87,7 +90,6 @@ bool Print::invalidate_state_by_config_options(const ConfigOptionResolver& /* ne
     static std::unordered_set<std::string> steps_gcode = {
         "allow_empty_layers",
         "autoemit_temperature_commands",
-        "avoid_crossing_perimeters",
         "avoid_crossing_perimeters_max_detour",
         "avoid_crossing_not_first_layer",
         "bed_shape",
@@ -382,6 +384,8 @@ bool Print::invalidate_state_by_config_options(const ConfigOptionResolver& /* ne
         } else if (opt_key == "seam_gap" || opt_key == "seam_gap_external") {
             osteps.emplace_back(posInfill);
         }
+        else if (opt_key == "avoid_crossing_perimeters")
+            steps.emplace_back(psAvoidCrossingPerimeters);
         else if (opt_key == "avoid_crossing_curled_overhangs")
             osteps.emplace_back(posEstimateCurledExtrusions);
         else if (opt_key == "posSlice")
@@ -420,8 +424,11 @@ bool Print::invalidate_step(PrintStep step)
 {
 	bool invalidated = Inherited::invalidate_step(step);
     // Propagate to dependent steps.
-    if (step != psGCodeExport)
+    if (step != psGCodeExport) {
         invalidated |= Inherited::invalidate_step(psGCodeExport);
+        // The wipe tower or another print step feeding the G-code export changed, check the conflicts again.
+        m_conflict_checker_key.clear();
+    }
     return invalidated;
 }
 
@@ -1210,6 +1217,33 @@ public:
         }
     } ptvisitor;
 #endif
+// Log the time spent by each object in the steps chained by Print::process(), and the object on the critical path
+// of each of the two parallel sections (perimeters -> infill -> ironing, support -> curled extrusions -> overhangs).
+void Print::log_critical_path() const
+{
+    size_t       critical_object[2] = { size_t(-1), size_t(-1) };
+    unsigned int critical_time[2]   = { 0, 0 };
+    for (size_t idx = 0; idx < m_object_step_times_ms.size(); ++ idx) {
+        const ObjectStepTimes &times = m_object_step_times_ms[idx];
+        std::string msg;
+        for (size_t step = 0; step < times.size(); ++ step)
+            msg += std::string(step == 0 ? "" : ", ") + object_step_time_names[step] + ": " + std::to_string(times[step]) + "ms";
+        BOOST_LOG_TRIVIAL(debug) << "Print::process: object " << m_objects[idx]->model_object()->name << " - " << msg;
+        // The steps chained per object after the slicing: perimeters to ironing, then support to overhanging perimeters.
+        for (size_t section = 0; section < 2; ++ section) {
+            unsigned int time = times[section * 3 + 1] + times[section * 3 + 2] + times[section * 3 + 3];
+            if (critical_object[section] == size_t(-1) || time > critical_time[section]) {
+                critical_object[section] = idx;
+                critical_time[section]   = time;
+            }
+        }
+    }
+    for (size_t section = 0; section < 2; ++ section)
+        if (critical_object[section] != size_t(-1))
+            BOOST_LOG_TRIVIAL(info) << "Print::process: critical path from " << object_step_time_names[section * 3 + 1] << " to " << object_step_time_names[section * 3 + 3] <<
+                ": object " << m_objects[critical_object[section]]->model_object()->name << ", " << critical_time[section] << "ms";
+}
+
 // Slicing process, running at a background thread.
 void Print::process()
 {
@@ -1217,10 +1251,31 @@ void Print::process()
     name_tbb_thread_pool_threads_set_locale();
     bool something_done = !is_step_done_unguarded(psSkirtBrim);
     BOOST_LOG_TRIVIAL(info) << "Starting the slicing process." << log_memory_info();
+    // Slicing has to be finished for all the objects before going further, as the infill may look at the lslices
+    // of the other objects (solid_infill_below_layer_area).
+    // The time spent in each step is collected to report the critical path.
+    m_object_step_times_ms.assign(m_objects.size(), ObjectStepTimes{});
+    auto timed_step = [this](size_t object_idx, size_t step_idx, auto &&step) {
+        Timing::Timer timer;
+        timer.start();
+        step();
+        m_object_step_times_ms[object_idx][step_idx] = timer.elapsed_milliseconds();
+    };
+    secondary_status_counter_reset();
+    Slic3r::parallel_for(size_t(0), m_objects.size(),
+        [this, &timed_step](const size_t idx) {
+            timed_step(idx, 0, [obj = m_objects[idx]]() { obj->slice(); });
+        }
+    );
+    // The following steps only depend on the previous steps of the same object: chain them per object,
+    // so that a small object doesn't wait for the perimeters of a big one before starting its infill.
     secondary_status_counter_reset();
     Slic3r::parallel_for(size_t(0), m_objects.size(),
-        [this](const size_t idx) {
-            m_objects[idx]->make_perimeters();
+        [this, &timed_step](const size_t idx) {
+            PrintObject &obj = *m_objects[idx];
+            timed_step(idx, 1, [&obj]() { obj.make_perimeters(); });
+            timed_step(idx, 2, [&obj]() { obj.infill(); });
+            timed_step(idx, 3, [&obj]() { obj.ironing(); });
         }
     );
 #ifdef _DEBUG
@@ -1229,18 +1284,6 @@ void Print::process()
             for (LayerRegion* lr : lay->regions())
                 lr->perimeters().visit(ptvisitor);
 #endif
-    secondary_status_counter_reset();
-    Slic3r::parallel_for(size_t(0), m_objects.size(),
-        [this](const size_t idx) {
-            m_objects[idx]->infill();
-        }
-    );
-    secondary_status_counter_reset();
-    Slic3r::parallel_for(size_t(0), m_objects.size(),
-        [this](const size_t idx) {
-            m_objects[idx]->ironing();
-        }
-    );
 
     // The following step writes to m_shared_regions, it should not run in parallel.
     //FIXME: only run it when the support is needed.
@@ -1253,23 +1296,14 @@ void Print::process()
 
     secondary_status_counter_reset();
     Slic3r::parallel_for(size_t(0), m_objects.size(),
-        [this](const size_t idx) {
-            m_objects[idx]->generate_support_material();
-        }
-    );
-    secondary_status_counter_reset();
-    Slic3r::parallel_for(size_t(0), m_objects.size(),
-        [this](const size_t idx) {
+        [this, &timed_step](const size_t idx) {
             PrintObject &obj = *m_objects[idx];
-            m_objects[idx]->estimate_curled_extrusions();
-        }
-    );
-    secondary_status_counter_reset();
-    Slic3r::parallel_for(size_t(0), m_objects.size(),
-        [this](const size_t idx) {
-            m_objects[idx]->calculate_overhanging_perimeters();
+            timed_step(idx, 4, [&obj]() { obj.generate_support_material(); });
+            timed_step(idx, 5, [&obj]() { obj.estimate_curled_extrusions(); });
+            timed_step(idx, 6, [&obj]() { obj.calculate_overhanging_perimeters(); });
         }
     );
+    this->log_critical_path();
 
     if (this->set_started(psWipeTower)) {
         m_wipe_tower_data.clear();
@@ -1289,17 +1323,34 @@ void Print::process()
     secondary_status_counter_reset();
     _make_skirt_brim();
 
+    if (this->set_started(psAvoidCrossingPerimeters)) {
+        m_avoid_crossing_perimeters_layers.clear();
+        if (m_config.avoid_crossing_perimeters) {
+            this->set_status(printstep_2_percent[PrintStep::psAvoidCrossingPerimeters], L("Computing travel boundaries"));
+            m_avoid_crossing_perimeters_layers = AvoidCrossingPerimeters::precompute_layers(*this, [this]() { this->throw_if_canceled(); });
+        }
+        this->set_done(psAvoidCrossingPerimeters);
+    }
+
     if (this->has_wipe_tower()) {
         // These values have to be updated here, not during wipe tower generation.
         // When the wipe tower is moved/rotated, it is not regenerated.
         m_wipe_tower_data.position = { m_config.wipe_tower_x, m_config.wipe_tower_y };
         m_wipe_tower_data.rotation_angle = m_config.wipe_tower_rotation_angle;
     }
-    auto conflictRes = ConflictChecker::find_inter_of_lines_in_diff_objs(objects(), m_wipe_tower_data);
-
-    m_conflict_result = conflictRes;
-    if (conflictRes.has_value())
-        BOOST_LOG_TRIVIAL(error) << boost::format("gcode path conflicts found between %1% and %2%") % conflictRes->_objName1 % conflictRes->_objName2;
+    // The conflicts are only searched again if the tool paths changed, not if only the G-code export was invalidated.
+    if (std::string conflict_checker_key = ConflictChecker::tool_paths_key(objects(), m_wipe_tower_data); conflict_checker_key != m_conflict_checker_key) {
+        m_conflict_result      = ConflictChecker::find_inter_of_lines_in_diff_objs(objects(), m_wipe_tower_data);
+        m_conflict_checker_key = std::move(conflict_checker_key);
+    } else if (m_conflict_result.has_value()) {
+        // The objects may have been renamed.
+        if (m_conflict_result->_obj1)
+            m_conflict_result->_objName1 = reinterpret_cast<const PrintObject*>(m_conflict_result->_obj1)->model_object()->name;
+        if (m_conflict_result->_obj2)
+            m_conflict_result->_objName2 = reinterpret_cast<const PrintObject*>(m_conflict_result->_obj2)->model_object()->name;
+    }
+    if (m_conflict_result.has_value())
+        BOOST_LOG_TRIVIAL(error) << boost::format("gcode path conflicts found between %1% and %2%") % m_conflict_result->_objName1 % m_conflict_result->_objName2;
 
 #ifdef _DEBUG
     for (PrintObject* obj : m_objects)
@@ -33,6 +33,7 @@
 #include "SupportSpotsGenerator.hpp"
 #include "TriangleMeshSlicer.hpp"
 #include "Surface.hpp"
+#include "GCode/AvoidCrossingPerimeters.hpp"
 #include "GCode/ToolOrdering.hpp"
 #include "GCode/WipeTower.hpp"
 #include "GCode/ThumbnailData.hpp"
@@ -42,6 +43,7 @@
 
 #include <Eigen/Geometry>
 
+#include <array>
 #include <atomic>
 #include <ctime>
 #include <functional>
@@ -65,6 +67,10 @@ namespace FillAdaptive {
     using OctreePtr = std::unique_ptr<Octree, OctreeDeleter>;
 }; // namespace FillAdaptive
 
+namespace FFFTreeSupport {
+    class TreeModelVolumes;
+}; // namespace FFFTreeSupport
+
 namespace FillLightning {
     class Generator;
     struct GeneratorDeleter;
@@ -85,6 +91,8 @@ enum PrintStep : uint8_t {
     // Last step before G-code export, after this step is finished, the initial extrusion path preview
     // should be refreshed.
     psSlicingFinished = psSkirtBrim,
+    // Boundaries of the object layers for avoid_crossing_perimeters, consumed by the G-code export.
+    psAvoidCrossingPerimeters,
     psGCodeExport,
    //TODO: psGCodeLoader (for params that are only used for time display and such)
     psCount,
@@ -141,6 +149,7 @@ inline std::map<PrintStep, int> printstep_2_percent = {
     {PrintStep::psAlertWhenSupportsNeeded, 45},
     {PrintStep::psSkirtBrim, 70},
     {PrintStep::psWipeTower, 75},
+    {PrintStep::psAvoidCrossingPerimeters, 80},
     {PrintStep::psGCodeExport, 85},
     {PrintStep::psCount, 100},
 };
@@ -329,6 +338,8 @@ public:
     // Whoever will get a non-const pointer to PrintObject will be able to modify its layers.
     LayerPtrs&                   layers()               { return m_layers; }
     SupportLayerPtrs&            edit_support_layers()       { return m_support_layers; }
+    // Collision caches of the last tree support generation, reused by the next one below the modified layers.
+    std::shared_ptr<FFFTreeSupport::TreeModelVolumes>& tree_support_volumes_cache() { return m_tree_support_volumes_cache; }
 
     // Bounding box is used to align the object infill patterns, and to calculate attractor for the rear seam.
     // The bounding box may not be quite snug.
@@ -398,7 +409,7 @@ public:
     std::set<uint16_t>   object_extruders() const;
     double               get_first_layer_height() const;
 
-    // Called by make_perimeters()
+    // Called by make_perimeters() and Print::process()
     void slice();
 
     // Helpers to slice support enforcer / blocker meshes by the support generator.
@@ -459,6 +470,10 @@ private:
     void simplify_extrusion_path();
 
     void slice_volumes();
+    // Persistent cache of the results of slice(), enabled by set_slice_cache_dir().
+    std::string slice_cache_path(const std::vector<coordf_t> &layer_height_profile) const;
+    bool load_cached_slices(const std::string &path);
+    void store_cached_slices(const std::string &path) const;
     // Has any support (not counting the raft).
     ExPolygons _shrink_contour_holes(double contour_delta, double default_delta, double convex_delta, const ExPolygons& input) const;
     void _transform_hole_to_polyholes();
@@ -477,8 +492,9 @@ private:
     void combine_infill();
     void _generate_support_material();
     void _compute_max_sparse_spacing();
+    // Reuses the octrees of m_adaptive_fill_octrees if their mesh, overhangs and line spacing did not change.
     std::pair<FillAdaptive::OctreePtr, FillAdaptive::OctreePtr> prepare_adaptive_infill_data(
-        const std::vector<std::pair<const Surface*, float>>& surfaces_w_bottom_z) const;
+        const std::vector<std::pair<const Surface*, float>>& surfaces_w_bottom_z);
     FillLightning::GeneratorPtr prepare_lightning_infill_data();
 
     // XYZ in scaled coordinates
@@ -499,6 +515,7 @@ private:
     std::shared_ptr<SlicingParameters>      m_slicing_params;
     LayerPtrs                               m_layers;
     SupportLayerPtrs                        m_support_layers;
+    std::shared_ptr<FFFTreeSupport::TreeModelVolumes> m_tree_support_volumes_cache;
 
     // Ordered collections of extrusion paths to build skirt loops and brim.
     // have to be duplicated per copy
@@ -758,6 +775,13 @@ public:
 
     const ExtrusionEntityCollection& skirt() const { return m_skirt; }
     const ExtrusionEntityCollection& brim() const { return m_brim; }
+    // Precomputed avoid_crossing_perimeters boundaries of an object layer, null if not available.
+    std::shared_ptr<const AvoidCrossingPerimeters::LayerBoundaries> avoid_crossing_perimeters_boundaries(const Layer *layer) const {
+        if (! this->is_step_done(psAvoidCrossingPerimeters))
+            return {};
+        auto it = m_avoid_crossing_perimeters_layers.find(layer);
+        return it == m_avoid_crossing_perimeters_layers.end() ? nullptr : it->second;
+    }
     // Convex hull of the 1st layer extrusions, for bed leveling and placing the initial purge line.
     // It encompasses the object extrusions, support extrusions, skirt, brim, wipe tower.
     // It does NOT encompass user extrusions generated by custom G-code,
@@ -768,6 +792,11 @@ public:
     const PrintStatistics&      print_statistics() const { return m_print_statistics; }
     PrintStatistics&            print_statistics() { return m_print_statistics; }
     std::time_t                 timestamp_last_change() const { return m_timestamp_last_change; }
+    // Wall time in milliseconds of the steps of each object spent by the last process(), indexed as object_step_time_names.
+    // Zero for a step not recalculated by the last process().
+    using ObjectStepTimes = std::array<unsigned int, 7>;
+    static constexpr const char *object_step_time_names[7] = { "slice", "perimeters", "infill", "ironing", "support", "curled extrusions", "overhanging perimeters" };
+    const std::vector<ObjectStepTimes>& object_step_times_ms() const { return m_object_step_times_ms; }
 
     // Wipe tower support.
     bool                        has_wipe_tower() const;
@@ -821,6 +850,7 @@ private:
     void                _make_wipe_tower();
     void                finalize_first_layer_convex_hull();
     void                alert_when_supports_needed();
+    void                log_critical_path() const;
 
     // Islands of objects and their supports extruded at the 1st layer.
     Polygons            first_layer_islands() const;
@@ -854,9 +884,11 @@ private:
     // Following section will be consumed by the GCodeGenerator.
     ToolOrdering 							m_tool_ordering;
     WipeTowerData                           m_wipe_tower_data {m_tool_ordering};
+    AvoidCrossingPerimeters::LayersBoundaries m_avoid_crossing_perimeters_layers;
 
     // Estimated print time, filament consumed.
     PrintStatistics                         m_print_statistics;
+    std::vector<ObjectStepTimes>            m_object_step_times_ms;
     // time of last change, used by the gui to see if it needs to be updated
     std::time_t                             m_timestamp_last_change;
 
@@ -871,6 +903,8 @@ private:
     friend class PrintObject;
 
     std::optional<ConflictResult> m_conflict_result;
+    // Key of the tool paths m_conflict_result was found for, see ConflictChecker::tool_paths_key().
+    std::string                   m_conflict_checker_key;
 };
 
 //for testing purpose (in printobject)
@@ -184,6 +184,7 @@ static const t_config_enum_values s_keys_map_InfillPattern {
     {"honeycomb",           ipHoneycomb},
     {"3dhoneycomb",         ip3DHoneycomb},
     {"gyroid",              ipGyroid},
+    {"schwarzd",            ipSchwarzD},
     {"hilbertcurve",        ipHilbertCurve},
     {"archimedeanchords",   ipArchimedeanChords},
     {"octagramspiral",      ipOctagramSpiral},
@@ -2541,6 +2542,7 @@ void PrintConfigDef::init_fff_params()
         { "honeycomb",          L("Honeycomb")},
         { "3dhoneycomb",        L("3D Honeycomb")},
         { "gyroid",             L("Gyroid")},
+        { "schwarzd",           L("Schwarz D")},
         { "hilbertcurve",       L("Hilbert Curve")},
         { "archimedeanchords",  L("Archimedean Chords")},
         { "octagramspiral",     L("Octagram Spiral")},
@@ -10114,6 +10116,8 @@ std::map<std::string, std::string> PrintConfigDef::to_prusa(t_config_option_key&
             value = "concentric";
         } else if ("monotonicgapfill" == value) {
             value = "monotonic";
+        } else if ("schwarzd" == value) {
+            value = "gyroid";
         }
         if (all_conf.has("fill_angle_increment") && ((int(all_conf.option("fill_angle_increment")->get_float())-90)%180) == 0 && "rectilinear" == value
             && ("fill_pattern" == opt_key || "top_fill_pattern" == opt_key)) {
@@ -11485,6 +11489,14 @@ CLIActionsConfigDef::CLIActionsConfigDef()
     def->set_default_value(new ConfigOptionBool(false));
 #endif // ENABLE_GL_CORE_PROFILE
 
+    def = this->add("server", coBool);
+    def->label = L("Slicing server");
+    def->tooltip = L("Run as a headless slicing server. Jobs are read from the standard input, one job per line, "
+                     "each formatted as a command line: the model files, the print options overriding the loaded configuration "
+                     "and --output. The configuration and the sliced objects are kept between the jobs, "
+                     "so a job changing a few options only recomputes the affected steps.");
+    def->set_default_value(new ConfigOptionBool(false));
+
     def = this->add("slice", coBool);
     def->label = L("Slice");
     def->tooltip = L("Slice the model as FFF or SLA based on the printer_technology configuration value.");
@@ -11655,6 +11667,19 @@ CLIMiscConfigDef::CLIMiscConfigDef()
     def->label = L("Data directory");
     def->tooltip = L("Load and store settings at the given directory. This is useful for maintaining different profiles or including configurations from a network storage.");
 
+    def = this->add("slice_cache", coString);
+    def->label = L("Slice cache directory");
+    def->tooltip = L("Store the sliced objects into the given directory and reuse them when an object with the same geometry "
+                     "and the same slicing settings is sliced again, also by another run of the slicer.");
+
+    def = this->add("slice_cache_size", coInt);
+    def->label = L("Slice cache size");
+    def->tooltip = L("Maximum size of the slice cache directory in megabytes. When the cache grows larger, "
+                     "the least recently used objects are removed from it.");
+    def->sidetext = L("MB");
+    def->min = 0;
+    def->set_default_value(new ConfigOptionInt(1024));
+
     def = this->add("threads", coInt);
     def->label = L("Maximum number of threads");
     def->tooltip = L("Sets the maximum number of threads the slicing process will use. If not defined, it will be decided automatically.");
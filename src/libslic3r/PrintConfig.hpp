@@ -143,6 +143,8 @@ enum InfillPattern : uint8_t{
     ipLightning,
     ipEnsuring,
     ipAuto,
+    // Appended to keep the values of the older patterns.
+    ipSchwarzD,
     ipCount,
 };
 
@@ -838,10 +838,14 @@ void PrintObject::_compute_max_sparse_spacing()
     });
     m_max_sparse_spacing = max_sparse_spacing.load();
 }
+// Releasing millions of extrusions is expensive, the layers are independent, thus release them in parallel.
 void PrintObject::clear_fills()
 {
-    for (Layer *layer : m_layers)
-        layer->clear_fills();
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_layers.size()),
+        [this](const tbb::blocked_range<size_t> &range) {
+            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx)
+                m_layers[layer_idx]->clear_fills();
+        });
 }
 void PrintObject::infill()
 {
@@ -967,6 +971,9 @@ void PrintObject::generate_support_material()
             m_print->set_status(0, "", PrintBase::SlicingStatus::DEFAULT | PrintBase::SlicingStatus::SECONDARY_STATE);
         }
         this->clear_support_layers();
+        if (! this->has_support() || (m_config.support_material_style.value != smsTree && m_config.support_material_style.value != smsOrganic))
+            // The tree support collision caches are only reused by the next tree support generation.
+            m_tree_support_volumes_cache.reset();
         if ((this->has_support() && m_layers.size() > 1) || (this->has_raft() && ! m_layers.empty())) {
             this->_generate_support_material();
             m_print->throw_if_canceled();
@@ -1191,7 +1198,7 @@ void PrintObject::calculate_overhanging_perimeters()
 }
 
 std::pair<FillAdaptive::OctreePtr, FillAdaptive::OctreePtr> PrintObject::prepare_adaptive_infill_data(
-    const std::vector<std::pair<const Surface *, float>> &surfaces_w_bottom_z) const
+    const std::vector<std::pair<const Surface *, float>> &surfaces_w_bottom_z)
 {
     using namespace FillAdaptive;
 
@@ -1223,8 +1230,8 @@ std::pair<FillAdaptive::OctreePtr, FillAdaptive::OctreePtr> PrintObject::prepare
         append(overhangs.front(), std::move(overhangs[i]));
 
     return std::make_pair(
-        adaptive_line_spacing ? build_octree(mesh, overhangs.front(), adaptive_line_spacing, false) : OctreePtr(),
-        support_line_spacing  ? build_octree(mesh, overhangs.front(), support_line_spacing, true) : OctreePtr());
+        adaptive_line_spacing ? build_octree(mesh, overhangs.front(), adaptive_line_spacing, false, std::move(m_adaptive_fill_octrees.first)) : OctreePtr(),
+        support_line_spacing  ? build_octree(mesh, overhangs.front(), support_line_spacing, true, std::move(m_adaptive_fill_octrees.second)) : OctreePtr());
 }
 
 FillLightning::GeneratorPtr PrintObject::prepare_lightning_infill_data()
@@ -1294,8 +1301,11 @@ Polygons PrintObject::get_brim_patch(ModelVolumeType brim_type, const PrintInsta
 
 void PrintObject::clear_layers()
 {
-    for (Layer *l : m_layers)
-        delete l;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_layers.size()),
+        [this](const tbb::blocked_range<size_t> &range) {
+            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx)
+                delete m_layers[layer_idx];
+        });
     m_layers.clear();
 }
 
@@ -1307,8 +1317,11 @@ Layer* PrintObject::add_layer(int id, coordf_t height, coordf_t print_z, coordf_
 
 void PrintObject::clear_support_layers()
 {
-    for (Layer *l : m_support_layers)
-        delete l;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_support_layers.size()),
+        [this](const tbb::blocked_range<size_t> &range) {
+            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx)
+                delete m_support_layers[layer_idx];
+        });
     m_support_layers.clear();
 }
 
@@ -1613,9 +1626,11 @@ bool PrintObject::invalidate_state_by_config_options(
             steps.emplace_back(posInfill);
             steps.emplace_back(posSupportMaterial);
             //}
+        } else if (opt_key == "avoid_crossing_top") {
+            // Print::invalidate_step() propagates to the G-code export.
+            invalidated |= m_print->invalidate_step(psAvoidCrossingPerimeters);
         } else if (
-                opt_key == "avoid_crossing_top"
-                || opt_key == "bridge_acceleration"
+                opt_key == "bridge_acceleration"
                 || opt_key == "bridge_speed"
                 || opt_key == "brim_acceleration"
                 || opt_key == "brim_speed"
@@ -1734,9 +1749,11 @@ bool PrintObject::invalidate_step(PrintObjectStep step)
     if (step == posPerimeters) {
 		invalidated |= this->invalidate_steps({ posPrepareInfill, posInfill, posIroning,
             posSupportSpotsSearch, posEstimateCurledExtrusions, posCalculateOverhangingPerimeters, posSimplifyPath });
-        invalidated |= m_print->invalidate_steps({ psSkirtBrim });
+        invalidated |= m_print->invalidate_steps({ psSkirtBrim, psAvoidCrossingPerimeters });
     } else if (step == posPrepareInfill) {
         invalidated |= this->invalidate_steps({ posInfill, posIroning, posSupportSpotsSearch, posSimplifyPath });
+        // The avoid crossing perimeters boundaries exclude the top surfaces.
+        invalidated |= m_print->invalidate_step(psAvoidCrossingPerimeters);
     } else if (step == posInfill) {
         invalidated |= this->invalidate_steps({ posIroning, posSupportSpotsSearch, posSimplifyPath });
         invalidated |= m_print->invalidate_steps({ psSkirtBrim });
@@ -1744,8 +1761,10 @@ bool PrintObject::invalidate_step(PrintObjectStep step)
         invalidated |= this->invalidate_steps({posPerimeters, posPrepareInfill, posInfill, posIroning, posSupportSpotsSearch,
                                                posSupportMaterial, posEstimateCurledExtrusions, posCalculateOverhangingPerimeters,
                                                posSimplifyPath });
-        invalidated |= m_print->invalidate_steps({ psSkirtBrim });
+        invalidated |= m_print->invalidate_steps({ psSkirtBrim, psAvoidCrossingPerimeters });
         m_slicing_params->valid = false;
+        // The layer stack will be regenerated, the tree support collision caches are not valid anymore.
+        m_tree_support_volumes_cache.reset();
     } else if (step == posSupportMaterial) {
         invalidated |= m_print->invalidate_steps({ psSkirtBrim,  });
         invalidated |= this->invalidate_steps({ posEstimateCurledExtrusions });
@@ -1769,6 +1788,7 @@ bool PrintObject::invalidate_all_steps()
     bool result = Inherited::invalidate_all_steps() | m_print->invalidate_all_steps();
 	// Then reset some of the depending values.
 	m_slicing_params->valid = false;
+    m_tree_support_volumes_cache.reset();
 	return result;
 }
 
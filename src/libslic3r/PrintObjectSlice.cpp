@@ -13,8 +13,11 @@
 #include "Print.hpp"
 #include "ShortestPath.hpp"
 #include "Thread.hpp"
+#include "Utils.hpp"
 
+#include <boost/filesystem.hpp>
 #include <boost/log/trivial.hpp>
+#include <boost/nowide/cstdio.hpp>
 
 #include <oneapi/tbb/parallel_for.h>
 
@@ -600,8 +603,16 @@ void PrintObject::slice()
     m_typed_slices = false;
     this->clear_layers();
     m_layers = new_layers(this, generate_object_layers(*m_slicing_params, layer_height_profile));
-    this->slice_volumes();
-    m_print->throw_if_canceled();
+    const std::string cache_path = this->slice_cache_path(layer_height_profile);
+    if (cache_path.empty() || ! this->load_cached_slices(cache_path)) {
+        this->slice_volumes();
+        m_print->throw_if_canceled();
+        //create polyholes
+        this->_transform_hole_to_polyholes();
+        this->_max_overhang_threshold();
+        if (! cache_path.empty())
+            this->store_cached_slices(cache_path);
+    }
 #if 0
     // Layer::slicing_errors is no more set since 1.41.1 or possibly earlier, thus this code
     // was not really functional for a long day and nobody missed it.
@@ -615,11 +626,6 @@ void PrintObject::slice()
         BOOST_LOG_TRIVIAL(info) << warning;
 #endif
 
-    //create polyholes
-    this->_transform_hole_to_polyholes();
-
-    this->_max_overhang_threshold();
-
     // Update bounding boxes, back up raw slices of complex models.
     tbb::parallel_for(
         tbb::blocked_range<size_t>(0, m_layers.size()),
@@ -648,6 +654,283 @@ void PrintObject::slice()
     this->set_done(posSlice);
 }
 
+// Version of the slice cache file format. Increase it whenever the format or the result of slicing changes,
+// so that the files written by older versions are not loaded.
+static constexpr const uint32_t SLICE_CACHE_VERSION = 2;
+
+// Returns the path of the slice cache file of this object, or an empty string if the slice cache is disabled.
+// The file name is the MD5 hash of all the inputs of slice(): meshes and transformations of the volumes,
+// the layer height profile and the object, region and print configurations.
+std::string PrintObject::slice_cache_path(const std::vector<coordf_t> &layer_height_profile) const
+{
+    const std::string &cache_dir = slice_cache_dir();
+    if (cache_dir.empty())
+        return {};
+    const ModelVolumePtrs &volumes = this->model_object()->volumes;
+    // Multi-material segmentation reports warnings while slicing, which would be lost when loading from the cache.
+    if (std::any_of(volumes.begin(), volumes.end(), [](const ModelVolume *v) { return ! v->mm_segmentation_facets.empty(); }))
+        return {};
+
+    MD5Hasher hasher;
+    auto hash_config = [&hasher](const ConfigBase &config) {
+        for (const t_config_option_key &opt_key : config.keys()) {
+            const std::string value = config.opt_serialize(opt_key);
+            hasher.process(opt_key.data(), opt_key.size());
+            hasher.process(value.data(), value.size());
+        }
+    };
+
+    hasher.process(&SLICE_CACHE_VERSION, sizeof(SLICE_CACHE_VERSION));
+    const Transform3d trafo = this->trafo_centered();
+    hasher.process(trafo.data(), sizeof(double) * 16);
+    hasher.process(layer_height_profile.data(), layer_height_profile.size() * sizeof(coordf_t));
+    for (const ModelVolume *volume : volumes) {
+        const int                   type = int(volume->type());
+        const indexed_triangle_set &its  = volume->mesh().its;
+        hasher.process(&type, sizeof(type));
+        hasher.process(volume->get_matrix().data(), sizeof(double) * 16);
+        hasher.process(its.vertices.data(), its.vertices.size() * sizeof(stl_vertex));
+        hasher.process(its.indices.data(), its.indices.size() * sizeof(stl_triangle_vertex_indices));
+        hash_config(volume->config.get());
+    }
+    for (const PrintObjectRegions::LayerRangeRegions &range : m_shared_regions->layer_ranges) {
+        hasher.process(&range.layer_height_range, sizeof(range.layer_height_range));
+        for (const PrintObjectRegions::VolumeRegion &volume_region : range.volume_regions) {
+            const int region_id = volume_region.region == nullptr ? -1 : volume_region.region->print_object_region_id();
+            hasher.process(&region_id, sizeof(region_id));
+        }
+    }
+    for (const std::unique_ptr<PrintRegion> &region : m_shared_regions->all_regions)
+        hash_config(region->config());
+    hash_config(m_config);
+    hash_config(m_print->config());
+
+    return (boost::filesystem::path(cache_dir) / (hasher.hex_digest() + ".slices")).string();
+}
+
+namespace {
+    // Binary writer and reader of the slice cache files. Points are stored as the raw coord_t pairs,
+    // the files are only meant to be read back by the same build on the same platform.
+    // The files end with the MD5 digest of their content to detect corrupted files.
+    class SliceCacheWriter
+    {
+    public:
+        explicit SliceCacheWriter(FILE *file) : m_file(file) {}
+        template<typename T> void write(const T &value) { this->write_raw(&value, sizeof(T)); }
+        void write_raw(const void *data, size_t size) {
+            m_hasher.process(data, size);
+            if (size > 0 && ::fwrite(data, size, 1, m_file) != 1)
+                m_ok = false;
+        }
+        void write(const Polygon &polygon) {
+            this->write(uint64_t(polygon.points.size()));
+            this->write_raw(polygon.points.data(), polygon.points.size() * sizeof(Point));
+        }
+        void write(const ExPolygon &expoly) {
+            this->write(expoly.contour);
+            this->write(uint64_t(expoly.holes.size()));
+            for (const Polygon &hole : expoly.holes)
+                this->write(hole);
+        }
+        // To be called after all the data was written.
+        void write_digest() {
+            const std::string digest = m_hasher.digest();
+            if (::fwrite(digest.data(), digest.size(), 1, m_file) != 1)
+                m_ok = false;
+        }
+        bool ok() const { return m_ok; }
+    private:
+        FILE     *m_file;
+        MD5Hasher m_hasher;
+        bool      m_ok { true };
+    };
+
+    class SliceCacheReader
+    {
+    public:
+        explicit SliceCacheReader(FILE *file) : m_file(file) {}
+        template<typename T> T read() { T value{}; this->read_raw(&value, sizeof(T)); return value; }
+        void read_raw(void *data, size_t size) {
+            if (size > 0 && ::fread(data, size, 1, m_file) != 1)
+                m_ok = false;
+            m_hasher.process(data, size);
+        }
+        // Number of items to follow, limited to fail early on a corrupted file.
+        size_t read_count() {
+            uint64_t cnt = this->read<uint64_t>();
+            if (cnt > (uint64_t(1) << 32))
+                m_ok = false;
+            return m_ok ? size_t(cnt) : 0;
+        }
+        void read(Polygon &polygon) {
+            polygon.points.resize(this->read_count());
+            this->read_raw(polygon.points.data(), polygon.points.size() * sizeof(Point));
+        }
+        void read(ExPolygon &expoly) {
+            this->read(expoly.contour);
+            expoly.holes.resize(this->read_count());
+            for (Polygon &hole : expoly.holes)
+                this->read(hole);
+        }
+        // To be called after all the data was read. Fails if the digest does not match the data read,
+        // or if there is any data left after the digest.
+        void read_digest() {
+            std::string digest(16, '\0');
+            if (! m_ok || ::fread(digest.data(), digest.size(), 1, m_file) != 1 || digest != m_hasher.digest() || ::fgetc(m_file) != EOF)
+                m_ok = false;
+        }
+        bool ok() const { return m_ok; }
+    private:
+        FILE     *m_file;
+        MD5Hasher m_hasher;
+        bool      m_ok { true };
+    };
+} // namespace
+
+// Fill in the region slices and the lslices of the layers created by slice() from the slice cache.
+// Returns false if the file does not exist or cannot be read, the layers are left without regions in that case.
+bool PrintObject::load_cached_slices(const std::string &path)
+{
+    FilePtr file{ boost::nowide::fopen(path.c_str(), "rb") };
+    if (file.f == nullptr)
+        return false;
+
+    SliceCacheReader reader(file.f);
+    const size_t     num_regions = m_shared_regions->all_regions.size();
+    const size_t     num_layers  = (reader.read<uint32_t>() == SLICE_CACHE_VERSION) ? reader.read_count() : 0;
+    if (! reader.ok() || num_layers == 0 || num_layers > m_layers.size() || reader.read_count() != num_regions)
+        return false;
+    for (size_t layer_id = 0; layer_id < num_layers && reader.ok(); ++ layer_id) {
+        Layer &layer = *m_layers[layer_id];
+        layer.m_regions.clear();
+        for (const std::unique_ptr<PrintRegion> &pr : m_shared_regions->all_regions) {
+            LayerRegion *layerm = new LayerRegion(&layer, pr.get());
+            layer.m_regions.emplace_back(layerm);
+            const size_t num_surfaces = reader.read_count();
+            layerm->m_slices.surfaces.reserve(num_surfaces);
+            for (size_t i = 0; i < num_surfaces && reader.ok(); ++ i) {
+                const auto surface_type = reader.read<SurfaceType>();
+                ExPolygon  expoly;
+                reader.read(expoly);
+                layerm->m_slices.surfaces.emplace_back(surface_type, std::move(expoly));
+            }
+        }
+        layer.m_lslices.resize(reader.read_count());
+        for (ExPolygon &expoly : layer.m_lslices)
+            reader.read(expoly);
+        layer.lslice_indices_sorted_by_print_order.resize(reader.read_count());
+        for (size_t &idx : layer.lslice_indices_sorted_by_print_order)
+            idx = size_t(reader.read<uint64_t>());
+    }
+    reader.read_digest();
+    if (! reader.ok()) {
+        BOOST_LOG_TRIVIAL(warning) << "Slice cache file " << path << " is corrupted, slicing again";
+        // slice_volumes() expects layers without regions.
+        for (Layer *layer : m_layers) {
+            for (LayerRegion *layerm : layer->m_regions)
+                delete layerm;
+            layer->m_regions.clear();
+        }
+        return false;
+    }
+    // slice_volumes() drops the empty layers at the top of the object.
+    while (m_layers.size() > num_layers) {
+        delete m_layers.back();
+        m_layers.pop_back();
+    }
+    m_layers.back()->upper_layer = nullptr;
+    // The modification time of the cache files is the time of their last use, see trim_slice_cache().
+    boost::system::error_code ec;
+    boost::filesystem::last_write_time(path, std::time(nullptr), ec);
+    BOOST_LOG_TRIVIAL(info) << "Slices of " << this->model_object()->name << " loaded from the slice cache " << path;
+    return true;
+}
+
+// Remove the least recently used files of the slice cache until the cache fits into slice_cache_max_size().
+// The file just stored is never removed. Other slicers may modify the directory at the same time,
+// thus the files failing to be queried or removed are skipped.
+static void trim_slice_cache(const boost::filesystem::path &stored_path)
+{
+    struct CacheFile {
+        boost::filesystem::path path;
+        std::time_t             time;
+        uintmax_t               size;
+    };
+    std::vector<CacheFile> files;
+    uintmax_t              total_size = 0;
+    boost::system::error_code ec;
+    for (boost::filesystem::directory_iterator it(stored_path.parent_path(), ec), end; ! ec && it != end; it.increment(ec)) {
+        if (it->path().extension() != ".slices")
+            continue;
+        CacheFile file { it->path(), boost::filesystem::last_write_time(it->path(), ec), 0 };
+        if (! ec)
+            file.size = boost::filesystem::file_size(it->path(), ec);
+        if (ec) {
+            ec.clear();
+            continue;
+        }
+        total_size += file.size;
+        files.emplace_back(std::move(file));
+    }
+    if (total_size <= slice_cache_max_size())
+        return;
+    std::sort(files.begin(), files.end(), [](const CacheFile &l, const CacheFile &r) { return l.time < r.time; });
+    for (const CacheFile &file : files) {
+        if (total_size <= slice_cache_max_size())
+            break;
+        if (file.path != stored_path && boost::filesystem::remove(file.path, ec)) {
+            BOOST_LOG_TRIVIAL(debug) << "Slice cache file " << file.path.string() << " removed to limit the size of the cache";
+            total_size -= file.size;
+        }
+    }
+}
+
+// Store the region slices and the lslices produced by slice() into the slice cache.
+// The file is written under a temporary name first, so that a concurrently running slicer never reads a partial file.
+void PrintObject::store_cached_slices(const std::string &path) const
+{
+    if (m_layers.empty())
+        return;
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(boost::filesystem::path(path).parent_path(), ec);
+    // Unique per writer: the same object may be stored by several threads of this process or by several processes at once.
+    const std::string path_tmp = boost::filesystem::unique_path(path + ".%%%%-%%%%.tmp").string();
+    bool ok = false;
+    {
+        FilePtr file{ boost::nowide::fopen(path_tmp.c_str(), "wb") };
+        if (file.f != nullptr) {
+            SliceCacheWriter writer(file.f);
+            writer.write(SLICE_CACHE_VERSION);
+            writer.write(uint64_t(m_layers.size()));
+            writer.write(uint64_t(m_shared_regions->all_regions.size()));
+            for (const Layer *layer : m_layers) {
+                for (const LayerRegion *layerm : layer->regions()) {
+                    writer.write(uint64_t(layerm->slices().surfaces.size()));
+                    for (const Surface &surface : layerm->slices().surfaces) {
+                        writer.write(surface.surface_type);
+                        writer.write(surface.expolygon);
+                    }
+                }
+                writer.write(uint64_t(layer->lslices().size()));
+                for (const ExPolygon &expoly : layer->lslices())
+                    writer.write(expoly);
+                writer.write(uint64_t(layer->lslice_indices_sorted_by_print_order.size()));
+                for (size_t idx : layer->lslice_indices_sorted_by_print_order)
+                    writer.write(uint64_t(idx));
+            }
+            writer.write_digest();
+            ok = writer.ok();
+        }
+    }
+    if (ok)
+        boost::filesystem::rename(path_tmp, path, ec);
+    if (! ok || ec) {
+        BOOST_LOG_TRIVIAL(warning) << "Failed to store the slice cache file " << path;
+        boost::filesystem::remove(path_tmp, ec);
+    } else
+        trim_slice_cache(path);
+}
+
 // modify the polygon so it doesn't have any concave angle spiker than 90°
 // used by _max_overhang_threshold
 void only_convex_or_gt90deg(Polygon &poly) {
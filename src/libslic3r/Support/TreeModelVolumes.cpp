@@ -23,6 +23,7 @@
 #include "../Utils.hpp"
 #include "../format.hpp"
 
+#include <chrono>
 #include <string_view>
 
 #include <boost/log/trivial.hpp>
@@ -99,6 +100,7 @@ TreeModelVolumes::TreeModelVolumes(
         m_anti_overhang = print_object.slice_support_blockers();
         TreeSupportMeshGroupSettings mesh_settings(print_object);
         const TreeSupportSettings config{ mesh_settings, print_object.slicing_parameters() };
+        m_settings = config;
         m_current_min_xy_dist = config.xy_min_distance;
         m_current_min_xy_dist_delta = config.xy_distance - m_current_min_xy_dist;
         assert(m_current_min_xy_dist_delta >= 0);
@@ -157,6 +159,57 @@ TreeModelVolumes::TreeModelVolumes(
 #endif
 }
 
+void TreeModelVolumes::reuse_caches(TreeModelVolumes &&previous)
+{
+    if (! (m_settings == previous.m_settings) || m_max_move != previous.m_max_move || m_max_move_slow != previous.m_max_move_slow ||
+        m_min_resolution != previous.m_min_resolution || m_support_rests_on_model != previous.m_support_rests_on_model ||
+        m_machine_border != previous.m_machine_border || m_layer_outlines.size() != 1 || previous.m_layer_outlines.size() != 1)
+        return;
+
+    // Find the lowest layer, where the outlines or the support blockers changed.
+    const std::vector<Polygons> &outlines      = m_layer_outlines.front().second;
+    const std::vector<Polygons> &prev_outlines = previous.m_layer_outlines.front().second;
+    size_t first_modified = std::min(outlines.size(), prev_outlines.size());
+    for (size_t layer_idx = 0; layer_idx < first_modified; ++ layer_idx)
+        if (outlines[layer_idx] != prev_outlines[layer_idx]) {
+            first_modified = layer_idx;
+            break;
+        }
+    size_t num_anti_overhang = std::min(m_anti_overhang.size(), previous.m_anti_overhang.size());
+    if (m_anti_overhang.size() != previous.m_anti_overhang.size())
+        first_modified = std::min(first_modified, num_anti_overhang);
+    for (size_t layer_idx = 0; layer_idx < std::min(first_modified, num_anti_overhang); ++ layer_idx)
+        if (m_anti_overhang[layer_idx] != previous.m_anti_overhang[layer_idx]) {
+            first_modified = layer_idx;
+            break;
+        }
+
+    // The collision of a layer depends on the outlines up to z_distance_top_layers above it, the avoidances and placeable areas
+    // are calculated from the collisions bottom up.
+    const TreeSupportMeshGroupSettings &settings = m_layer_outlines.front().first;
+    const int    z_distance_top_layers = int(round(double(settings.support_top_distance) / double(settings.layer_height)));
+    const size_t num_layers_valid      = size_t(std::max(0, int(first_modified) - z_distance_top_layers - 1));
+    BOOST_LOG_TRIVIAL(debug) << "Tree support: reusing the collision caches of " << num_layers_valid << " layers out of " << outlines.size();
+    if (num_layers_valid == 0)
+        return;
+
+    auto reuse = [num_layers_valid](RadiusLayerPolygonCache &dst, RadiusLayerPolygonCache &src) {
+        dst = std::move(src);
+        dst.truncate(num_layers_valid);
+    };
+    reuse(m_collision_cache,                    previous.m_collision_cache);
+    reuse(m_collision_cache_holefree,           previous.m_collision_cache_holefree);
+    reuse(m_avoidance_cache,                    previous.m_avoidance_cache);
+    reuse(m_avoidance_cache_slow,               previous.m_avoidance_cache_slow);
+    reuse(m_avoidance_cache_to_model,           previous.m_avoidance_cache_to_model);
+    reuse(m_avoidance_cache_to_model_slow,      previous.m_avoidance_cache_to_model_slow);
+    reuse(m_placeable_areas_cache,              previous.m_placeable_areas_cache);
+    reuse(m_avoidance_cache_holefree,           previous.m_avoidance_cache_holefree);
+    reuse(m_avoidance_cache_holefree_to_model,  previous.m_avoidance_cache_holefree_to_model);
+    reuse(m_wall_restrictions_cache,            previous.m_wall_restrictions_cache);
+    reuse(m_wall_restrictions_cache_min,        previous.m_wall_restrictions_cache_min);
+}
+
 void TreeModelVolumes::precalculate(const PrintObject& print_object, const coord_t max_layer, std::function<void()> throw_on_cancel)
 {
     auto t_start = std::chrono::high_resolution_clock::now();
@@ -858,24 +911,76 @@ coord_t TreeModelVolumes::ceilRadius(const coord_t radius) const
 
 void TreeModelVolumes::RadiusLayerPolygonCache::allocate_layers(size_t num_layers)
 {
+    {
+        std::shared_lock<std::shared_mutex> guard(m_shards.front().mutex);
+        if (num_layers <= m_data.size())
+            return;
+    }
+    // Growing the vector moves the layers, thus no other thread may access any of them.
+    std::array<std::unique_lock<std::shared_mutex>, NumShards> guards;
+    for (size_t i = 0; i < NumShards; ++ i)
+        guards[i] = std::unique_lock<std::shared_mutex>(m_shards[i].mutex);
     if (num_layers > m_data.size()) {
         if (num_layers > m_data.capacity())
             reserve_power_of_2(m_data, num_layers);
-        m_data.resize(num_layers, {});
+        m_data.resize(num_layers);
     }
 }
 
+std::shared_lock<std::shared_mutex> TreeModelVolumes::RadiusLayerPolygonCache::lock_shared(const Shard &sh)
+{
+    std::shared_lock<std::shared_mutex> guard(sh.mutex, std::try_to_lock);
+    if (! guard.owns_lock()) {
+        auto t_start = std::chrono::steady_clock::now();
+        guard.lock();
+        sh.wait_ns += size_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t_start).count());
+    }
+    return guard;
+}
+
+TreeModelVolumes::RadiusLayerPolygonCache::Statistics TreeModelVolumes::RadiusLayerPolygonCache::statistics() const
+{
+    Statistics out;
+    for (const Shard &sh : m_shards) {
+        out.hits    += sh.hits;
+        out.misses  += sh.misses;
+        out.wait_ns += sh.wait_ns;
+    }
+    return out;
+}
+
 // For debugging purposes, sorted by layer index, then by radius.
 std::vector<std::pair<TreeModelVolumes::RadiusLayerPair, std::reference_wrapper<const Polygons>>> TreeModelVolumes::RadiusLayerPolygonCache::sorted() const
 {
     std::vector<std::pair<RadiusLayerPair, std::reference_wrapper<const Polygons>>> out;
     for (auto &layer : m_data) {
         auto layer_idx = LayerIndex(&layer - m_data.data());
-        for (auto &radius_polygons : layer)
-            out.emplace_back(std::make_pair(radius_polygons.first, layer_idx), radius_polygons.second);
+        for (size_t i = 0; i < layer.radii.size(); ++ i)
+            out.emplace_back(std::make_pair(layer.radii[i], layer_idx), *layer.polygons[i]);
     }
     assert(std::is_sorted(out.begin(), out.end(), [](auto &l, auto &r){ return l.first.second < r.first.second || (l.first.second == r.first.second) && l.first.first < r.first.first; }));
     return out;
 }
 
+void TreeModelVolumes::log_cache_statistics() const
+{
+    auto log = [](const RadiusLayerPolygonCache &cache, std::string_view name) {
+        RadiusLayerPolygonCache::Statistics stats = cache.statistics();
+        if (stats.hits + stats.misses > 0)
+            BOOST_LOG_TRIVIAL(debug) << "Tree support " << name << " cache: " << stats.hits << " hits, " << stats.misses << " misses, "
+                << 0.000001 * double(stats.wait_ns) << " ms waiting for the lock";
+    };
+    log(m_collision_cache,                  "collision");
+    log(m_collision_cache_holefree,         "collision holefree");
+    log(m_avoidance_cache,                  "avoidance");
+    log(m_avoidance_cache_slow,             "avoidance slow");
+    log(m_avoidance_cache_to_model,         "avoidance to model");
+    log(m_avoidance_cache_to_model_slow,    "avoidance to model slow");
+    log(m_placeable_areas_cache,            "placeable areas");
+    log(m_avoidance_cache_holefree,         "avoidance holefree");
+    log(m_avoidance_cache_holefree_to_model,"avoidance holefree to model");
+    log(m_wall_restrictions_cache,          "wall restrictions");
+    log(m_wall_restrictions_cache_min,      "wall restrictions min");
+}
+
 } // namespace Slic3r::FFFTreeSupport
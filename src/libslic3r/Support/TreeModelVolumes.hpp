@@ -13,7 +13,12 @@
 #ifndef slic3r_TreeModelVolumes_hpp
 #define slic3r_TreeModelVolumes_hpp
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
 
 #include <boost/functional/hash.hpp>
@@ -74,6 +79,13 @@ public:
         m_wall_restrictions_cache_min.clear();
     }
 
+    // Take over the collision, avoidance and placeable areas calculated for a previous support generation of the same object.
+    // Only the layers below the lowest layer with modified outlines or support blockers are kept, precalculate() calculates the rest.
+    void reuse_caches(TreeModelVolumes &&previous);
+
+    // Log the hits, misses and lock waiting time of the caches.
+    void log_cache_statistics() const;
+
     enum class AvoidanceType : int8_t
     {
         Slow,
@@ -171,7 +183,6 @@ public:
             this->ceilRadius(radius + m_current_min_xy_dist_delta) - m_current_min_xy_dist_delta;
     }
 
-private:
     // Caching polygons for a range of layers.
     class LayerPolygonCache {
     public:
@@ -200,11 +211,38 @@ private:
      */
     using RadiusLayerPair             = std::pair<coord_t, LayerIndex>;
     class RadiusLayerPolygonCache {
-        // Map from radius to Polygons. Cache of one layer collision regions.
-        using LayerData = std::map<coord_t, Polygons>;
-        // Vector of layers, at each layer map of radius to Polygons.
-        // Reference to Polygons returned shall be stable to insertion.
+        // Cache of one layer collision regions, flat storage indexed by radius.
+        // Radii are sorted, polygons[i] belongs to radii[i]. Polygons are allocated separately,
+        // so that the references returned are stable to insertion.
+        struct LayerData {
+            std::vector<coord_t>                    radii;
+            std::vector<std::unique_ptr<Polygons>>  polygons;
+
+            bool   empty() const { return radii.empty(); }
+            // Index of the first radius not lower than the given radius.
+            size_t lower_bound(coord_t radius) const { return std::lower_bound(radii.begin(), radii.end(), radius) - radii.begin(); }
+            // Like std::map::emplace(), an existing entry is not replaced.
+            void   emplace(coord_t radius, Polygons &&polys) {
+                size_t idx = this->lower_bound(radius);
+                if (idx == radii.size() || radii[idx] != radius) {
+                    radii.insert(radii.begin() + idx, radius);
+                    polygons.insert(polygons.begin() + idx, std::make_unique<Polygons>(std::move(polys)));
+                }
+            }
+        };
+        // Vector of layers, at each layer the collision regions sorted by radius.
         using Layers = std::vector<LayerData>;
+        // Layers are protected by reader / writer locks shared by every NumShards-th layer,
+        // so that lookups running in parallel neither block each other nor the insertions into other layers.
+        // Growing the vector of layers locks all the shards.
+        static constexpr const size_t NumShards = 64;
+        struct alignas(64) Shard {
+            mutable std::shared_mutex   mutex;
+            // Statistics, updated next to the mutex to not touch another cache line.
+            mutable std::atomic<size_t> hits { 0 };
+            mutable std::atomic<size_t> misses { 0 };
+            mutable std::atomic<size_t> wait_ns { 0 };
+        };
     public:
         RadiusLayerPolygonCache() = default;
         RadiusLayerPolygonCache(RadiusLayerPolygonCache &&rhs) : m_data(std::move(rhs.m_data)) {}
@@ -214,28 +252,40 @@ private:
         RadiusLayerPolygonCache& operator=(const RadiusLayerPolygonCache&) = delete;
 
         void insert(std::vector<std::pair<RadiusLayerPair, Polygons>> &&in) {
-            std::lock_guard<std::mutex> guard(m_mutex);
+            LayerIndex max_layer_idx = -1;
             for (auto &d : in)
-                this->get_allocate_layer_data(d.first.second).emplace(d.first.first, std::move(d.second));
+                max_layer_idx = std::max(max_layer_idx, d.first.second);
+            allocate_layers(max_layer_idx + 1);
+            for (auto &d : in) {
+                std::unique_lock<std::shared_mutex> guard(shard(d.first.second).mutex);
+                m_data[d.first.second].emplace(d.first.first, std::move(d.second));
+            }
         }
         // by layer
         void insert(std::vector<std::pair<coord_t, Polygons>> &&in, coord_t radius) {
-            std::lock_guard<std::mutex> guard(m_mutex);
+            LayerIndex max_layer_idx = -1;
             for (auto &d : in)
-                this->get_allocate_layer_data(d.first).emplace(radius, std::move(d.second));
+                max_layer_idx = std::max(max_layer_idx, LayerIndex(d.first));
+            allocate_layers(max_layer_idx + 1);
+            for (auto &d : in) {
+                std::unique_lock<std::shared_mutex> guard(shard(d.first).mutex);
+                m_data[d.first].emplace(radius, std::move(d.second));
+            }
         }
         void insert(std::vector<Polygons> &&in, coord_t first_layer_idx, coord_t radius) {
-            std::lock_guard<std::mutex> guard(m_mutex);
             allocate_layers(first_layer_idx + in.size());
-            for (auto &d : in)
+            for (auto &d : in) {
+                std::unique_lock<std::shared_mutex> guard(shard(first_layer_idx).mutex);
                 m_data[first_layer_idx ++].emplace(radius, std::move(d));
+            }
         }
         void insert(LayerPolygonCache &&in, coord_t radius) {
-            std::lock_guard<std::mutex> guard(m_mutex);
             LayerIndex i = in.begin();
             allocate_layers(i + LayerIndex(in.size()));
-            for (auto &d : in.polygons_mutable())
+            for (auto &d : in.polygons_mutable()) {
+                std::unique_lock<std::shared_mutex> guard(shard(i).mutex);
                 m_data[i ++].emplace(radius, std::move(d));
+            }
         }
         /*!
          * \brief Checks a cache for a given RadiusLayerPair and returns it if it is found
@@ -243,33 +293,43 @@ private:
          * \return A wrapped optional reference of the requested area (if it was found, an empty optional if nothing was found)
          */
         std::optional<std::reference_wrapper<const Polygons>> getArea(const TreeModelVolumes::RadiusLayerPair &key) const {
-            std::lock_guard<std::mutex> guard(m_mutex);
+            const Shard &sh = shard(key.second);
+            std::shared_lock<std::shared_mutex> guard = lock_shared(sh);
 
-            if (key.second >= LayerIndex(m_data.size()))
+            if (key.second >= LayerIndex(m_data.size())) {
+                ++ sh.misses;
                 return std::nullopt;
+            }
 
             const LayerData &layer = m_data[key.second];
-            auto it = layer.find(key.first);
-            if (it == layer.end())
+            size_t idx = layer.lower_bound(key.first);
+            if (idx == layer.radii.size() || layer.radii[idx] != key.first) {
+                ++ sh.misses;
                 return std::nullopt;
+            }
 
-            return std::optional<std::reference_wrapper<const Polygons>>{it->second};
+            ++ sh.hits;
+            return std::optional<std::reference_wrapper<const Polygons>>{ *layer.polygons[idx] };
         }
         // Get a collision area at a given layer for a radius that is a lower or equial to the key radius.
         std::optional<std::pair<coord_t, std::reference_wrapper<const Polygons>>> get_lower_bound_area(const TreeModelVolumes::RadiusLayerPair &key) const {
-            std::lock_guard<std::mutex> guard(m_mutex);
-            if (key.second >= LayerIndex(m_data.size()))
+            const Shard &sh = shard(key.second);
+            std::shared_lock<std::shared_mutex> guard = lock_shared(sh);
+            if (key.second >= LayerIndex(m_data.size()) || m_data[key.second].empty()) {
+                ++ sh.misses;
                 return {};
-            const auto &layer = m_data[key.second];
-            if (layer.empty())
-                return {};
-            auto it = layer.lower_bound(key.first);
-            if (it == layer.end() || it->first != key.first) {
-                if (it == layer.begin())
+            }
+            const LayerData &layer = m_data[key.second];
+            size_t idx = layer.lower_bound(key.first);
+            if (idx == layer.radii.size() || layer.radii[idx] != key.first) {
+                if (idx == 0) {
+                    ++ sh.misses;
                     return {};
-                -- it;
+                }
+                -- idx;
             }
-            return std::make_pair(it->first, std::reference_wrapper<const Polygons>(it->second));
+            ++ sh.hits;
+            return std::make_pair(layer.radii[idx], std::reference_wrapper<const Polygons>(*layer.polygons[idx]));
         }
         /*!
          * \brief Get the highest already calculated layer in the cache.
@@ -279,11 +339,18 @@ private:
          * \return A wrapped optional reference of the requested area (if it was found, an empty optional if nothing was found)
          */
         LayerIndex getMaxCalculatedLayer(coord_t radius) const {
-            std::lock_guard<std::mutex> guard(m_mutex);
-            auto layer_idx = LayerIndex(m_data.size()) - 1;
-            for (; layer_idx > 0; -- layer_idx)
-                if (const auto &layer = m_data[layer_idx]; layer.find(radius) != layer.end())
+            // The layers are only added, thus the layers below num_layers stay valid.
+            LayerIndex num_layers;
+            {
+                std::shared_lock<std::shared_mutex> guard = lock_shared(shard(0));
+                num_layers = LayerIndex(m_data.size());
+            }
+            auto layer_idx = num_layers - 1;
+            for (; layer_idx > 0; -- layer_idx) {
+                std::shared_lock<std::shared_mutex> guard = lock_shared(shard(layer_idx));
+                if (const LayerData &layer = m_data[layer_idx]; std::binary_search(layer.radii.begin(), layer.radii.end(), radius))
                     break;
+            }
             // The placeable on model areas do not exist on layer 0, as there can not be model below it. As such it may be possible that layer 1 is available, but layer 0 does not exist.
             return layer_idx == 0 ? -1 : layer_idx;
         }
@@ -291,27 +358,39 @@ private:
         // For debugging purposes, sorted by layer index, then by radius.
         [[nodiscard]] std::vector<std::pair<RadiusLayerPair, std::reference_wrapper<const Polygons>>> sorted() const;
 
+        struct Statistics {
+            size_t hits     { 0 };
+            size_t misses   { 0 };
+            // Time spent waiting for the locks, in nanoseconds.
+            size_t wait_ns  { 0 };
+        };
+        Statistics statistics() const;
+
         void clear() { m_data.clear(); }
+        // Keep the first num_layers layers only.
+        void truncate(size_t num_layers) {
+            if (num_layers < m_data.size())
+                m_data.erase(m_data.begin() + num_layers, m_data.end());
+        }
         void clear_all_but_radius0() { 
-            for (LayerData &l : m_data) {
-                auto begin = l.begin();
-                auto end = l.end();
-                if (begin != end && ++ begin != end)
-                    l.erase(begin, end);
-            }
+            for (LayerData &l : m_data)
+                if (l.radii.size() > 1) {
+                    l.radii.erase(l.radii.begin() + 1, l.radii.end());
+                    l.polygons.erase(l.polygons.begin() + 1, l.polygons.end());
+                }
         }
 
     private:
-        LayerData&          get_allocate_layer_data(LayerIndex layer_idx) {
-            allocate_layers(layer_idx + 1);
-            return m_data[layer_idx];
-        }
+        Shard&              shard(LayerIndex layer_idx) const { return m_shards[size_t(layer_idx) % NumShards]; }
+        // Counts the time spent waiting only if the lock is contended.
+        static std::shared_lock<std::shared_mutex> lock_shared(const Shard &sh);
         void                allocate_layers(size_t num_layers);
 
-        Layers              m_data;
-        mutable std::mutex  m_mutex;
+        Layers                              m_data;
+        mutable std::array<Shard, NumShards> m_shards;
     };
 
+private:
 
     /*!
      * \brief Provides the areas that have to be avoided by the tree's branches to prevent collision with the model on this layer. Holes are removed.
@@ -436,6 +515,8 @@ private:
     coord_t m_min_resolution;
 
     bool m_precalculated = false;
+    // Settings the caches were calculated with, to test whether the caches may be reused.
+    TreeSupportSettings m_settings;
     /*!
      * \brief The index to access the outline corresponding with the currently processing mesh
      */
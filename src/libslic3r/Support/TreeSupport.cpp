@@ -3568,6 +3568,12 @@ static void generate_support_areas(Print &print,
 #endif // SLIC3R_TREESUPPORTS_PROGRESS
             /* additional_excluded_areas */{} };
 
+        // Reuse the collision caches of the previous support generation of this object below the modified layers.
+        if (std::shared_ptr<TreeModelVolumes> &cached_volumes = print_object.tree_support_volumes_cache(); cached_volumes) {
+            volumes.reuse_caches(std::move(*cached_volumes));
+            cached_volumes.reset();
+        }
+
         //FIXME generating overhangs just for the furst mesh of the group.
         assert(processing.second.size() == 1);
         std::vector<Polygons>      overhangs = generate_overhangs(config, *print.get_object(processing.second.front()), throw_on_cancel);
@@ -3687,6 +3693,7 @@ static void generate_support_areas(Print &print,
                 "Influence area creation: " << dur_path << "ms "
                 "Placement of Points in InfluenceAreas: " << dur_place << "ms "
                 "Drawing result as support " << dur_draw << " ms";
+            volumes.log_cache_statistics();
     //        if (config.branch_radius==2121)
     //            BOOST_LOG_TRIVIAL(error) << "Why ask questions when you already know the answer twice.\n (This is not a real bug, please dont report it.)";
 
@@ -3697,6 +3704,9 @@ static void generate_support_areas(Print &print,
             // No raft.
             continue;
 
+        // Keep the collision caches for the next support generation of this object.
+        print_object.tree_support_volumes_cache() = std::make_shared<TreeModelVolumes>(std::move(volumes));
+
         // Produce the support G-code.
         // Used by both classic and tree supports.
         SupportGeneratorLayersPtr raft_layers = generate_raft_base(print_object, support_params, print_object.slicing_parameters(),
@@ -16,6 +16,7 @@
 #include <boost/filesystem.hpp>
 #include <boost/system/error_code.hpp>
 #include <boost/filesystem/path.hpp>
+#include <boost/uuid/detail/md5.hpp>
 
 #include "libslic3r.h"
 
@@ -35,6 +36,8 @@ extern std::string log_memory_info(bool ignore_loglevel = false);
 extern void enforce_thread_count(std::size_t count);
 // Returns the size of physical memory (RAM) in bytes.
 extern size_t total_physical_memory();
+// Returns the peak resident memory of this process in bytes, zero if not available.
+extern size_t peak_memory_usage();
 
 // Set a path with GUI resource files.
 void set_var_dir(const std::string &path);
@@ -71,6 +74,14 @@ void set_data_dir(const std::string &path);
 // Return a full path to the GUI resource files.
 const std::string& data_dir();
 
+// Set a directory of the persistent cache of sliced objects, an empty path disables the cache.
+// The least recently used files are removed once the files in the directory exceed max_size bytes.
+void set_slice_cache_dir(const std::string &path, size_t max_size = size_t(1) << 30);
+// Return a full path to the slice cache directory, empty if the cache is disabled.
+const std::string& slice_cache_dir();
+// Return the maximum size of the slice cache directory in bytes.
+size_t slice_cache_max_size();
+
 // Format an output path for debugging purposes.
 // Writes out the output path prefix to the console for the first time the function is called,
 // so the user knows where to search for the debugging output.
@@ -311,6 +322,21 @@ struct FilePtr {
     FILE* f = nullptr;
 };
 
+// MD5 fingerprint of binary blocks, used as a key of the caches of results computed from meshes, polygons and configs.
+// Each block is prefixed with its size, so that moving data from one block to the next changes the fingerprint.
+class MD5Hasher
+{
+public:
+    void process(const void *data, size_t size);
+    // The 16 bytes of the digest as a binary string, to be used as a key of an in memory cache.
+    std::string digest();
+    // The digest as a string of hexadecimal digits, to be used as a file name.
+    std::string hex_digest();
+
+private:
+    boost::uuids::detail::md5 m_md5;
+};
+
 class ScopeGuard
 {
 public:
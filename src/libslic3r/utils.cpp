@@ -47,6 +47,7 @@
 
 #include <boost/locale.hpp>
 
+#include <boost/algorithm/hex.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/path.hpp>
@@ -242,6 +243,48 @@ const std::string& data_dir()
     return g_data_dir;
 }
 
+static std::string g_slice_cache_dir;
+static size_t      g_slice_cache_max_size = 0;
+
+void set_slice_cache_dir(const std::string &dir, size_t max_size)
+{
+    g_slice_cache_dir      = dir.empty() ? std::string() : boost::filesystem::path(dir).make_preferred().string();
+    g_slice_cache_max_size = max_size;
+}
+
+const std::string& slice_cache_dir()
+{
+    return g_slice_cache_dir;
+}
+
+size_t slice_cache_max_size()
+{
+    return g_slice_cache_max_size;
+}
+
+void MD5Hasher::process(const void *data, size_t size)
+{
+    uint64_t size64 = size;
+    m_md5.process_bytes(&size64, sizeof(size64));
+    m_md5.process_bytes(data, size);
+}
+
+std::string MD5Hasher::digest()
+{
+    boost::uuids::detail::md5::digest_type digest{};
+    m_md5.get_digest(digest);
+    return std::string(reinterpret_cast<const char*>(&digest[0]), sizeof(digest));
+}
+
+std::string MD5Hasher::hex_digest()
+{
+    boost::uuids::detail::md5::digest_type digest{};
+    m_md5.get_digest(digest);
+    std::string out;
+    boost::algorithm::hex(digest, digest + std::size(digest), std::back_inserter(out));
+    return out;
+}
+
 std::string custom_shapes_dir()
 {
     return (boost::filesystem::path(g_data_dir) / "shapes").string();
@@ -1374,6 +1417,25 @@ std::string log_memory_info(bool ignore_loglevel)
     return out;
 }
 
+size_t peak_memory_usage()
+{
+#ifdef WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        return size_t(pmc.PeakWorkingSetSize);
+#elif defined(__linux__) or defined(__APPLE__)
+    rusage memory_info;
+    if (getrusage(RUSAGE_SELF, &memory_info) == 0) {
+        size_t peak_mem_usage = (size_t)memory_info.ru_maxrss;
+    #ifdef __linux__
+        peak_mem_usage *= 1024; // getrusage returns the value in kB on linux
+    #endif
+        return peak_mem_usage;
+    }
+#endif
+    return 0;
+}
+
 // Returns the size of physical memory (RAM) in bytes.
 // http://nadeausoftware.com/articles/2012/09/c_c_tip_how_get_physical_memory_size_system
 size_t total_physical_memory()
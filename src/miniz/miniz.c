@@ -6885,6 +6885,91 @@ mz_bool mz_zip_writer_add_staged_data(mz_zip_writer_staged_context *pContext, co
     return MZ_FALSE;
 }
 
+static mz_uint32 mz_zip_gf2_matrix_times(const mz_uint32 *pMat, mz_uint32 vec)
+{
+    mz_uint32 sum = 0;
+    for (; vec; vec >>= 1, ++pMat)
+        if (vec & 1)
+            sum ^= *pMat;
+    return sum;
+}
+
+static void mz_zip_gf2_matrix_square(mz_uint32 *pSquare, const mz_uint32 *pMat)
+{
+    int n;
+    for (n = 0; n < 32; ++n)
+        pSquare[n] = mz_zip_gf2_matrix_times(pMat, pMat[n]);
+}
+
+/* CRC-32 of two consecutive blocks from the CRC-32 of the first block, the CRC-32 of the second block and its length, as crc32_combine() of zlib. */
+static mz_uint32 mz_zip_crc32_combine(mz_uint32 crc1, mz_uint32 crc2, mz_uint64 len2)
+{
+    mz_uint32 even[32], odd[32], row = 1;
+    int n;
+
+    if (len2 == 0)
+        return crc1;
+
+    /* Operator for one zero bit in odd. */
+    odd[0] = 0xEDB88320;
+    for (n = 1; n < 32; ++n, row <<= 1)
+        odd[n] = row;
+
+    /* Operators for two and four zero bits. */
+    mz_zip_gf2_matrix_square(even, odd);
+    mz_zip_gf2_matrix_square(odd, even);
+
+    /* Apply len2 zeros to crc1, the first squaring puts the operator for one zero byte in even. */
+    do
+    {
+        mz_zip_gf2_matrix_square(even, odd);
+        if (len2 & 1)
+            crc1 = mz_zip_gf2_matrix_times(even, crc1);
+        len2 >>= 1;
+        if (len2 == 0)
+            break;
+
+        mz_zip_gf2_matrix_square(odd, even);
+        if (len2 & 1)
+            crc1 = mz_zip_gf2_matrix_times(odd, crc1);
+        len2 >>= 1;
+    } while (len2 != 0);
+
+    return crc1 ^ crc2;
+}
+
+mz_bool mz_zip_writer_add_staged_compressed_data(mz_zip_writer_staged_context *pContext, const void *pComp_buf, size_t comp_size, mz_uint64 uncomp_size, mz_uint32 uncomp_crc32)
+{
+    mz_zip_error error = MZ_ZIP_NO_ERROR;
+
+    if (!pContext->pCompressor)
+        return MZ_FALSE;
+
+    if (pContext->file_ofs + uncomp_size > pContext->max_size)
+        error = MZ_ZIP_FILE_READ_FAILED;
+    /* Terminate the data compressed so far at a byte boundary and reset the dictionary, */
+    /* so that the data compressed after the appended piece do not reference the data before it. */
+    else if (tdefl_compress_buffer(pContext->pCompressor, NULL, 0, TDEFL_FULL_FLUSH) != TDEFL_STATUS_OKAY)
+        error = MZ_ZIP_COMPRESSION_FAILED;
+    else if (comp_size > 0 && pContext->pZip->m_pWrite(pContext->pZip->m_pIO_opaque, pContext->add_state.m_cur_archive_file_ofs, pComp_buf, comp_size) != comp_size)
+        error = MZ_ZIP_FILE_WRITE_FAILED;
+
+    if (error != MZ_ZIP_NO_ERROR)
+    {
+        mz_zip_set_error(pContext->pZip, error);
+        pContext->pZip->m_pFree(pContext->pZip->m_pAlloc_opaque, pContext->pCompressor);
+        pContext->pCompressor = NULL;
+        return MZ_FALSE;
+    }
+
+    pContext->add_state.m_cur_archive_file_ofs += comp_size;
+    pContext->add_state.m_comp_size += comp_size;
+    pContext->file_ofs += uncomp_size;
+    pContext->uncomp_crc32 = mz_zip_crc32_combine(pContext->uncomp_crc32, uncomp_crc32, uncomp_size);
+
+    return MZ_TRUE;
+}
+
 mz_bool mz_zip_writer_add_staged_finish(mz_zip_writer_staged_context *pContext)
 {
     if (! mz_zip_writer_add_staged_data(pContext, NULL, 0) ||
@@ -1360,6 +1360,9 @@ mz_bool mz_zip_writer_add_staged_open(mz_zip_archive* pZip, mz_zip_writer_staged
     mz_uint64 max_size, const MZ_TIME_T* pFile_time, const void* pComment, mz_uint16 comment_size, mz_uint level_and_flags,
     const char* user_extra_data, mz_uint user_extra_data_len, const char* user_extra_data_central, mz_uint user_extra_data_central_len);
 mz_bool mz_zip_writer_add_staged_data(mz_zip_writer_staged_context* pContext, const char* pRead_buf, size_t n);
+/* Adds a piece of the file compressed separately, for example in parallel to the other pieces. pComp_buf is a raw deflate stream */
+/* without the final block, ending at a byte boundary (terminated by TDEFL_FULL_FLUSH), of uncomp_size bytes of data with CRC-32 uncomp_crc32. */
+mz_bool mz_zip_writer_add_staged_compressed_data(mz_zip_writer_staged_context* pContext, const void* pComp_buf, size_t comp_size, mz_uint64 uncomp_size, mz_uint32 uncomp_crc32);
 mz_bool mz_zip_writer_add_staged_finish(mz_zip_writer_staged_context* pContext);
 
 /* Adds a file to an archive by fully cloning the data from another archive. */
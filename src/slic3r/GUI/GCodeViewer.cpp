@@ -41,6 +41,8 @@
 #include <boost/nowide/fstream.hpp>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/ini_parser.hpp>
+#include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/blocked_range.h>
 #include <wx/progdlg.h>
 #include <wx/numformatter.h>
 
@@ -1560,12 +1562,12 @@ void GCodeViewer::refresh(const GCodeProcessorResult& gcode_result, const std::v
 
     // update ranges for coloring / legend
     m_extrusions.reset_ranges();
-    for (size_t i = 0; i < m_moves_count; ++i) {
+    for (GCodeMoves::const_iterator it = gcode_result.moves.begin(); it != gcode_result.moves.end(); ++it) {
         // skip first vertex
-        if (i == 0)
+        if (it.index() == 0)
             continue;
 
-        const GCodeProcessorResult::MoveVertex& curr = gcode_result.moves[i];
+        const GCodeProcessorResult::MoveVertex curr = *it;
 
         switch (curr.type)
         {
@@ -1971,6 +1973,99 @@ void GCodeViewer::export_toolpaths_to_obj(const char* filename) const
     fclose(fp);
 }
 
+void GCodeViewer::generate_toolpaths_vertices(const GCodeMoves& moves, const std::vector<ToolpathSegment>& segments,
+    const std::vector<size_t>& chunks, std::vector<std::vector<float>>& vertex_buffers)
+{
+    // max number of segments processed by a single task, layers containing more segments are split
+    static const size_t MAX_SEGMENTS_PER_TASK = 16384;
+
+    auto store_position = [](float* dst, const Vec3f& position) {
+        dst[0] = position.x();
+        dst[1] = position.y();
+        dst[2] = position.z();
+    };
+    auto store_vertex = [](float* dst, const Vec3f& position, const Vec3f& normal) {
+        // position
+        dst[0] = position.x();
+        dst[1] = position.y();
+        dst[2] = position.z();
+        // normal
+        dst[3] = normal.x();
+        dst[4] = normal.y();
+        dst[5] = normal.z();
+    };
+
+    auto generate_segment = [&](const ToolpathSegment& segment) {
+        assert(segment.move > 0);
+        assert(segment.vbuffer_id < vertex_buffers.size());
+        assert(segment.offset + segment.size_floats() <= vertex_buffers[segment.vbuffer_id].size());
+        float* dst = vertex_buffers[segment.vbuffer_id].data() + segment.offset;
+        const Vec3f prev = moves.position(segment.move - 1);
+        const Vec3f curr = moves.position(segment.move);
+
+        if (segment.type == ToolpathSegment::EType::Line) {
+            store_position(dst, prev);
+            store_position(dst + 3, curr);
+            return;
+        }
+
+        const Vec3f dir = (curr - prev).normalized();
+        const Vec3f right = Vec3f(dir.y(), -dir.x(), 0.0f).normalized();
+        const Vec3f left = -right;
+        const Vec3f up = right.cross(dir);
+        const Vec3f down = -up;
+        const Vec3f prev_pos = prev - segment.half_height * up;
+        const Vec3f curr_pos = curr - segment.half_height * up;
+        const Vec3f d_up = segment.half_height * up;
+        const Vec3f d_down = -segment.half_height * up;
+        const Vec3f d_right = segment.half_width * right;
+        const Vec3f d_left = -segment.half_width * right;
+
+        // vertices 1st endpoint
+        if (segment.type == ToolpathSegment::EType::SolidFirst) {
+            // 1st segment or restart into a new vertex buffer
+            // ===============================================
+            store_vertex(dst, prev_pos + d_up, up);         dst += 6;
+            store_vertex(dst, prev_pos + d_right, right);   dst += 6;
+            store_vertex(dst, prev_pos + d_down, down);     dst += 6;
+            store_vertex(dst, prev_pos + d_left, left);     dst += 6;
+        }
+        else {
+            // any other segment
+            // =================
+            store_vertex(dst, prev_pos + d_right, right);   dst += 6;
+            store_vertex(dst, prev_pos + d_left, left);     dst += 6;
+        }
+
+        // vertices 2nd endpoint
+        store_vertex(dst, curr_pos + d_up, up);             dst += 6;
+        store_vertex(dst, curr_pos + d_right, right);       dst += 6;
+        store_vertex(dst, curr_pos + d_down, down);         dst += 6;
+        store_vertex(dst, curr_pos + d_left, left);
+    };
+
+    // ranges of segments processed by the tasks: one per layer, the layers with many segments are split
+    std::vector<std::pair<size_t, size_t>> ranges;
+    ranges.reserve(chunks.size());
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        const size_t end = (i + 1 < chunks.size()) ? chunks[i + 1] : segments.size();
+        for (size_t begin = chunks[i]; begin < end; begin += MAX_SEGMENTS_PER_TASK) {
+            ranges.emplace_back(begin, std::min(begin + MAX_SEGMENTS_PER_TASK, end));
+        }
+    }
+    if (chunks.empty() && !segments.empty())
+        ranges.emplace_back(0, segments.size());
+
+    // each segment writes its own vertices only, at an offset assigned beforehand, so no synchronization is needed
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, ranges.size()), [&](const tbb::blocked_range<size_t>& range) {
+        for (size_t i = range.begin(); i < range.end(); ++i) {
+            for (size_t j = ranges[i].first; j < ranges[i].second; ++j) {
+                generate_segment(segments[j]);
+            }
+        }
+    });
+}
+
 void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result)
 {
     // max index buffer size, in bytes
@@ -1992,19 +2087,11 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result)
         log_memory_used(label, vertices_size + indices_size);
     };
 
-    // format data into the buffers to be rendered as lines
-    auto add_vertices_as_line = [](const GCodeProcessorResult::MoveVertex& prev, const GCodeProcessorResult::MoveVertex& curr, VertexBuffer& vertices) {
-        auto add_vertex = [&vertices](const GCodeProcessorResult::MoveVertex& vertex) {
-            // add position
-            vertices.push_back(vertex.position.x());
-            vertices.push_back(vertex.position.y());
-            vertices.push_back(vertex.position.z());
-        };
-
-        // add previous vertex
-        add_vertex(prev);
-        // add current vertex
-        add_vertex(curr);
+    // place the segment into the buffers to be rendered as lines,
+    // its vertices are generated later by generate_toolpaths_vertices()
+    auto place_segment_as_line = [](unsigned int vbuffer_id, size_t& vbuffer_size, size_t move, std::vector<ToolpathSegment>& segments) {
+        segments.push_back({ static_cast<uint32_t>(move), vbuffer_id, static_cast<uint32_t>(vbuffer_size), 0.0f, 0.0f, ToolpathSegment::EType::Line });
+        vbuffer_size += segments.back().size_floats();
     };
     auto add_indices_as_line = [this](const GCodeProcessorResult::MoveVertex& prev, const GCodeProcessorResult::MoveVertex& curr, TBuffer& buffer,
         unsigned int ibuffer_id, IndexBuffer& indices, size_t move_id) {
@@ -2026,64 +2113,23 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result)
             last_path.sub_paths.back().last = { ibuffer_id, indices.size() - 1, move_id, curr.position };
     };
 
-    // format data into the buffers to be rendered as solid
-    auto add_vertices_as_solid = [this](const GCodeProcessorResult::MoveVertex& prev, const GCodeProcessorResult::MoveVertex& curr, TBuffer& buffer,
-        unsigned int vbuffer_id, VertexBuffer& vertices, size_t move_id) {
-        auto store_vertex = [this](VertexBuffer& vertices, const Vec3f& position, const Vec3f& normal) {
-            // append position
-            vertices.push_back(position.x());
-            vertices.push_back(position.y());
-            vertices.push_back(position.z());
-            // append normal
-            vertices.push_back(normal.x());
-            vertices.push_back(normal.y());
-            vertices.push_back(normal.z());
-        };
-
+    // place the segment into the buffers to be rendered as solid, updating the paths,
+    // its vertices are generated later by generate_toolpaths_vertices()
+    auto place_segment_as_solid = [this](const GCodeProcessorResult::MoveVertex& prev, const GCodeProcessorResult::MoveVertex& curr, TBuffer& buffer,
+        unsigned int vbuffer_id, size_t& vbuffer_size, size_t move_id, size_t move, std::vector<ToolpathSegment>& segments) {
         if (buffer.paths.empty() || prev.type != curr.type || !buffer.paths.back().matches(curr, m_extrusions.ranges, m_current_mode)) {
-            buffer.add_path(curr, vbuffer_id, vertices.size(), move_id - 1);
+            buffer.add_path(curr, vbuffer_id, vbuffer_size, move_id - 1);
             buffer.paths.back().sub_paths.back().first.position = prev.position;
         }
 
         Path& last_path = buffer.paths.back();
+        // 1st segment or restart into a new vertex buffer
+        const bool first = last_path.vertices_count() == 1 || vbuffer_size == 0;
+        segments.push_back({ static_cast<uint32_t>(move), vbuffer_id, static_cast<uint32_t>(vbuffer_size), 0.5f * last_path.width, 0.5f * last_path.height,
+            first ? ToolpathSegment::EType::SolidFirst : ToolpathSegment::EType::Solid });
+        vbuffer_size += segments.back().size_floats();
 
-        const Vec3f dir = (curr.position - prev.position).normalized();
-        const Vec3f right = Vec3f(dir.y(), -dir.x(), 0.0f).normalized();
-        const Vec3f left = -right;
-        const Vec3f up = right.cross(dir);
-        const Vec3f down = -up;
-        const float half_width = 0.5f * last_path.width;
-        const float half_height = 0.5f * last_path.height;
-        const Vec3f prev_pos = prev.position - half_height * up;
-        const Vec3f curr_pos = curr.position - half_height * up;
-        const Vec3f d_up = half_height * up;
-        const Vec3f d_down = -half_height * up;
-        const Vec3f d_right = half_width * right;
-        const Vec3f d_left = -half_width * right;
-
-        // vertices 1st endpoint
-        if (last_path.vertices_count() == 1 || vertices.empty()) {
-            // 1st segment or restart into a new vertex buffer
-            // ===============================================
-            store_vertex(vertices, prev_pos + d_up, up);
-            store_vertex(vertices, prev_pos + d_right, right);
-            store_vertex(vertices, prev_pos + d_down, down);
-            store_vertex(vertices, prev_pos + d_left, left);
-        }
-        else {
-            // any other segment
-            // =================
-            store_vertex(vertices, prev_pos + d_right, right);
-            store_vertex(vertices, prev_pos + d_left, left);
-        }
-
-        // vertices 2nd endpoint
-        store_vertex(vertices, curr_pos + d_up, up);
-        store_vertex(vertices, curr_pos + d_right, right);
-        store_vertex(vertices, curr_pos + d_down, down);
-        store_vertex(vertices, curr_pos + d_left, left);
-
-        last_path.sub_paths.back().last = { vbuffer_id, vertices.size(), move_id, curr.position };
+        last_path.sub_paths.back().last = { vbuffer_id, vbuffer_size, move_id, curr.position };
     };
     auto add_indices_as_solid = [&](const GCodeProcessorResult::MoveVertex& prev, const GCodeProcessorResult::MoveVertex& curr,
         const GCodeProcessorResult::MoveVertex* next, TBuffer& buffer, size_t& vbuffer_size, unsigned int ibuffer_id,
@@ -2283,7 +2329,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result)
 
 #if ENABLE_GCODE_VIEWER_STATISTICS
     auto start_time = std::chrono::high_resolution_clock::now();
-    m_statistics.results_size = SLIC3R_STDVEC_MEMSIZE(gcode_result.moves, GCodeProcessorResult::MoveVertex);
+    m_statistics.results_size = gcode_result.moves.memsize();
     m_statistics.results_time = gcode_result.time;
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
 
@@ -2305,14 +2351,15 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result)
 
     wxBusyCursor busy;
 
-    // extract approximate paths bounding box from result
-    for (const GCodeProcessorResult::MoveVertex& move : gcode_result.moves) {
+    // extract approximate paths bounding box from result, decode the needed columns only
+    const GCodeMoves& moves = gcode_result.moves;
+    for (size_t i = 0; i < m_moves_count; ++i) {
         if (wxGetApp().is_gcode_viewer())
             // for the gcode viewer we need to take in account all moves to correctly size the printbed
-            m_paths_bounding_box.merge(move.position.cast<double>());
+            m_paths_bounding_box.merge(moves.position(i).cast<double>());
         else {
-            if (move.type == EMoveType::Extrude && move.extrusion_role != GCodeExtrusionRole::Custom && move.width != 0.0f && move.height != 0.0f)
-                m_paths_bounding_box.merge(move.position.cast<double>());
+            if (moves.type(i) == EMoveType::Extrude && moves.extrusion_role(i) != GCodeExtrusionRole::Custom && moves.width(i) != 0.0f && moves.height(i) != 0.0f)
+                m_paths_bounding_box.merge(moves.position(i).cast<double>());
         }
     }
 
@@ -2322,13 +2369,18 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result)
     m_cog.reset();
 
     m_sequential_view.gcode_ids.clear();
-    for (size_t i = 0; i < gcode_result.moves.size(); ++i) {
-        const GCodeProcessorResult::MoveVertex& move = gcode_result.moves[i];
-        if (move.type != EMoveType::Seam)
-            m_sequential_view.gcode_ids.push_back(move.gcode_id);
+    for (size_t i = 0; i < m_moves_count; ++i) {
+        if (moves.type(i) != EMoveType::Seam)
+            m_sequential_view.gcode_ids.push_back(moves.gcode_id(i));
     }
 
     std::vector<MultiVertexBuffer> vertices(m_buffers.size());
+    // sizes, in floats, of the vertex buffers, the vertex buffers of lines and triangles are filled once all their segments are placed
+    std::vector<std::vector<size_t>> vertices_sizes(m_buffers.size());
+    std::vector<std::vector<ToolpathSegment>> segments(m_buffers.size());
+    // indices into segments of the 1st segment of each layer
+    std::vector<std::vector<size_t>> segments_chunks(m_buffers.size());
+    std::vector<int> segments_chunks_layer(m_buffers.size(), -1);
     std::vector<MultiIndexBuffer> indices(m_buffers.size());
     std::vector<InstanceBuffer> instances(m_buffers.size());
     std::vector<InstanceIdBuffer> instances_ids(m_buffers.size());
@@ -2337,9 +2389,14 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result)
 
     std::vector<size_t> biased_seams_ids;
 
-    // toolpaths data -> extract vertices from result
-    for (size_t i = 0; i < m_moves_count; ++i) {
-        const GCodeProcessorResult::MoveVertex& curr = gcode_result.moves[i];
+    // toolpaths data -> place segments and extract vertices of models from result
+    // the moves are decoded sequentially, each of them once
+    GCodeProcessorResult::MoveVertex prev;
+    GCodeProcessorResult::MoveVertex curr;
+    for (GCodeMoves::const_iterator it = moves.begin(); it != moves.end(); ++it) {
+        const size_t i = it.index();
+        prev = curr;
+        curr = *it;
         if (curr.type == EMoveType::Noop)
             continue;
         if (curr.type == EMoveType::Seam)
@@ -2351,8 +2408,6 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result)
         if (i == 0)
             continue;
 
-        const GCodeProcessorResult::MoveVertex& prev = gcode_result.moves[i - 1];
-
         if (curr.type == EMoveType::Extrude &&
             curr.extrusion_role != GCodeExtrusionRole::Skirt &&
             curr.extrusion_role != GCodeExtrusionRole::SupportMaterial &&
@@ -2377,19 +2432,23 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result)
         const unsigned char id = buffer_id(curr.type);
         TBuffer& t_buffer = m_buffers[id];
         MultiVertexBuffer& v_multibuffer = vertices[id];
+        std::vector<size_t>& v_sizes = vertices_sizes[id];
         InstanceBuffer& inst_buffer = instances[id];
         InstanceIdBuffer& inst_id_buffer = instances_ids[id];
         InstancesOffsets& inst_offsets = instances_offsets[id];
 
         // ensure there is at least one vertex buffer
-        if (v_multibuffer.empty())
+        if (v_multibuffer.empty()) {
             v_multibuffer.push_back(VertexBuffer());
+            v_sizes.push_back(0);
+        }
 
         // if adding the vertices for the current segment exceeds the threshold size of the current vertex buffer
         // add another vertex buffer
         size_t vertices_size_to_add = (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::BatchedModel) ? t_buffer.model.data.vertices_size_bytes() : t_buffer.max_vertices_per_segment_size_bytes();
-        if (v_multibuffer.back().size() * sizeof(float) > t_buffer.vertices.max_size_bytes() - vertices_size_to_add) {
+        if (v_sizes.back() * sizeof(float) > t_buffer.vertices.max_size_bytes() - vertices_size_to_add) {
             v_multibuffer.push_back(VertexBuffer());
+            v_sizes.push_back(0);
             if (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Triangle) {
                 Path& last_path = t_buffer.paths.back();
                 if (prev.type == curr.type && last_path.matches(curr, m_extrusions.ranges, m_current_mode))
@@ -2398,11 +2457,21 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result)
         }
 
         VertexBuffer& v_buffer = v_multibuffer.back();
+        const unsigned int vbuffer_id = static_cast<unsigned int>(v_multibuffer.size()) - 1;
+
+        if (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Line ||
+            t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Triangle) {
+            // start a new chunk of segments at every layer change
+            if (segments_chunks_layer[id] != int(curr.layer_id)) {
+                segments_chunks[id].push_back(segments[id].size());
+                segments_chunks_layer[id] = int(curr.layer_id);
+            }
+        }
 
         switch (t_buffer.render_primitive_type)
         {
-        case TBuffer::ERenderPrimitiveType::Line:     { add_vertices_as_line(prev, curr, v_buffer); break; }
-        case TBuffer::ERenderPrimitiveType::Triangle: { add_vertices_as_solid(prev, curr, t_buffer, static_cast<unsigned int>(v_multibuffer.size()) - 1, v_buffer, move_id); break; }
+        case TBuffer::ERenderPrimitiveType::Line:     { place_segment_as_line(vbuffer_id, v_sizes.back(), i, segments[id]); break; }
+        case TBuffer::ERenderPrimitiveType::Triangle: { place_segment_as_solid(prev, curr, t_buffer, vbuffer_id, v_sizes.back(), move_id, i, segments[id]); break; }
         case TBuffer::ERenderPrimitiveType::InstancedModel:
         {
             add_model_instance(curr, inst_buffer, inst_id_buffer, move_id);
@@ -2415,6 +2484,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result)
         case TBuffer::ERenderPrimitiveType::BatchedModel:
         {
             add_vertices_as_model_batch(curr, t_buffer.model.data, v_buffer, inst_buffer, inst_id_buffer, move_id);
+            v_sizes.back() = v_buffer.size();
             inst_offsets.push_back(prev.position - curr.position);
 #if ENABLE_GCODE_VIEWER_STATISTICS
             ++m_statistics.batched_count;
@@ -2431,6 +2501,21 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result)
         }
     }
 
+    // toolpaths data -> generate the vertices of the placed segments, in parallel
+    for (size_t i = 0; i < m_buffers.size(); ++i) {
+        MultiVertexBuffer& v_multibuffer = vertices[i];
+        for (size_t j = 0; j < v_multibuffer.size(); ++j) {
+            v_multibuffer[j].resize(vertices_sizes[i][j]);
+        }
+        if (!segments[i].empty())
+            generate_toolpaths_vertices(moves, segments[i], segments_chunks[i], v_multibuffer);
+    }
+
+    // dismiss, no more needed
+    std::vector<std::vector<size_t>>().swap(vertices_sizes);
+    std::vector<std::vector<ToolpathSegment>>().swap(segments);
+    std::vector<std::vector<size_t>>().swap(segments_chunks);
+
     // smooth toolpaths corners for the given TBuffer using triangles
     auto smooth_triangle_toolpaths_corners = [&gcode_result, &biased_seams_ids](const TBuffer& t_buffer, MultiVertexBuffer& v_multibuffer) {
         auto extract_position_at = [](const VertexBuffer& vertices, size_t offset) {
@@ -2521,7 +2606,10 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result)
         };
 
         const size_t vertex_size_floats = t_buffer.vertices.vertex_size_floats();
-        for (const Path& path : t_buffer.paths) {
+        // the paths do not share vertices, thus they are smoothed in parallel
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, t_buffer.paths.size()), [&](const tbb::blocked_range<size_t>& range) {
+        for (size_t path_id = range.begin(); path_id < range.end(); ++ path_id) {
+            const Path& path = t_buffer.paths[path_id];
             // the two segments of the path sharing the current vertex may belong
             // to two different vertex buffers
             size_t prev_sub_path_id = 0;
@@ -2531,9 +2619,9 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result)
             for (size_t j = 1; j < path_vertices_count - 1; ++j) {
                 const size_t curr_s_id = path.sub_paths.front().first.s_id + j;
                 const size_t move_id = extract_move_id(curr_s_id);
-                const Vec3f& prev = gcode_result.moves[move_id - 1].position;
-                const Vec3f& curr = gcode_result.moves[move_id].position;
-                const Vec3f& next = gcode_result.moves[move_id + 1].position;
+                const Vec3f prev = gcode_result.moves.position(move_id - 1);
+                const Vec3f curr = gcode_result.moves.position(move_id);
+                const Vec3f next = gcode_result.moves.position(move_id + 1);
 
                 // select the subpaths which contains the previous/next segments
                 if (!path.sub_paths[prev_sub_path_id].contains(curr_s_id))
@@ -2585,6 +2673,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result)
                 }
             }
         }
+        });
     };
 
 #if ENABLE_GCODE_VIEWER_STATISTICS
@@ -2710,8 +2799,14 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result)
 
     size_t seams_count = 0;
 
-    for (size_t i = 0; i < m_moves_count; ++i) {
-        const GCodeProcessorResult::MoveVertex& curr = gcode_result.moves[i];
+    // rolling window of the previous, current and next moves, each move is decoded once
+    GCodeProcessorResult::MoveVertex next_move = moves[0];
+    for (GCodeMoves::const_iterator it = moves.begin(); it != moves.end(); ++it) {
+        const size_t i = it.index();
+        prev = curr;
+        curr = next_move;
+        if (i < m_moves_count - 1)
+            next_move = it[1];
         if (curr.type == EMoveType::Noop)
             continue;
         if (curr.type == EMoveType::Seam)
@@ -2723,10 +2818,9 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result)
         if (i == 0)
             continue;
 
-        const GCodeProcessorResult::MoveVertex& prev = gcode_result.moves[i - 1];
         const GCodeProcessorResult::MoveVertex* next = nullptr;
         if (i < m_moves_count - 1)
-            next = &gcode_result.moves[i + 1];
+            next = &next_move;
 
         ++progress_count;
         if (progress_dialog != nullptr && progress_count % progress_threshold == 0) {
@@ -2900,8 +2994,9 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result)
     size_t last_travel_s_id = 0;
     size_t first_travel_s_id = 0;
     seams_count = 0;
-    for (size_t i = 0; i < m_moves_count; ++i) {
-        const GCodeProcessorResult::MoveVertex& move = gcode_result.moves[i];
+    for (GCodeMoves::const_iterator it = moves.begin(); it != moves.end(); ++it) {
+        const size_t i = it.index();
+        const GCodeProcessorResult::MoveVertex move = *it;
         if (move.type == EMoveType::Seam)
             ++seams_count;
 
@@ -1016,6 +1016,46 @@ public:
 
     void load_shells(const Print& print);
 
+    // Segment of a toolpath rendered as lines or as solid, placed into the vertex buffers of its TBuffer
+    // by load_toolpaths() before its vertices are generated
+    struct ToolpathSegment
+    {
+        enum class EType : unsigned char
+        {
+            // 2 vertices: position
+            Line,
+            // 6 vertices: position|normal, the previous segment of the path shares 2 vertices of the 1st endpoint
+            Solid,
+            // 8 vertices: position|normal, 1st segment of a path or 1st segment of a vertex buffer
+            SolidFirst
+        };
+
+        // index into GCodeProcessorResult::moves of the move ending the segment, the segment starts at the previous move
+        uint32_t move;
+        // index of the vertex buffer
+        uint32_t vbuffer_id;
+        // offset of the 1st vertex into the vertex buffer, in floats
+        uint32_t offset;
+        float half_width;
+        float half_height;
+        EType type;
+
+        size_t size_floats() const {
+            switch (type)
+            {
+            case EType::Line:  { return 2 * 3; }
+            case EType::Solid: { return 6 * 6; }
+            default:           { return 8 * 6; }
+            }
+        }
+    };
+
+    // Generates the vertices of the given segments into the vertex buffers, which are already sized to contain them.
+    // The segments are processed in parallel, in chunks starting at the given segments (typically the 1st segment of each layer).
+    // No OpenGL call is made, thus it does not need an OpenGL context and it may run on any thread.
+    static void generate_toolpaths_vertices(const GCodeMoves& moves, const std::vector<ToolpathSegment>& segments,
+        const std::vector<size_t>& chunks, std::vector<std::vector<float>>& vertex_buffers);
+
 private:
     void load_toolpaths(const GCodeProcessorResult& gcode_result);
     void load_wipetower_shell(const Print& print);
@@ -2,6 +2,7 @@
 #include "test_utils.hpp"
 
 #include <libslic3r/Execution/ExecutionSeq.hpp>
+#include <libslic3r/Execution/ExecutionTBB.hpp>
 
 #include <libslic3r/Arrange/Core/ArrangeBase.hpp>
 #include <libslic3r/Arrange/Core/ArrangeFirstFit.hpp>
@@ -39,6 +40,7 @@
 #include <boost/geometry/algorithms/convert.hpp>
 
 #include <random>
+#include <chrono>
 
 template<class ArrItem = Slic3r::arr2::ArrangeItem>
 static std::vector<ArrItem> prusa_parts(double infl = 0.) {
@@ -1066,6 +1068,104 @@ TEMPLATE_TEST_CASE("Test if allowed item rotations are considered", "[arrange2]"
     REQUIRE(get_rotation(itm) == Approx(PI));
 }
 
+TEST_CASE("Pair NFPs are shared by identical copies of the items", "[arrange2]")
+{
+    using namespace Slic3r;
+
+    auto parts = prusa_parts();
+    REQUIRE(parts.size() > 1);
+
+    arr2::ArrangeItem fixed   = parts[0];
+    arr2::ArrangeItem movable = parts[1];
+    fixed.rotation(PI / 2.);
+    movable.rotation(PI / 4.);
+
+    arr2::PairNFPCache cache;
+    Polygons nfp = arr2::calculate_pair_nfp(fixed, movable, cache);
+    REQUIRE(!nfp.empty());
+    REQUIRE(cache.misses() == 1);
+
+    // Translated copies of the items hit the cache, the NFP follows the fixed item
+    arr2::ArrangeItem fixed_cpy   = fixed;
+    arr2::ArrangeItem movable_cpy = movable;
+    Vec2crd d = scaled(Vec2d{150., -70.});
+    fixed_cpy.translation(d);
+    movable_cpy.translation(scaled(Vec2d{-20., 30.}));
+
+    Polygons nfp_cpy = arr2::calculate_pair_nfp(fixed_cpy, movable_cpy, cache);
+    REQUIRE(cache.hits() == 1);
+
+    for (Polygon &p : nfp)
+        p.translate(d);
+    REQUIRE(nfp_cpy == nfp);
+
+    // The cached NFP is the same as the freshly calculated one
+    cache.clear();
+    REQUIRE(arr2::calculate_pair_nfp(fixed_cpy, movable_cpy, cache) == nfp_cpy);
+
+    // Other rotation, other NFP
+    movable_cpy.rotation(0.);
+    arr2::calculate_pair_nfp(fixed_cpy, movable_cpy, cache);
+    REQUIRE(cache.misses() == 2);
+
+    // Other shape with the same rotations, other NFP
+    arr2::ArrangeItem other = parts[2 % parts.size()];
+    other.rotation(fixed_cpy.shape().rotation());
+    REQUIRE(other.shape().shape_digest() != fixed_cpy.shape().shape_digest());
+    REQUIRE(arr2::calculate_pair_nfp(other, movable_cpy, cache) != arr2::calculate_pair_nfp(fixed_cpy, movable_cpy, cache));
+    REQUIRE(cache.misses() == 3);
+}
+
+TEST_CASE("Pair NFP cache is owned by the packing context", "[arrange2]")
+{
+    using namespace Slic3r;
+
+    auto parts = prusa_parts();
+    std::vector<arr2::ArrangeItem> fixed{parts[0], parts[0]};
+    fixed[1].translation(scaled(Vec2d{100., 0.}));
+    arr2::ArrangeItem orbiter = parts[1];
+
+    auto bed = arr2::InfiniteBed{};
+    auto ctx = arr2::default_context(fixed);
+    arr2::calculate_nfp(orbiter, ctx, bed);
+
+    // The two fixed copies share one entry, another context starts empty.
+    REQUIRE(arr2::nfp_cache(ctx).size() == 1);
+    REQUIRE(arr2::nfp_cache(ctx).hits() == 1);
+    REQUIRE(arr2::nfp_cache(arr2::default_context(fixed)).size() == 0);
+}
+
+TEST_CASE("Arrange benchmark with many small items", "[arrange2][Slow]")
+{
+    using namespace Slic3r;
+
+    namespace firstfit = arr2::firstfit;
+
+    constexpr size_t Count = 300;
+
+    auto parts = prusa_parts();
+    auto items = reserve_vector<arr2::ArrangeItem>(Count);
+    for (size_t i = 0; i < Count; ++i) {
+        items.emplace_back(parts[i % parts.size()]);
+        arr2::set_allowed_rotations(items.back(), {0., PI / 2., PI, 3. * PI / 2.});
+    }
+
+    auto bed = arr2::RectangleBed{scaled(2000.), scaled(2000.)};
+    arr2::PackStrategyNFP strategy{arr2::GravityKernel{}, ex_tbb};
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+    arr2::arrange(firstfit::SelectionStrategy<>{}, strategy, range(items), bed);
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    double seconds = std::chrono::duration<double>(t2 - t1).count();
+    std::cout << "Arranged " << Count << " items in " << seconds << " s, "
+              << Count / seconds << " items placed per second" << std::endl;
+
+    REQUIRE(std::all_of(items.begin(), items.end(), [](const arr2::ArrangeItem &itm) {
+        return arr2::is_arranged(itm);
+    }));
+}
+
 //TEST_CASE("NFP optimizing test", "[arrange2]") {
 //    using namespace Slic3r;
 
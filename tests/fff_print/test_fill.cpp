@@ -1,11 +1,13 @@
 #include <catch2/catch.hpp>
 
+#include <fstream>
 #include <numeric>
 #include <sstream>
 
 #include "libslic3r/libslic3r.h"
 
 #include "libslic3r/ClipperUtils.hpp"
+#include "libslic3r/Fill/FillAdaptive.hpp"
 #include "libslic3r/Flow.hpp"
 #include "libslic3r/Layer.hpp"
 #include "libslic3r/Geometry.hpp"
@@ -13,6 +15,7 @@
 #include "libslic3r/Point.hpp"
 #include "libslic3r/Print.hpp"
 #include "libslic3r/SVG.hpp"
+#include "libslic3r/TriangleMesh.hpp"
 
 #include "test_data.hpp"
 
@@ -197,6 +200,149 @@ TEST_CASE("Fill: Pattern Path Length", "[Fill]") {
     }
 }
 
+TEST_CASE("Fill: Schwarz D extrudes the requested density", "[Fill]") {
+    std::unique_ptr<Slic3r::Fill> filler(Slic3r::Fill::new_from_type(ipSchwarzD));
+    const ExPolygon square(Polygon::new_scale({ {0, 0}, {50, 0}, {50, 50}, {0, 50} }));
+    filler->bounding_box = get_extents(square);
+    filler->angle = 0;
+    // The gyroid fillers read resolution_internal from the print config.
+    const FullPrintConfig config = FullPrintConfig::defaults();
+    FillParams fill_params;
+    fill_params.config = &config;
+    fill_params.connection = InfillConnection::icNotConnected;
+    const double spacing = 0.45;
+    filler->init_spacing(spacing, fill_params);
+
+    Surface surface(stPosInternal | stDensSparse, square);
+    for (float density : { 0.1f, 0.2f, 0.4f })
+        for (coordf_t z : { 0.2, 1.1, 2.3 }) {
+            fill_params.density = density;
+            filler->z = z;
+            Polylines paths = filler->fill_surface(&surface, fill_params);
+            REQUIRE(! paths.empty());
+            double length = 0.;
+            for (const Polyline &path : paths)
+                length += unscaled(path.length());
+            // The length of the waves varies with z, the density is only met on average over the layers.
+            const double ratio = length * spacing / (density * unscaled(unscaled(square.area())));
+            REQUIRE(ratio > 0.8);
+            REQUIRE(ratio < 1.2);
+        }
+}
+
+TEST_CASE("Fill: adaptive cubic octree built in parallel and reused is the same as the serial one", "[Fill]") {
+    // Sphere and a square overhang inside of it, rotated to the coordinate system of the octree.
+    const Transform3d to_octree(FillAdaptive::transform_to_octree());
+    indexed_triangle_set mesh = its_make_sphere(20., PI / 16.);
+    its_transform(mesh, to_octree);
+    std::vector<Vec3d> overhangs { { -5., -5., 5. }, { 5., -5., 5. }, { 5., 5., 5. }, { -5., -5., 5. }, { 5., 5., 5. }, { -5., 5., 5. } };
+    for (Vec3d &p : overhangs)
+        p = to_octree * p;
+
+    const ExPolygon circle(Polygon::new_scale({ { 18., 0. }, { 0., 18. }, { -18., 0. }, { 0., -18. } }));
+    const FullPrintConfig config = FullPrintConfig::defaults();
+    auto fill = [&circle, &config](FillAdaptive::Octree *octree) {
+        std::unique_ptr<Fill> filler(Fill::new_from_type(ipAdaptiveCubic));
+        filler->adapt_fill_octree = octree;
+        filler->bounding_box = get_extents(circle);
+        filler->angle = 0;
+        FillParams fill_params;
+        fill_params.config = &config;
+        fill_params.density = 0.2f;
+        fill_params.connection = InfillConnection::icNotConnected;
+        filler->init_spacing(0.45, fill_params);
+        Surface surface(stPosInternal | stDensSparse, circle);
+        std::vector<Polylines> out;
+        for (coordf_t z = -17.; z < 17.; z += 2.3) {
+            filler->z = z;
+            out.emplace_back(filler->fill_surface(&surface, fill_params));
+        }
+        return out;
+    };
+
+    for (bool support_overhangs_only : { false, true }) {
+        const std::vector<Polylines> serial = fill(FillAdaptive::build_octree(mesh, overhangs, 0.5, support_overhangs_only, {}, true).get());
+        REQUIRE(std::any_of(serial.begin(), serial.end(), [](const Polylines &polylines) { return ! polylines.empty(); }));
+
+        FillAdaptive::OctreePtr octree = FillAdaptive::build_octree(mesh, overhangs, 0.5, support_overhangs_only);
+        REQUIRE(fill(octree.get()) == serial);
+
+        // The octree is reused if built from the same input.
+        const FillAdaptive::Octree *octree_built = octree.get();
+        octree = FillAdaptive::build_octree(mesh, overhangs, 0.5, support_overhangs_only, std::move(octree));
+        REQUIRE(octree.get() == octree_built);
+        REQUIRE(fill(octree.get()) == serial);
+
+        // The octree is rebuilt if the input changes.
+        octree = FillAdaptive::build_octree(mesh, overhangs, 0.7, support_overhangs_only, std::move(octree));
+        REQUIRE(fill(octree.get()) == fill(FillAdaptive::build_octree(mesh, overhangs, 0.7, support_overhangs_only, {}, true).get()));
+    }
+}
+
+// Square plate with a grid of square and triangular holes, so that each infill line crosses many contours.
+static ExPolygon plate_with_holes()
+{
+    ExPolygon expolygon(Polygon::new_scale({ { 0., 0. }, { 20., 0. }, { 20., 20. }, { 0., 20. } }));
+    for (int i = 0; i < 3; ++ i)
+        for (int j = 0; j < 3; ++ j) {
+            const double x = 2.5 + 5. * i;
+            const double y = 2.5 + 5. * j;
+            Polygon hole = (i + j) % 2 == 0 ?
+                Polygon::new_scale({ { x, y }, { x + 2., y }, { x + 2., y + 2. }, { x, y + 2. } }) :
+                Polygon::new_scale({ { x, y }, { x + 2.5, y + 0.5 }, { x + 1., y + 2. } });
+            hole.reverse();
+            expolygon.holes.emplace_back(std::move(hole));
+        }
+    return expolygon;
+}
+
+static Polylines fill_plate_with_holes(float density, float angle)
+{
+    static const FullPrintConfig config = FullPrintConfig::defaults();
+    const Flow flow = Flow::new_from_width(0.45f, 0.4f, 0.2f, 1.f);
+    std::unique_ptr<Fill> filler(Fill::new_from_type(ipRectilinear));
+    Surface surface(stPosInternal | (density < 1.f ? stDensSparse : stDensSolid), plate_with_holes());
+    filler->bounding_box = get_extents(surface.expolygon.contour);
+    filler->angle = angle;
+    FillParams fill_params;
+    fill_params.density = density;
+    fill_params.dont_adjust = false;
+    fill_params.flow = flow;
+    fill_params.config = &config;
+    filler->init_spacing(flow.spacing(), fill_params);
+    return filler->fill_surface(&surface, fill_params);
+}
+
+TEST_CASE("Fill: rectilinear fill of a region with many holes matches the reference", "[Fill]") {
+    // The reference was generated by the linear search of the neighbour contour intersections,
+    // replaced by ContourIntersectionIndex. Each case starts with a line "density <d> angle <a> polylines <n>",
+    // followed by one line of the scaled coordinates "x y x y ..." per polyline.
+    std::ifstream file(std::string(TEST_DATA_DIR) + "/fff_print_tests/test_fill/rectilinear_holes.txt");
+    REQUIRE(file.good());
+    size_t num_cases = 0;
+    for (std::string line; std::getline(file, line);) {
+        if (line.empty() || line.front() == '#')
+            continue;
+        std::istringstream header(line);
+        std::string        density_key, angle_key, polylines_key;
+        float              density, angle;
+        size_t             num_polylines;
+        header >> density_key >> density >> angle_key >> angle >> polylines_key >> num_polylines;
+        REQUIRE(density_key == "density");
+        Polylines reference(num_polylines);
+        for (Polyline &polyline : reference) {
+            REQUIRE(std::getline(file, line));
+            std::istringstream coords(line);
+            for (coord_t x, y; coords >> x >> y;)
+                polyline.points.emplace_back(x, y);
+        }
+        INFO("density " << density << " angle " << angle);
+        REQUIRE(fill_plate_with_holes(density, angle) == reference);
+        ++ num_cases;
+    }
+    REQUIRE(num_cases == 4);
+}
+
 SCENARIO("Infill does not exceed perimeters", "[Fill]") 
 {
     auto test = [](const std::string_view pattern) {
@@ -8,7 +8,10 @@
 #include <regex>
 #include <fstream>
 
+#include <boost/filesystem.hpp>
+
 #include "libslic3r/GCode.hpp"
+#include "libslic3r/GCodeReader.hpp"
 #include "libslic3r/Geometry/ConvexHull.hpp"
 #include "libslic3r/ModelArrange.hpp"
 #include "test_data.hpp"
@@ -323,3 +326,43 @@ TEST_CASE("M201 for acceleation reset", "[GCode]") {
     INFO("M204 is not generated for repetier firmware");
     CHECK(!has_m204);
 }
+
+TEST_CASE("GCodeReader parses lines longer than a read block", "[GCode]") {
+    // GCodeReader::parse_file() reads the file in blocks of 640kB.
+    const std::string long_comment(1500000, 'a');
+    boost::filesystem::path temp = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+
+    auto parse = [&temp](const std::string &gcode) {
+        {
+            std::ofstream out(temp.string(), std::ios::binary);
+            out << gcode;
+        }
+        std::vector<GCodeReader::GCodeLine> lines;
+        GCodeReader reader;
+        bool ok = reader.parse_file(temp.string(), [&lines](GCodeReader &, const GCodeReader::GCodeLine &line) { lines.emplace_back(line); });
+        boost::filesystem::remove(temp);
+        REQUIRE(ok);
+        return lines;
+    };
+
+    SECTION("Lines terminated by LF") {
+        std::vector<GCodeReader::GCodeLine> lines = parse("G1 X1 Y2\n;" + long_comment + "\nG1 X3 Y4 ;" + long_comment + "\nG1 X5 Y6\n");
+        REQUIRE(lines.size() == 4);
+        CHECK(lines[0].x() == Approx(1.));
+        CHECK(lines[1].comment().size() == long_comment.size());
+        CHECK(lines[2].cmd_is("G1"));
+        CHECK(lines[2].x() == Approx(3.));
+        CHECK(lines[2].comment().size() == long_comment.size());
+        CHECK(lines[3].x() == Approx(5.));
+        CHECK(lines[3].y() == Approx(6.));
+    }
+    SECTION("Lines terminated by CR only") {
+        std::string gcode;
+        for (int i = 0; i < 100000; ++ i)
+            gcode += "G1 X" + std::to_string(i) + "\r";
+        std::vector<GCodeReader::GCodeLine> lines = parse(gcode);
+        REQUIRE(lines.size() == 100000);
+        CHECK(lines.front().x() == Approx(0.));
+        CHECK(lines.back().x() == Approx(99999.));
+    }
+}
@@ -108,6 +108,52 @@ SCENARIO("Find/Replace with plain text", "[GCodeFindReplace]") {
             REQUIRE(find_replace.process_layer(gcode) == gcode);
         }
     }
+
+    GIVEN("G-code with multiple plain substitutions") {
+        const std::string gcode =
+            "G1 Z0; home\n"
+            "G1 Z1; move up\n"
+            "G1 X0 Y1 Z1; perimeter\n"
+            "G1 X13 Y32 Z1; infill\n"
+            "G1 X13 Y32 Z1; wipe\n";
+        WHEN("Independent substitutions are matched at once") {
+            GCodeFindReplace find_replace({
+                "home",      "HOME",      "",   "",
+                "PERIMETER", "external",  "i",  "",
+                "infill",    "sparse",    "w",  "",
+                "wipe",      "wipe",      "iw", "",
+                "Y32",       "Y33",       "",   "" });
+            REQUIRE(find_replace.process_layer(gcode) ==
+                "G1 Z0; HOME\n"
+                "G1 Z1; move up\n"
+                "G1 X0 Y1 Z1; external\n"
+                "G1 X13 Y33 Z1; sparse\n"
+                "G1 X13 Y33 Z1; wipe\n");
+        }
+        WHEN("A substitution matches the output of a preceding one") {
+            GCodeFindReplace find_replace({
+                "move up",   "move down", "",   "",
+                "down",      "up",        "",   "",
+                "Z1;",       "Z2;",       "",   "" });
+            REQUIRE(find_replace.process_layer(gcode) ==
+                "G1 Z0; home\n"
+                "G1 Z2; move up\n"
+                "G1 X0 Y1 Z2; perimeter\n"
+                "G1 X13 Y32 Z2; infill\n"
+                "G1 X13 Y32 Z2; wipe\n");
+        }
+        WHEN("A literal regular expression is processed as plain text") {
+            GCodeFindReplace find_replace({
+                "infill",    "sparse",    "r",  "",
+                "WIPE",      "retract",   "ri", "" });
+            REQUIRE(find_replace.process_layer(gcode) ==
+                "G1 Z0; home\n"
+                "G1 Z1; move up\n"
+                "G1 X0 Y1 Z1; perimeter\n"
+                "G1 X13 Y32 Z1; sparse\n"
+                "G1 X13 Y32 Z1; retract\n");
+        }
+    }
 }
 
 SCENARIO("Find/Replace with regexp", "[GCodeFindReplace]") {
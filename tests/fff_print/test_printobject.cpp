@@ -3,6 +3,10 @@
 #include "libslic3r/libslic3r.h"
 #include "libslic3r/Print.hpp"
 #include "libslic3r/Layer.hpp"
+#include "libslic3r/Utils.hpp"
+
+#include <boost/filesystem.hpp>
+#include <fstream>
 
 #include "test_data.hpp"
 
@@ -299,3 +303,102 @@ SCENARIO("PrintObject: minimum horizontal shells", "[PrintObject]") {
 
     }
 }
+
+// The region slices and the lslices of all the layers of the first object.
+static std::vector<ExPolygons> object_slices(const Print &print)
+{
+    std::vector<ExPolygons> out;
+    for (const Layer *layer : print.objects().front()->layers()) {
+        for (const LayerRegion *layerm : layer->regions())
+            out.emplace_back(to_expolygons(layerm->slices().surfaces));
+        out.emplace_back(layer->lslices());
+    }
+    return out;
+}
+
+static std::vector<boost::filesystem::path> slice_cache_files(const boost::filesystem::path &dir)
+{
+    std::vector<boost::filesystem::path> out;
+    for (boost::filesystem::directory_iterator it(dir), end; it != end; ++ it)
+        if (it->path().extension() == ".slices")
+            out.emplace_back(it->path());
+    return out;
+}
+
+static std::string read_file(const boost::filesystem::path &path)
+{
+    std::ifstream file(path.string(), std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+SCENARIO("PrintObject: slice cache", "[PrintObject]") {
+    GIVEN("20mm cube with a hole sliced without the slice cache") {
+        const std::initializer_list<ConfigBase::SetDeserializeItem> config { { "layer_height", 0.3 } };
+        std::vector<ExPolygons> slices_cold;
+        {
+            Print print;
+            Test::init_and_process_print({ TestMesh::cube_with_hole }, print, config);
+            slices_cold = object_slices(print);
+        }
+        REQUIRE(! slices_cold.empty());
+
+        const boost::filesystem::path cache_dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+        set_slice_cache_dir(cache_dir.string());
+        ScopeGuard cleanup([&cache_dir]() {
+            set_slice_cache_dir(std::string());
+            boost::system::error_code ec;
+            boost::filesystem::remove_all(cache_dir, ec);
+        });
+        auto slice = [&config]() {
+            Print print;
+            Test::init_and_process_print({ TestMesh::cube_with_hole }, print, config);
+            return object_slices(print);
+        };
+        const std::vector<ExPolygons> slices_stored = slice();
+        const std::vector<boost::filesystem::path> files = slice_cache_files(cache_dir);
+        REQUIRE(files.size() == 1);
+        const std::string content = read_file(files.front());
+
+        WHEN("the object is sliced again") {
+            const std::vector<ExPolygons> slices_loaded = slice();
+            THEN("the slices stored and loaded from the cache are the same as the slices of the cold run") {
+                REQUIRE(slices_stored == slices_cold);
+                REQUIRE(slices_loaded == slices_cold);
+                REQUIRE(slice_cache_files(cache_dir) == files);
+                REQUIRE(read_file(files.front()) == content);
+            }
+        }
+        WHEN("the cache file is truncated") {
+            boost::filesystem::resize_file(files.front(), content.size() / 2);
+            const std::vector<ExPolygons> slices_loaded = slice();
+            THEN("the object is sliced again and the cache file is written again") {
+                REQUIRE(slices_loaded == slices_cold);
+                REQUIRE(read_file(files.front()) == content);
+            }
+        }
+        WHEN("a point of the cache file is corrupted") {
+            std::string corrupted = content;
+            corrupted[corrupted.size() / 2] ^= 0x10;
+            std::ofstream(files.front().string(), std::ios::binary | std::ios::trunc) << corrupted;
+            const std::vector<ExPolygons> slices_loaded = slice();
+            THEN("the object is sliced again and the cache file is written again") {
+                REQUIRE(slices_loaded == slices_cold);
+                REQUIRE(read_file(files.front()) == content);
+            }
+        }
+        WHEN("another object is stored into a cache which can hold one object only") {
+            set_slice_cache_dir(cache_dir.string(), content.size() + content.size() / 2);
+            // Make the first file the least recently used one independently of the resolution of the file times.
+            boost::filesystem::last_write_time(files.front(), std::time(nullptr) - 3600);
+            {
+                Print print;
+                Test::init_and_process_print({ TestMesh::cube_20x20x20 }, print, config);
+            }
+            THEN("the least recently used file is removed") {
+                const std::vector<boost::filesystem::path> files_after = slice_cache_files(cache_dir);
+                REQUIRE(files_after.size() == 1);
+                REQUIRE(files_after.front() != files.front());
+            }
+        }
+    }
+}
@@ -2,6 +2,9 @@
 
 #include "libslic3r/GCodeReader.hpp"
 #include "libslic3r/Layer.hpp"
+#include "libslic3r/Support/TreeModelVolumes.hpp"
+
+#include <oneapi/tbb/parallel_for.h>
 
 #include "test_data.hpp" // get access to init_print, etc
 
@@ -119,6 +122,117 @@ SCENARIO("SupportMaterial: support_layers_z and contact_distance", "[SupportMate
     }
 }
 
+SCENARIO("SupportMaterial: tree support regenerated with cached collision volumes", "[SupportMaterial]")
+{
+    auto support_polylines = [](const Slic3r::Print &print) {
+        std::vector<Polylines> out;
+        for (const SupportLayer *layer : print.objects().front()->support_layers())
+            out.emplace_back(to_polylines(layer->support_fills.as_polylines()));
+        return out;
+    };
+    GIVEN("an overhang with organic supports") {
+        Slic3r::DynamicPrintConfig config = Slic3r::DynamicPrintConfig::full_print_config();
+        config.set_deserialize_strict({
+            { "support_material",                 1 },
+            { "support_material_style",           "organic" },
+            { "support_material_interface_angle", 0 },
+            { "layer_height",                     0.2 },
+            { "first_layer_height",               0.2 }
+            });
+        Slic3r::Print print;
+        Slic3r::Model model;
+        Slic3r::Test::init_print({ TestMesh::overhang }, print, model, config);
+        print.process();
+        THEN("the collision volumes are kept for the next support generation") {
+            REQUIRE(print.get_object(0)->tree_support_volumes_cache());
+        }
+        WHEN("only the support interface angle is changed") {
+            config.set("support_material_interface_angle", 45);
+            print.apply(model, config);
+            print.process();
+            Slic3r::Print print_cold;
+            Slic3r::Model model_cold;
+            Slic3r::Test::init_print({ TestMesh::overhang }, print_cold, model_cold, config);
+            print_cold.process();
+            THEN("the regenerated support matches a cold run") {
+                REQUIRE(print.objects().front()->support_layers().size() == print_cold.objects().front()->support_layers().size());
+                REQUIRE(support_polylines(print) == support_polylines(print_cold));
+            }
+        }
+        WHEN("the supports are disabled") {
+            config.set("support_material", 0);
+            print.apply(model, config);
+            print.process();
+            THEN("the collision volumes are released") {
+                REQUIRE(! print.get_object(0)->tree_support_volumes_cache());
+            }
+        }
+        WHEN("the object is re-sliced") {
+            config.set("layer_height", 0.15);
+            print.apply(model, config);
+            THEN("the collision volumes are released") {
+                REQUIRE(! print.get_object(0)->tree_support_volumes_cache());
+            }
+        }
+    }
+}
+
+TEST_CASE("SupportMaterial: tree support collision cache is filled and read concurrently", "[SupportMaterial]")
+{
+    using Cache = FFFTreeSupport::TreeModelVolumes::RadiusLayerPolygonCache;
+    // Polygons identifying the radius and the layer they were stored for.
+    auto polygons = [](coord_t radius, FFFTreeSupport::LayerIndex layer_idx) {
+        return Polygons{ Polygon{ { 0, 0 }, { radius, 0 }, { radius, coord_t(layer_idx) + 1 } } };
+    };
+    const std::array<coord_t, 3> radii { 300, 100, 200 };
+    static constexpr const FFFTreeSupport::LayerIndex num_layers = 2000;
+
+    Cache cache;
+    // Catch assertions are not thread safe, the worker threads count the failed checks.
+    std::atomic<size_t> num_failed { 0 };
+    // The layers are inserted out of order, so that the vector of layers grows while the other layers are being read.
+    tbb::parallel_for(tbb::blocked_range<FFFTreeSupport::LayerIndex>(0, num_layers, 1),
+        [&cache, &radii, &polygons, &num_failed](const tbb::blocked_range<FFFTreeSupport::LayerIndex> &range) {
+            auto check = [&num_failed](bool condition) { if (! condition) ++ num_failed; };
+            for (FFFTreeSupport::LayerIndex i = range.begin(); i < range.end(); ++ i) {
+                const FFFTreeSupport::LayerIndex layer_idx = (i * 7919) % num_layers;
+                for (coord_t radius : radii)
+                    cache.insert({ { { radius, layer_idx }, polygons(radius, layer_idx) } });
+                // Hit of an inserted layer.
+                std::optional<std::reference_wrapper<const Polygons>> area = cache.getArea({ 200, layer_idx });
+                check(area && area->get() == polygons(200, layer_idx));
+                // Miss of a radius not inserted, hit of the lower radius.
+                check(! cache.getArea({ 250, layer_idx }));
+                std::optional<std::pair<coord_t, std::reference_wrapper<const Polygons>>> lower = cache.get_lower_bound_area({ 250, layer_idx });
+                check(lower && lower->first == 200 && lower->second.get() == polygons(200, layer_idx));
+                // Lookup of a layer being inserted by another thread, either a hit or a miss.
+                const FFFTreeSupport::LayerIndex other_idx = num_layers - 1 - layer_idx;
+                if (std::optional<std::reference_wrapper<const Polygons>> other = cache.getArea({ 100, other_idx }); other)
+                    check(other->get() == polygons(100, other_idx));
+            }
+        });
+    REQUIRE(num_failed == 0);
+
+    Cache::Statistics stats = cache.statistics();
+    REQUIRE(stats.hits + stats.misses == size_t(4 * num_layers));
+    REQUIRE(stats.hits >= size_t(2 * num_layers));
+    REQUIRE(stats.misses >= size_t(num_layers));
+
+    // Every layer inserted reads back, sorted by the layer index, then by the radius.
+    std::vector<std::pair<FFFTreeSupport::TreeModelVolumes::RadiusLayerPair, std::reference_wrapper<const Polygons>>> sorted = cache.sorted();
+    REQUIRE(sorted.size() == radii.size() * num_layers);
+    for (size_t i = 0; i < sorted.size(); ++ i) {
+        const FFFTreeSupport::LayerIndex layer_idx = FFFTreeSupport::LayerIndex(i / radii.size());
+        const coord_t                    radius    = 100 * coord_t(i % radii.size() + 1);
+        REQUIRE(sorted[i].first == FFFTreeSupport::TreeModelVolumes::RadiusLayerPair(radius, layer_idx));
+        REQUIRE(sorted[i].second.get() == polygons(radius, layer_idx));
+    }
+    for (FFFTreeSupport::LayerIndex layer_idx = 0; layer_idx < num_layers; ++ layer_idx)
+        REQUIRE(cache.getArea({ 300, layer_idx }));
+    REQUIRE(cache.statistics().hits == stats.hits + size_t(num_layers));
+    REQUIRE(cache.getMaxCalculatedLayer(100) == num_layers - 1);
+}
+
 #if 0
 // Test 8.
 TEST_CASE("SupportMaterial: forced support is generated", "[SupportMaterial]")
@@ -3,9 +3,12 @@
 #include "libslic3r/Model.hpp"
 #include "libslic3r/Format/3mf.hpp"
 #include "libslic3r/Format/STL.hpp"
+#include "libslic3r/miniz_extension.hpp"
 
 #include <boost/filesystem/operations.hpp>
 
+#include <oneapi/tbb/task_arena.h>
+
 using namespace Slic3r;
 
 SCENARIO("Reading 3mf file", "[3mf]") {
@@ -52,7 +55,7 @@ SCENARIO("Export+Import geometry to/from 3mf file cycle", "[3mf]") {
         WHEN("model is saved+loaded to/from 3mf file") {
             // save the model to 3mf file
             std::string test_file = std::string(TEST_DATA_DIR) + "/test_3mf/prusa.3mf";
-            store_3mf(test_file.c_str(), &src_model, nullptr, false);
+            store_3mf(test_file.c_str(), &src_model, nullptr);
 
             // load back the model from the 3mf file
             Model dst_model;
@@ -131,3 +134,314 @@ SCENARIO("2D convex hull of sinking object", "[3mf]") {
     }
 }
 
+
+SCENARIO("Export+Import painted facets to/from 3mf file cycle", "[3mf]") {
+    GIVEN("model with two objects with painted facets") {
+        Model src_model;
+        std::string src_file = std::string(TEST_DATA_DIR) + "/test_3mf/Prusa.stl";
+        load_stl(src_file.c_str(), &src_model);
+        src_model.add_object(*src_model.objects.front());
+        src_model.add_default_instances();
+
+        for (ModelObject* object : src_model.objects) {
+            ModelVolume* volume = object->volumes.front();
+            const int triangles_count = int(volume->mesh().its.indices.size());
+            for (int i = 0; i < triangles_count; i += 3) {
+                volume->mm_segmentation_facets.set_triangle_from_string(i, "8");
+                volume->supported_facets.set_triangle_from_string(i + 1 < triangles_count ? i + 1 : i, "4");
+            }
+        }
+
+        WHEN("model is saved+loaded to/from 3mf file") {
+            std::string test_file = std::string(TEST_DATA_DIR) + "/test_3mf/prusa_painted.3mf";
+            store_3mf(test_file.c_str(), &src_model, nullptr);
+
+            Model dst_model;
+            DynamicPrintConfig dst_config;
+            bool loaded = false;
+            {
+                ConfigSubstitutionContext ctxt{ ForwardCompatibilitySubstitutionRule::Disable };
+                loaded = load_3mf(test_file.c_str(), dst_config, ctxt, &dst_model, false);
+            }
+            boost::filesystem::remove(test_file);
+
+            THEN("meshes and painted facets match") {
+                REQUIRE(loaded);
+                REQUIRE(dst_model.objects.size() == src_model.objects.size());
+                for (size_t obj_idx = 0; obj_idx < src_model.objects.size(); ++obj_idx) {
+                    const ModelVolume* src_volume = src_model.objects[obj_idx]->volumes.front();
+                    const ModelVolume* dst_volume = dst_model.objects[obj_idx]->volumes.front();
+                    const indexed_triangle_set& src_its = src_volume->mesh().its;
+                    const indexed_triangle_set& dst_its = dst_volume->mesh().its;
+                    REQUIRE(dst_its.vertices.size() == src_its.vertices.size());
+                    REQUIRE(dst_its.indices.size() == src_its.indices.size());
+                    for (size_t i = 0; i < src_its.indices.size(); ++i) {
+                        REQUIRE(dst_volume->mm_segmentation_facets.get_triangle_as_string(int(i)) == src_volume->mm_segmentation_facets.get_triangle_as_string(int(i)));
+                        REQUIRE(dst_volume->supported_facets.get_triangle_as_string(int(i)) == src_volume->supported_facets.get_triangle_as_string(int(i)));
+                    }
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Reading hand written 3mf file", "[3mf]") {
+    GIVEN("model file with a comment and a character reference in its mesh, and mesh tags split between inflated chunks") {
+        // Grid of vertices on a wavy surface, the coordinates are printed exactly by std::to_string().
+        const int N = 60;
+        std::vector<Vec3f> vertices;
+        for (int j = 0; j <= N; ++ j)
+            for (int i = 0; i <= N; ++ i)
+                vertices.emplace_back(1.f + 0.5f * i, 1.f + 0.5f * j, 1.f + 0.25f * ((7 * i + 3 * j) % 11));
+
+        std::string model =
+            "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+            "<model unit=\"millimeter\" xml:lang=\"en-US\" xmlns=\"http://schemas.microsoft.com/3dmanufacturing/core/2015/02\">\n"
+            " <resources>\n"
+            "  <object id=\"1\" type=\"model\">\n"
+            "   <mesh>\n"
+            "    <vertices>\n";
+        for (size_t i = 0; i < vertices.size(); ++ i) {
+            if (i == vertices.size() / 2)
+                // Not accepted by the mesh tokenizer, the vertices are read by the xml parser.
+                model += "     <!-- half of the vertices -->\n";
+            model += "     <vertex x=\"" + std::to_string(vertices[i].x()) + "\" y=\"" + std::to_string(vertices[i].y()) + "\" z=\"" + std::to_string(vertices[i].z()) + "\"/>\n";
+        }
+        // The archive is inflated into a dictionary of TINFL_LZ_DICT_SIZE bytes, which is passed to the parser
+        // in chunks ending at multiples of TINFL_LZ_DICT_SIZE. Place the tag to start a few bytes before the end of a chunk.
+        auto split_next_tag = [&model](size_t len_before_split) {
+            model.append((TINFL_LZ_DICT_SIZE - (model.size() + len_before_split) % TINFL_LZ_DICT_SIZE) % TINFL_LZ_DICT_SIZE, ' ');
+        };
+        split_next_tag(4);
+        model += "</vertices>\n";
+        split_next_tag(5);
+        model += "<triangles>\n";
+        for (int j = 0; j < N; ++ j)
+            for (int i = 0; i < N; ++ i) {
+                const int v = j * (N + 1) + i;
+                // The first index is a character reference "0", not accepted by the mesh tokenizer.
+                const std::string v1 = v == 0 ? "&#48;" : std::to_string(v);
+                model += "     <triangle v1=\"" + v1 + "\" v2=\"" + std::to_string(v + 1) + "\" v3=\"" + std::to_string(v + N + 2) + "\"/>\n";
+                model += "     <triangle v1=\"" + std::to_string(v) + "\" v2=\"" + std::to_string(v + N + 2) + "\" v3=\"" + std::to_string(v + N + 1) + "\"/>\n";
+            }
+        model +=
+            "    </triangles>\n"
+            "   </mesh>\n"
+            "  </object>\n"
+            " </resources>\n"
+            " <build>\n"
+            "  <item objectid=\"1\"/>\n"
+            " </build>\n"
+            "</model>\n";
+
+        std::string test_file = std::string(TEST_DATA_DIR) + "/test_3mf/hand_written.3mf";
+        {
+            mz_zip_archive archive;
+            mz_zip_zero_struct(&archive);
+            REQUIRE(open_zip_writer(&archive, test_file));
+            REQUIRE(mz_zip_writer_add_mem(&archive, "3D/3dmodel.model", model.data(), model.size(), MZ_DEFAULT_COMPRESSION));
+            REQUIRE(mz_zip_writer_finalize_archive(&archive));
+            REQUIRE(close_zip_writer(&archive));
+        }
+
+        WHEN("3mf model is read") {
+            Model dst_model;
+            DynamicPrintConfig dst_config;
+            bool loaded = false;
+            {
+                ConfigSubstitutionContext ctxt{ ForwardCompatibilitySubstitutionRule::Disable };
+                loaded = load_3mf(test_file.c_str(), dst_config, ctxt, &dst_model, false);
+            }
+            boost::filesystem::remove(test_file);
+
+            THEN("the vertices and the triangles are read") {
+                REQUIRE(loaded);
+                REQUIRE(dst_model.objects.size() == 1);
+                REQUIRE(dst_model.objects.front()->volumes.size() == 1);
+                const indexed_triangle_set &its = dst_model.objects.front()->volumes.front()->mesh().its;
+                REQUIRE(its.vertices.size() == vertices.size());
+                REQUIRE(its.indices.size() == size_t(2 * N * N));
+                for (size_t i = 0; i < vertices.size(); ++ i)
+                    REQUIRE((its.vertices[i] - vertices[i]).norm() < EPSILON);
+                // The loader may flip the triangles to get a positive volume, compare the sets of the vertex indices.
+                Vec3i32 first = its.indices.front();
+                std::sort(first.data(), first.data() + 3);
+                REQUIRE(first == Vec3i32(0, 1, N + 2));
+            }
+        }
+    }
+    GIVEN("model file with mesh tags inside comments, CDATA sections and processing instructions") {
+        const std::vector<Vec3f> vertices { { 0.f, 0.f, 0.f }, { 10.f, 0.f, 0.f }, { 0.f, 10.f, 0.f }, { 0.f, 0.f, 10.f } };
+        const std::string model =
+            "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+            "<model unit=\"millimeter\" xml:lang=\"en-US\" xmlns=\"http://schemas.microsoft.com/3dmanufacturing/core/2015/02\">\n"
+            " <!-- <vertices><vertex x=\"1\" y=\"1\" z=\"1\"/></vertices> -->\n"
+            " <?pi <triangles><triangle v1=\"0\" v2=\"0\" v3=\"0\"/></triangles>?>\n"
+            " <resources>\n"
+            "  <object id=\"1\" type=\"model\">\n"
+            "   <mesh>\n"
+            "    <vertices>\n"
+            "     <vertex x=\"0\" y=\"0\" z=\"0\"/>\n"
+            "     <!-- </vertices><vertex x=\"1\" y=\"1\" z=\"1\"/> -->\n"
+            "     <vertex x=\"10\" y=\"0\" z=\"0\"/>\n"
+            "     <![CDATA[</vertices>]]>\n"
+            "     <vertex x=\"0\" y=\"10\" z=\"0\"/>\n"
+            "     <?pi </vertices>?>\n"
+            "     <vertex x=\"0\" y=\"0\" z=\"10\"/>\n"
+            "    </vertices>\n"
+            "    <![CDATA[<triangles><triangle v1=\"0\" v2=\"0\" v3=\"0\"/></triangles>]]>\n"
+            "    <triangles>\n"
+            "     <triangle v1=\"0\" v2=\"2\" v3=\"1\"/>\n"
+            "     <!-- </triangles> -->\n"
+            "     <triangle v1=\"0\" v2=\"1\" v3=\"3\"/>\n"
+            "     <triangle v1=\"0\" v2=\"3\" v3=\"2\"/>\n"
+            "     <triangle v1=\"1\" v2=\"2\" v3=\"3\"/>\n"
+            "    </triangles>\n"
+            "   </mesh>\n"
+            "  </object>\n"
+            " </resources>\n"
+            " <build>\n"
+            "  <item objectid=\"1\"/>\n"
+            " </build>\n"
+            "</model>\n";
+
+        std::string test_file = std::string(TEST_DATA_DIR) + "/test_3mf/hand_written_markup.3mf";
+        {
+            mz_zip_archive archive;
+            mz_zip_zero_struct(&archive);
+            REQUIRE(open_zip_writer(&archive, test_file));
+            REQUIRE(mz_zip_writer_add_mem(&archive, "3D/3dmodel.model", model.data(), model.size(), MZ_DEFAULT_COMPRESSION));
+            REQUIRE(mz_zip_writer_finalize_archive(&archive));
+            REQUIRE(close_zip_writer(&archive));
+        }
+
+        WHEN("3mf model is read") {
+            Model dst_model;
+            DynamicPrintConfig dst_config;
+            bool loaded = false;
+            {
+                ConfigSubstitutionContext ctxt{ ForwardCompatibilitySubstitutionRule::Disable };
+                loaded = load_3mf(test_file.c_str(), dst_config, ctxt, &dst_model, false);
+            }
+            boost::filesystem::remove(test_file);
+
+            THEN("only the mesh outside of the markup is read") {
+                REQUIRE(loaded);
+                REQUIRE(dst_model.objects.size() == 1);
+                REQUIRE(dst_model.objects.front()->volumes.size() == 1);
+                const indexed_triangle_set &its = dst_model.objects.front()->volumes.front()->mesh().its;
+                REQUIRE(its.vertices.size() == vertices.size());
+                REQUIRE(its.indices.size() == 4);
+                for (size_t i = 0; i < vertices.size(); ++ i)
+                    REQUIRE((its.vertices[i] - vertices[i]).norm() < EPSILON);
+            }
+        }
+    }
+}
+
+SCENARIO("Export+Import 3mf file with different compression levels", "[3mf]") {
+    GIVEN("model") {
+        Model src_model;
+        std::string src_file = std::string(TEST_DATA_DIR) + "/test_3mf/Prusa.stl";
+        load_stl(src_file.c_str(), &src_model);
+        src_model.add_default_instances();
+        const TriangleMesh src_mesh = src_model.mesh();
+
+        for (int level : { 1, 6, 10 }) {
+            WHEN("model is saved+loaded to/from 3mf file with compression level " + std::to_string(level)) {
+                std::string test_file = std::string(TEST_DATA_DIR) + "/test_3mf/prusa_level.3mf";
+                bool stored = store_3mf(test_file.c_str(), &src_model, nullptr, OptionStore3mf{}.set_compression_level(level));
+
+                // The model file is deflated in blocks stitched together by the writer, check the headers and the CRC of all the files
+                // by inflating them with another reader than the 3mf importer.
+                bool valid = false;
+                {
+                    mz_zip_archive archive;
+                    mz_zip_zero_struct(&archive);
+                    if (open_zip_reader(&archive, test_file)) {
+                        valid = mz_zip_reader_locate_file(&archive, "3D/3dmodel.model", nullptr, 0) >= 0 && mz_zip_validate_archive(&archive, 0);
+                        close_zip_reader(&archive);
+                    }
+                }
+
+                Model dst_model;
+                DynamicPrintConfig dst_config;
+                bool loaded = false;
+                {
+                    ConfigSubstitutionContext ctxt{ ForwardCompatibilitySubstitutionRule::Disable };
+                    loaded = load_3mf(test_file.c_str(), dst_config, ctxt, &dst_model, false);
+                }
+                boost::filesystem::remove(test_file);
+
+                THEN("the archive is valid and the mesh is preserved") {
+                    REQUIRE(stored);
+                    REQUIRE(valid);
+                    REQUIRE(loaded);
+                    const TriangleMesh dst_mesh = dst_model.mesh();
+                    REQUIRE(dst_mesh.its.vertices.size() == src_mesh.its.vertices.size());
+                    REQUIRE(dst_mesh.its.indices.size() == src_mesh.its.indices.size());
+                    for (size_t i = 0; i < src_mesh.its.vertices.size(); ++i)
+                        REQUIRE(dst_mesh.its.vertices[i].isApprox(src_mesh.its.vertices[i]));
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Export+Import 3mf file with a model file deflated in several batches of blocks", "[3mf]") {
+    GIVEN("a sphere of several hundred thousand triangles") {
+        TriangleMesh sphere(its_make_sphere(50., 0.012));
+        sphere.translate(0.f, 0.f, 50.f);
+        REQUIRE(sphere.its.indices.size() > 300000);
+        Model src_model;
+        src_model.add_object("sphere", "", std::move(sphere));
+        src_model.add_default_instances();
+        const TriangleMesh src_mesh = src_model.mesh();
+
+        WHEN("model is saved+loaded to/from 3mf file with a single worker thread") {
+            // With one worker, a batch holds two blocks of the model file.
+            std::string test_file = std::string(TEST_DATA_DIR) + "/test_3mf/sphere_blocks.3mf";
+            bool stored = false;
+            tbb::task_arena arena(1);
+            arena.execute([&]() { stored = store_3mf(test_file.c_str(), &src_model, nullptr, OptionStore3mf{}); });
+
+            bool   valid      = false;
+            size_t model_size = 0;
+            {
+                mz_zip_archive archive;
+                mz_zip_zero_struct(&archive);
+                if (open_zip_reader(&archive, test_file)) {
+                    int index = mz_zip_reader_locate_file(&archive, "3D/3dmodel.model", nullptr, 0);
+                    mz_zip_archive_file_stat stat;
+                    if (index >= 0 && mz_zip_reader_file_stat(&archive, mz_uint(index), &stat))
+                        model_size = size_t(stat.m_uncomp_size);
+                    valid = index >= 0 && mz_zip_validate_archive(&archive, 0);
+                    close_zip_reader(&archive);
+                }
+            }
+
+            Model dst_model;
+            DynamicPrintConfig dst_config;
+            bool loaded = false;
+            {
+                ConfigSubstitutionContext ctxt{ ForwardCompatibilitySubstitutionRule::Disable };
+                loaded = load_3mf(test_file.c_str(), dst_config, ctxt, &dst_model, false);
+            }
+            boost::filesystem::remove(test_file);
+
+            THEN("the model file spans at least three 4MB blocks, the archive is valid and the mesh is preserved") {
+                REQUIRE(stored);
+                REQUIRE(model_size > 3 * 4 * 1024 * 1024);
+                REQUIRE(valid);
+                REQUIRE(loaded);
+                const TriangleMesh dst_mesh = dst_model.mesh();
+                REQUIRE(dst_mesh.its.vertices.size() == src_mesh.its.vertices.size());
+                REQUIRE(dst_mesh.its.indices.size() == src_mesh.its.indices.size());
+                bool vertices_equal = true;
+                for (size_t i = 0; i < src_mesh.its.vertices.size(); ++i)
+                    vertices_equal &= dst_mesh.its.vertices[i].isApprox(src_mesh.its.vertices[i]);
+                REQUIRE(vertices_equal);
+            }
+        }
+    }
+}
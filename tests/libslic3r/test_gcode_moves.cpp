@@ -0,0 +1,104 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/GCode/GCodeMoves.hpp"
+
+using namespace Slic3r;
+
+static GCodeMoveVertex make_move(size_t i)
+{
+    GCodeMoveVertex move;
+    move.gcode_id       = uint32_t(10 + i);
+    move.type           = (i % 7 == 0) ? EMoveType::Travel : EMoveType::Extrude;
+    move.extrusion_role = (i % 3 == 0) ? GCodeExtrusionRole::Perimeter : GCodeExtrusionRole::SolidInfill;
+    move.extruder_id    = uint8_t(i / 50);
+    move.cp_color_id    = uint8_t(i / 100);
+    move.object_id      = uint16_t(i / 30);
+    // Long travel every 10th move to exercise the positions stored out of the blocks.
+    move.position       = Vec3f(float(i % 10 == 5 ? 150. + 0.123 * i : 20. + 0.017 * i), float(35. - 0.031 * i), float(0.2 + 0.2 * (i / 40)));
+    move.delta_extruder = 0.01f * float(i);
+    move.feedrate       = float(40 + i % 5);
+    move.width          = 0.45f;
+    move.height         = 0.2f;
+    move.mm3_per_mm     = 0.05f + 0.001f * float(i % 4);
+    move.fan_speed      = float(i / 25 * 10);
+    move.temperature    = (i < 100) ? 215.f : 210.f;
+    move.move_time      = 0.1f * float(i);
+    move.layer_id       = uint16_t(i / 40);
+    move.internal_only  = i % 11 == 0;
+    return move;
+}
+
+static void require_equal(const GCodeMoveVertex &a, const GCodeMoveVertex &b)
+{
+    REQUIRE(a.gcode_id == b.gcode_id);
+    REQUIRE(a.type == b.type);
+    REQUIRE(a.extrusion_role == b.extrusion_role);
+    REQUIRE(a.extruder_id == b.extruder_id);
+    REQUIRE(a.cp_color_id == b.cp_color_id);
+    REQUIRE(a.object_id == b.object_id);
+    REQUIRE((a.position - b.position).cwiseAbs().maxCoeff() <= 0.0005f);
+    REQUIRE(a.delta_extruder == b.delta_extruder);
+    REQUIRE(a.feedrate == b.feedrate);
+    REQUIRE(a.width == Approx(b.width).margin(0.0005));
+    REQUIRE(a.height == Approx(b.height).margin(0.0005));
+    REQUIRE(a.mm3_per_mm == b.mm3_per_mm);
+    REQUIRE(a.fan_speed == b.fan_speed);
+    REQUIRE(a.temperature == b.temperature);
+    REQUIRE(a.move_time == b.move_time);
+    REQUIRE(a.layer_id == b.layer_id);
+    REQUIRE(a.internal_only == b.internal_only);
+}
+
+TEST_CASE("GCodeMoves stores the moves column by column", "[GCodeMoves]")
+{
+    GCodeMoves moves;
+    const size_t num_moves = 300;
+    for (size_t i = 0; i < num_moves; ++ i)
+        moves.push_back(make_move(i));
+    REQUIRE(moves.size() == num_moves);
+
+    SECTION("Random access and iteration return the stored moves") {
+        for (size_t i = 0; i < num_moves; i += 7)
+            require_equal(moves[i], make_move(i));
+        size_t i = 0;
+        for (GCodeMoves::const_iterator it = moves.begin(); it != moves.end(); ++ it, ++ i) {
+            REQUIRE(it.index() == i);
+            require_equal(*it, make_move(i));
+        }
+        REQUIRE(i == num_moves);
+        require_equal(moves.back(), make_move(num_moves - 1));
+        REQUIRE(moves.end() - moves.begin() == num_moves);
+    }
+
+    SECTION("Columns are accessible one by one") {
+        for (size_t i = 0; i < num_moves; ++ i) {
+            const GCodeMoveVertex move = make_move(i);
+            REQUIRE(moves.type(i) == move.type);
+            REQUIRE(moves.layer_id(i) == move.layer_id);
+            REQUIRE(moves.temperature(i) == move.temperature);
+            REQUIRE((moves.position(i) - move.position).cwiseAbs().maxCoeff() <= 0.0005f);
+        }
+    }
+
+    SECTION("Updated columns") {
+        moves.set_move_time(42, 1234.f);
+        moves.set_gcode_id(43, 7);
+        moves.set_width(44, 2.f);
+        REQUIRE(moves.move_time(42) == 1234.f);
+        REQUIRE(moves.gcode_id(43) == 7);
+        REQUIRE(moves.width(44) == Approx(2.f));
+        REQUIRE(moves.height(44) == Approx(0.2f));
+    }
+
+    SECTION("Erase shifts the following moves") {
+        moves.erase(130);
+        REQUIRE(moves.size() == num_moves - 1);
+        for (size_t i = 0; i < num_moves - 1; ++ i)
+            require_equal(moves[i], make_move(i < 130 ? i : i + 1));
+    }
+
+    SECTION("Compressed storage is smaller than an array of moves") {
+        moves.shrink_to_fit();
+        REQUIRE(moves.memsize() < num_moves * sizeof(GCodeMoveVertex) * 2 / 3);
+    }
+}
@@ -0,0 +1,95 @@
+#include "catch2/catch.hpp"
+
+#include "slic3r/GUI/GCodeViewer.hpp"
+
+using namespace Slic3r;
+using ToolpathSegment = GUI::GCodeViewer::ToolpathSegment;
+
+// Zig-zag extrusions along the x axis, one layer of moves_per_layer moves per 0.2 mm.
+static GCodeMoves zigzag_moves(size_t layers_count, size_t moves_per_layer)
+{
+    GCodeMoves moves;
+    for (size_t l = 0; l < layers_count; ++l) {
+        for (size_t i = 0; i < moves_per_layer; ++i) {
+            GCodeMoveVertex move;
+            move.type     = EMoveType::Extrude;
+            move.layer_id = uint16_t(l + 1);
+            move.position = Vec3f((i % 2 == 0) ? 10.f : 20.f, 10.f + 0.5f * float(i), 0.2f * float(l + 1));
+            moves.push_back(move);
+        }
+    }
+    return moves;
+}
+
+// Places the segments as the G-code viewer does: one path per layer, buffers limited to max_floats.
+static void place_segments(const GCodeMoves &moves, ToolpathSegment::EType type, size_t max_floats,
+    std::vector<ToolpathSegment> &segments, std::vector<size_t> &chunks, std::vector<std::vector<float>> &buffers)
+{
+    std::vector<size_t> sizes(1, 0);
+    for (size_t i = 1; i < moves.size(); ++ i) {
+        const bool new_layer = moves.layer_id(i) != moves.layer_id(i - 1);
+        if (new_layer || chunks.empty())
+            chunks.push_back(segments.size());
+        if (sizes.back() + 8 * 6 > max_floats)
+            sizes.push_back(0);
+        ToolpathSegment segment{ uint32_t(i), uint32_t(sizes.size() - 1), uint32_t(sizes.back()), 0.25f, 0.1f, type };
+        if (type != ToolpathSegment::EType::Line && (new_layer || i == 1 || sizes.back() == 0))
+            segment.type = ToolpathSegment::EType::SolidFirst;
+        segments.push_back(segment);
+        sizes.back() += segment.size_floats();
+    }
+    buffers.assign(sizes.size(), std::vector<float>());
+    for (size_t i = 0; i < sizes.size(); ++ i)
+        buffers[i].assign(sizes[i], std::numeric_limits<float>::quiet_NaN());
+}
+
+TEST_CASE("Toolpaths vertices are generated from placed segments", "[GCodeViewer]") {
+    const GCodeMoves moves = zigzag_moves(50, 200);
+
+    SECTION("Lines") {
+        std::vector<ToolpathSegment> segments;
+        std::vector<size_t>          chunks;
+        std::vector<std::vector<float>> buffers;
+        place_segments(moves, ToolpathSegment::EType::Line, 65536 * 3, segments, chunks, buffers);
+        GUI::GCodeViewer::generate_toolpaths_vertices(moves, segments, chunks, buffers);
+        for (const ToolpathSegment &segment : segments) {
+            const float *v = buffers[segment.vbuffer_id].data() + segment.offset;
+            const Vec3f  prev = moves.position(segment.move - 1);
+            const Vec3f  curr = moves.position(segment.move);
+            REQUIRE(Vec3f(v[0], v[1], v[2]) == prev);
+            REQUIRE(Vec3f(v[3], v[4], v[5]) == curr);
+        }
+    }
+
+    SECTION("Solids") {
+        std::vector<ToolpathSegment> segments;
+        std::vector<size_t>          chunks;
+        std::vector<std::vector<float>> buffers;
+        place_segments(moves, ToolpathSegment::EType::Solid, 16384 * 6, segments, chunks, buffers);
+        REQUIRE(buffers.size() > 1);
+        GUI::GCodeViewer::generate_toolpaths_vertices(moves, segments, chunks, buffers);
+        for (const std::vector<float> &buffer : buffers)
+            for (float f : buffer)
+                REQUIRE(!std::isnan(f));
+
+        // The 1st segment starts with the top vertex of the 1st endpoint, followed by its right vertex.
+        const ToolpathSegment &first = segments.front();
+        REQUIRE(first.type == ToolpathSegment::EType::SolidFirst);
+        const float *v = buffers[first.vbuffer_id].data() + first.offset;
+        const Vec3f prev = moves.position(first.move - 1);
+        const Vec3f curr = moves.position(first.move);
+        const Vec3f dir  = (curr - prev).normalized();
+        const Vec3f right = Vec3f(dir.y(), -dir.x(), 0.f).normalized();
+        const Vec3f up    = right.cross(dir);
+        REQUIRE((Vec3f(v[0], v[1], v[2]) - prev).norm() < EPSILON);
+        REQUIRE((Vec3f(v[3], v[4], v[5]) - up).norm() < EPSILON);
+        REQUIRE((Vec3f(v[6], v[7], v[8]) - (prev - first.half_height * up + first.half_width * right)).norm() < EPSILON);
+
+        // The result does not depend on how the segments are split among the tasks.
+        std::vector<std::vector<float>> buffers_single_chunk = buffers;
+        for (std::vector<float> &buffer : buffers_single_chunk)
+            std::fill(buffer.begin(), buffer.end(), 0.f);
+        GUI::GCodeViewer::generate_toolpaths_vertices(moves, segments, { 0 }, buffers_single_chunk);
+        REQUIRE(buffers_single_chunk == buffers);
+    }
+}
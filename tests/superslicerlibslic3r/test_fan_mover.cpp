@@ -627,3 +627,61 @@ TEST_CASE("4113 bug (erase all fan command after a point)") {
     }
 
 }
+
+TEST_CASE("Fan-only scan gives the same output as the buffered path") {
+    GCodeWriter writer;
+    writer.config.gcode_flavor.value   = gcfMarlinFirmware;
+    writer.config.gcode_comments.value = false;
+    writer.config.fan_percentage.value = false; // 0 -> 255
+
+    std::vector<std::string> layers;
+    for (int layer_id = 0; layer_id < 6; ++ layer_id) {
+        std::string gcode;
+        gcode += ";LAYER_CHANGE\n";
+        gcode += "G1 Z" + std::to_string(0.2 * (layer_id + 1)) + " F600\n";
+        gcode += ";TYPE:External perimeter\n";
+        gcode += "M106 S" + std::to_string(51 * (layer_id % 3)) + "\n"; // repeated speeds every three layers
+        gcode += "G1 X20 Y0 E2\n";
+        gcode += "M106 S255\n";                                          // superseded by the next line
+        gcode += "M107\n";
+        gcode += "G1 X20 Y20 E2\n";
+        gcode += "M107\n";                                               // doesn't change the speed
+        gcode += "G2 X0 Y20 I-10 J0 E3\n";
+        if (layer_id == 2) {
+            gcode += "; custom gcode: before_layer_gcode\n";
+            gcode += "M106 S100\n";                                      // kept inside custom gcode
+            gcode += "M106 S120\n";
+            gcode += "; custom gcode end: before_layer_gcode\n";
+        }
+        gcode += "G1 X0 Y0 E2\r\n";
+        gcode += "M106 S" + std::to_string(200 + layer_id) + "\n";       // last line of the layer
+        layers.emplace_back(std::move(gcode));
+    }
+    layers.emplace_back(read_to_string(std::string(TEST_DATA_DIR) + "/test_gcode/4113_fan_mover.gcode"));
+
+    auto process = [&writer, &layers](bool allow_fan_only_scan, bool flush_each_layer) {
+        Slic3r::FanMover fan_mover(writer,
+                                   0,     // fan_speedup_time.value,
+                                   false, // with_D_option
+                                   true,  // use_relative_e_distances.value,
+                                   false, // fan_speedup_overhangs.value,
+                                   0,     // fan_kickstart.value
+                                   allow_fan_only_scan);
+        std::string out;
+        for (size_t i = 0; i < layers.size(); ++ i)
+            out += fan_mover.process_gcode(layers[i], flush_each_layer || i + 1 == layers.size());
+        return out;
+    };
+
+    SECTION("flushed at each layer, as in the process_layers pipeline")
+    {
+        std::string scanned = process(true, true);
+        REQUIRE(scanned.find("M106 S255") == std::string::npos);
+        REQUIRE(scanned == process(false, true));
+    }
+
+    SECTION("flushed at the end only")
+    {
+        REQUIRE(process(true, false) == process(false, false));
+    }
+}